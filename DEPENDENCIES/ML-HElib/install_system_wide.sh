@@ -33,8 +33,10 @@ mkdir -p $PREFIX/include/helayers/hebase/utils
 mkdir -p $PREFIX/include/helayers/hebase/impl
 mkdir -p $PREFIX/include/helayers/hebase/helib
 mkdir -p $PREFIX/include/helayers/simple_nn
+mkdir -p $PREFIX/include/helayers/kvstore
 cp -v src/helayers/hebase/*.h $PREFIX/include/helayers/hebase/
 cp -v src/helayers/hebase/utils/*.h $PREFIX/include/helayers/hebase/utils/
 cp -v src/helayers/hebase/impl/*.h $PREFIX/include/helayers/hebase/impl/
 cp -v src/helayers/hebase/helib/*.h $PREFIX/include/helayers/hebase/helib/
 cp -v src/helayers/simple_nn/*.h $PREFIX/include/helayers/simple_nn/
+cp -v src/helayers/kvstore/*.h $PREFIX/include/helayers/kvstore/
@@ -40,48 +40,42 @@ BitwiseEvaluator::BitwiseEvaluator(HeContext& h)
 
 CTile BitwiseEvaluator::getMSB(const CTile& c) const
 {
-  CTile res(h);
-  res.impl = impl->getMSB(*c.impl);
-  return res;
+  return CTile(impl->getMSB(*c.maintained()));
 }
 
 CTile BitwiseEvaluator::getFlippedMSB(const CTile& c) const
 {
-  CTile res(h);
-  res.impl = impl->getFlippedMSB(*c.impl);
-  return res;
+  return CTile(impl->getFlippedMSB(*c.maintained()));
 }
 
 void BitwiseEvaluator::setIsSigned(CTile& c, bool val) const
 {
-  impl->setIsSigned(*c.impl, val);
+  impl->setIsSigned(c.modified(), val);
 }
 
 bool BitwiseEvaluator::getIsSigned(const CTile& c) const
 {
-  return impl->getIsSigned(*c.impl);
+  return impl->getIsSigned(*c.maintained());
 }
 
 CTile BitwiseEvaluator::hamming(const CTile& c, int from, int to) const
 {
-  CTile res(h);
-  res.impl = impl->hamming(*c.impl);
-  return res;
+  return CTile(impl->hamming(*c.maintained()));
 }
 
 vector<CTile> BitwiseEvaluator::split(const CTile& c) const
 {
-  vector<shared_ptr<AbstractCiphertext>> res = impl->split(*c.impl);
+  vector<shared_ptr<AbstractCiphertext>> res = impl->split(*c.maintained());
 
-  vector<CTile> resCTileVec(res.size(), CTile(h));
-  for (size_t i = 0; i < res.size(); i++) {
-    resCTileVec[i].impl = res[i];
-  }
+  vector<CTile> resCTileVec;
+  resCTileVec.reserve(res.size());
+  for (const auto& r : res)
+    resCTileVec.push_back(CTile(r));
 
   return resCTileVec;
 }
 
-CTile BitwiseEvaluator::combine(const vector<CTile> cs,
+CTile BitwiseEvaluator::combine(const vector<CTile>& cs,
                                 int from,
                                 int to,
                                 int bitsPerElement) const
@@ -90,70 +84,56 @@ CTile BitwiseEvaluator::combine(const vector<CTile> cs,
   csCasted.reserve(cs.size());
 
   for (const auto& c : cs) {
-    csCasted.push_back(c.impl);
+    csCasted.push_back(c.maintained());
   }
 
-  CTile res(h);
-  res.impl = impl->combine(csCasted, from, to, bitsPerElement);
-  return res;
+  return CTile(impl->combine(csCasted, from, to, bitsPerElement));
 }
 
 CTile BitwiseEvaluator::isEqual(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->isEqual(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->isEqual(*c1.maintained(), *c2.maintained()));
 }
 
 CTile BitwiseEvaluator::multiply(const CTile& c1,
                                  const CTile& c2,
                                  int targetBits) const
 {
-  CTile res(h);
-  res.impl = impl->multiply(*c1.impl, *c2.impl, targetBits);
-  return res;
+  return CTile(impl->multiply(*c1.maintained(), *c2.maintained(), targetBits));
 }
 
 CTile BitwiseEvaluator::add(const CTile& c1,
                             const CTile& c2,
                             int targetBits) const
 {
-  CTile res(h);
-  res.impl = impl->add(*c1.impl, *c2.impl, targetBits);
-  return res;
+  return CTile(impl->add(*c1.maintained(), *c2.maintained(), targetBits));
 }
 
 CTile BitwiseEvaluator::sub(const CTile& c1,
                             const CTile& c2,
                             int targetBits) const
 {
-  CTile res(h);
-  res.impl = impl->sub(*c1.impl, *c2.impl, targetBits);
-  return res;
+  return CTile(impl->sub(*c1.maintained(), *c2.maintained(), targetBits));
 }
 
 CTile BitwiseEvaluator::multiplyBit(const CTile& c, const CTile& bit) const
 {
-  CTile res(h);
-  res.impl = impl->multiplyBit(*c.impl, *(bit.impl));
-  return res;
+  return CTile(impl->multiplyBit(*c.maintained(), *bit.maintained()));
 }
 
 CTile BitwiseEvaluator::bitwiseXor(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->bitwiseXor(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->bitwiseXor(*c1.maintained(), *c2.maintained()));
 }
 
 int BitwiseEvaluator::getNumBits(const CTile& c) const
 {
-  return impl->getNumBits(*c.impl);
+  return impl->getNumBits(*c.maintained());
 }
 
 void BitwiseEvaluator::setNumBits(CTile& c, int bits) const
 {
-  impl->setNumBits(*c.impl, bits);
+  impl->setNumBits(c.modified(), bits);
 }
 
 int BitwiseEvaluator::getDefaultNumBits() const
@@ -167,49 +147,38 @@ void BitwiseEvaluator::debugPrintWithBinary(const CTile& c,
                                             int verbose,
                                             ostream& out) const
 {
-  impl->debugPrintWithBinary(*c.impl, title, maxElements, verbose, out);
+  impl->debugPrintWithBinary(
+      *c.maintained(), title, maxElements, verbose, out);
 }
 
 double BitwiseEvaluator::getScale(const CTile& c) const
 {
-  return impl->getScale(*c.impl);
+  return impl->getScale(*c.maintained());
 }
 
 CTile BitwiseEvaluator::max(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->max(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->max(*c1.maintained(), *c2.maintained()));
 }
 CTile BitwiseEvaluator::min(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->min(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->min(*c1.maintained(), *c2.maintained()));
 }
 
 CTile BitwiseEvaluator::isGreater(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->isGreater(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->isGreater(*c1.maintained(), *c2.maintained()));
 }
 CTile BitwiseEvaluator::isLess(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->isLess(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->isLess(*c1.maintained(), *c2.maintained()));
 }
 CTile BitwiseEvaluator::isGreaterEqual(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->isGreaterEqual(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->isGreaterEqual(*c1.maintained(), *c2.maintained()));
 }
 CTile BitwiseEvaluator::isLessEqual(const CTile& c1, const CTile& c2) const
 {
-  CTile res(h);
-  res.impl = impl->isLessEqual(*c1.impl, *c2.impl);
-  return res;
+  return CTile(impl->isLessEqual(*c1.maintained(), *c2.maintained()));
 }
 } // namespace helayers
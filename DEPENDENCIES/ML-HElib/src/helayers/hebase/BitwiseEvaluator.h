@@ -86,7 +86,7 @@ public:
   /// @param[in] from            The index to start combining from.
   /// @param[in] out             The index to combine until.
   /// @param[in] bitsPerElement  How many bits to take from each CTile in "cs".
-  CTile combine(const std::vector<CTile> cs,
+  CTile combine(const std::vector<CTile>& cs,
                 int from = 0,
                 int to = -1,
                 int bitsPerElement = 1) const;
@@ -23,119 +23,478 @@
  */
 
 #include "CTile.h"
+#include <atomic>
 #include <fstream>
+#include <omp.h>
 
 using namespace std;
 
 namespace helayers {
 
+static atomic<bool> copyOnWrite(false);
+
+// Shares the implementation of src if copy-on-write is enabled. A CTile with
+// pending maintenance never shares its implementation, since performing the
+// maintenance modifies it.
+static shared_ptr<AbstractCiphertext> copyImpl(
+    const shared_ptr<AbstractCiphertext>& impl,
+    bool hasPendingMaintenance)
+{
+  if (copyOnWrite && !hasPendingMaintenance)
+    return impl;
+  return impl->clone();
+}
+
+// Adds src to addend, or subtracts it if "negate" is true. A null addend is
+// set to a private copy of src.
+static void accumulate(shared_ptr<AbstractCiphertext>& addend,
+                       const AbstractCiphertext& src,
+                       bool negate)
+{
+  if (!addend) {
+    addend = src.clone();
+    if (negate)
+      addend->negate();
+  } else if (negate)
+    addend->sub(src);
+  else
+    addend->add(src);
+}
+
+// Resolves a requested number of threads, where 0 means OpenMP's default.
+static int resolveNumThreads(int numThreads)
+{
+  return numThreads == 0 ? omp_get_max_threads() : numThreads;
+}
+
 CTile::CTile(HeContext& he) : impl(he.createAbstractCipher()) {}
 
-CTile::CTile(const CTile& src) : impl(src.impl->clone()) {}
+CTile::CTile(const shared_ptr<AbstractCiphertext>& impl) : impl(impl) {}
+
+CTile::CTile(const CTile& src)
+    : impl(copyImpl(src.impl, src.hasPendingMaintenance())),
+      pendingRelinearize(src.pendingRelinearize),
+      pendingRescale(src.pendingRescale),
+      pendingAddend(src.pendingAddend ? src.pendingAddend->clone() : nullptr)
+{}
+
+CTile::CTile(CTile&& src) noexcept
+    : impl(move(src.impl)),
+      pendingRelinearize(src.pendingRelinearize),
+      pendingRescale(src.pendingRescale),
+      pendingAddend(move(src.pendingAddend))
+{}
 
 CTile::~CTile() {}
 
 CTile& CTile::operator=(const CTile& src)
 {
-  if (this != &src)
-    impl = src.impl->clone();
+  if (this != &src) {
+    impl = copyImpl(src.impl, src.hasPendingMaintenance());
+    pendingRelinearize = src.pendingRelinearize;
+    pendingRescale = src.pendingRescale;
+    pendingAddend = src.pendingAddend ? src.pendingAddend->clone() : nullptr;
+  }
   return *this;
 }
 
-streamoff CTile::save(ostream& stream) const { return impl->save(stream); }
+CTile& CTile::operator=(CTile&& src) noexcept
+{
+  if (this != &src) {
+    impl = move(src.impl);
+    pendingRelinearize = src.pendingRelinearize;
+    pendingRescale = src.pendingRescale;
+    pendingAddend = move(src.pendingAddend);
+  }
+  return *this;
+}
+
+void CTile::setCopyOnWrite(bool val) { copyOnWrite = val; }
+
+bool CTile::getCopyOnWrite() { return copyOnWrite; }
+
+void CTile::detach()
+{
+  if (impl.use_count() > 1)
+    impl = impl->clone();
+}
+
+shared_ptr<AbstractCiphertext> CTile::maintained() const
+{
+  if (!hasPendingMaintenance())
+    return impl;
+
+  // A const CTile may be read concurrently, so pending maintenance is
+  // performed on a copy rather than in place.
+  shared_ptr<AbstractCiphertext> res = impl->clone();
+  if (pendingRelinearize)
+    res->relinearize();
+  if (pendingRescale)
+    res->rescale();
+  if (pendingAddend)
+    res->add(*pendingAddend);
+  return res;
+}
+
+AbstractCiphertext& CTile::modified()
+{
+  detach();
+  flushMaintenance();
+  return *impl;
+}
+
+AbstractCiphertext& CTile::overwritten()
+{
+  pendingRelinearize = false;
+  pendingRescale = false;
+  pendingAddend.reset();
+  if (impl.use_count() > 1)
+    impl = impl->getContext().createAbstractCipher();
+  return *impl;
+}
+
+shared_ptr<AbstractCiphertext> CTile::alignMaintenance(const CTile& other)
+{
+  detach();
+
+  // Relinearization is linear, so a pending one is carried by the sum.
+  if (pendingRescale == other.pendingRescale && !other.pendingAddend) {
+    pendingRelinearize |= other.pendingRelinearize;
+    return other.impl;
+  }
+
+  // Rescaling isn't: both operands must be at the same scale.
+  flushMaintenance();
+  return other.maintained();
+}
+
+void CTile::addLazy(const CTile& other, bool negate)
+{
+  detach();
+
+  // Relinearization is linear, so a pending one is carried by the sum.
+  if (pendingRescale == other.pendingRescale) {
+    if (negate)
+      impl->sub(*other.impl);
+    else
+      impl->add(*other.impl);
+    pendingRelinearize |= other.pendingRelinearize;
+    if (other.pendingAddend)
+      accumulate(pendingAddend, *other.pendingAddend, negate);
+    return;
+  }
+
+  // Rescaling isn't: the operands are at different scales. The maintained
+  // one is set aside until the pending maintenance of the other is
+  // performed, so that adding it doesn't force that maintenance now.
+  if (pendingRescale) {
+    accumulate(pendingAddend, *other.maintained(), negate);
+    return;
+  }
+
+  flushMaintenance();
+  shared_ptr<AbstractCiphertext> maintainedImpl = move(impl);
+  impl = other.impl->clone();
+  if (negate)
+    impl->negate();
+  pendingRelinearize = other.pendingRelinearize;
+  pendingRescale = true;
+  pendingAddend = move(maintainedImpl);
+  if (other.pendingAddend)
+    accumulate(pendingAddend, *other.pendingAddend, negate);
+}
+
+void CTile::copyFrom(const CTile& src)
+{
+  if (this == &src)
+    return;
+  if (impl.use_count() > 1 || impl == src.impl) {
+    *this = src;
+    return;
+  }
+  impl->copyFrom(*src.impl);
+  pendingRelinearize = src.pendingRelinearize;
+  pendingRescale = src.pendingRescale;
+  pendingAddend = src.pendingAddend ? src.pendingAddend->clone() : nullptr;
+}
+
+void CTile::flushMaintenance()
+{
+  if (pendingRelinearize) {
+    impl->relinearize();
+    pendingRelinearize = false;
+  }
+  if (pendingRescale) {
+    impl->rescale();
+    pendingRescale = false;
+  }
+  if (pendingAddend) {
+    impl->add(*pendingAddend);
+    pendingAddend.reset();
+  }
+}
+
+// A pending operation modifies the implementation once performed, so it
+// must not be shared.
+void CTile::relinearizeLazy()
+{
+  detach();
+  pendingRelinearize = true;
+}
+
+void CTile::rescaleLazy()
+{
+  detach();
+  pendingRescale = true;
+}
+
+streamoff CTile::save(ostream& stream) const
+{
+  return maintained()->save(stream);
+}
 
-streamoff CTile::load(istream& stream) { return impl->load(stream); }
+streamoff CTile::load(istream& stream) { return overwritten().load(stream); }
 
-void CTile::conjugate() { impl->conjugate(); }
+void CTile::conjugate() { modified().conjugate(); }
 
-void CTile::conjugateRaw() { impl->conjugateRaw(); }
+void CTile::conjugateRaw() { modified().conjugateRaw(); }
 
-void CTile::rotate(int n) { impl->rotate(n); }
+void CTile::rotate(int n) { modified().rotate(n); }
+
+vector<CTile> CTile::rotateMany(const vector<int>& ns) const
+{
+  vector<shared_ptr<AbstractCiphertext>> rotated = maintained()->rotateMany(ns);
+  vector<CTile> res;
+  res.reserve(rotated.size());
+  for (const auto& r : rotated)
+    res.push_back(CTile(r));
+  return res;
+}
 
 void CTile::innerSum(int rot1, int rot2, bool reverse)
 {
-  impl->innerSum(rot1, rot2, reverse);
+  modified().innerSum(rot1, rot2, reverse);
 }
 
 void CTile::sumExpBySquaringLeftToRight(int n)
 {
-  impl->sumExpBySquaringLeftToRight(n);
+  modified().sumExpBySquaringLeftToRight(n);
 }
 
 void CTile::sumExpBySquaringRightToLeft(int n)
 {
-  impl->sumExpBySquaringRightToLeft(n);
+  modified().sumExpBySquaringRightToLeft(n);
 }
 
-void CTile::add(const CTile& other) { impl->add(*other.impl); }
+void CTile::add(const CTile& other) { addLazy(other, false); }
 
-void CTile::addRaw(const CTile& other) { impl->addRaw(*other.impl); }
+void CTile::addRaw(const CTile& other)
+{
+  shared_ptr<AbstractCiphertext> otherImpl = alignMaintenance(other);
+  impl->addRaw(*otherImpl);
+}
 
-void CTile::sub(const CTile& other) { impl->sub(*other.impl); }
+void CTile::sub(const CTile& other) { addLazy(other, true); }
 
-void CTile::subRaw(const CTile& other) { impl->subRaw(*other.impl); }
+void CTile::subRaw(const CTile& other)
+{
+  shared_ptr<AbstractCiphertext> otherImpl = alignMaintenance(other);
+  impl->subRaw(*otherImpl);
+}
 
-void CTile::multiply(const CTile& other) { impl->multiply(*other.impl); }
+void CTile::multiply(const CTile& other)
+{
+  modified().multiply(*other.maintained());
+}
 
-void CTile::multiplyRaw(const CTile& other) { impl->multiplyRaw(*other.impl); }
+void CTile::multiplyRaw(const CTile& other)
+{
+  modified().multiplyRaw(*other.maintained());
+}
+
+void CTile::multiplyAdd(const CTile& a, const CTile& b)
+{
+  CTile buffer(impl->getContext());
+  multiplyAdd(a, b, buffer);
+}
 
-void CTile::addPlain(const PTile& plain) { impl->addPlain(*plain.impl); }
+void CTile::multiplyAdd(const CTile& a, const CTile& b, CTile& buffer)
+{
+  // The first product is computed in the accumulator itself.
+  CTile& prod = isEmpty() ? *this : buffer;
+  prod.copyFrom(a);
+  prod.multiplyRaw(b);
+  prod.relinearizeLazy();
+  prod.rescaleLazy();
+  // An accumulator of earlier products has the same pending maintenance and
+  // the product is added as is. A maintained accumulator is set aside by
+  // add() until the maintenance of the products is performed.
+  if (&prod != this)
+    add(prod);
+}
 
-void CTile::addPlainRaw(const PTile& plain) { impl->addPlainRaw(*plain.impl); }
+void CTile::multiplyPlainAdd(const CTile& a, const PTile& plain, CTile& buffer)
+{
+  CTile& prod = isEmpty() ? *this : buffer;
+  prod.copyFrom(a);
+  prod.multiplyPlainRaw(plain);
+  prod.rescaleLazy();
+  if (&prod != this)
+    add(prod);
+}
 
-void CTile::subPlain(const PTile& plain) { impl->subPlain(*plain.impl); }
+CTile CTile::dotProduct(const vector<CTile>& a,
+                        const vector<CTile>& b,
+                        int numThreads)
+{
+  if (a.size() != b.size())
+    throw invalid_argument("dotProduct of vectors of different sizes " +
+                           to_string(a.size()) + " and " +
+                           to_string(b.size()));
+  if (a.empty())
+    throw invalid_argument("dotProduct of empty vectors");
+
+  // The inputs are const and may be shared between the products computed
+  // concurrently, so their pending maintenance is done on private copies.
+  vector<CTile> prods(a.size(), CTile(a[0].impl->getContext()));
+  int n = resolveNumThreads(numThreads);
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < a.size(); ++i) {
+    prods[i].copyFrom(a[i]);
+    prods[i].multiplyRaw(b[i]);
+  }
+
+  CTile res = sum(prods, numThreads);
+  res.relinearizeLazy();
+  res.rescaleLazy();
+  return res;
+}
 
-void CTile::subPlainRaw(const PTile& plain) { impl->subPlainRaw(*plain.impl); }
+CTile CTile::sum(const vector<CTile>& tiles, int numThreads)
+{
+  if (tiles.empty())
+    throw invalid_argument("sum of an empty vector");
+
+  // The first level reads the inputs, each by a single pair, and the
+  // following levels reduce the partial sums in place.
+  size_t n = (tiles.size() + 1) / 2;
+  vector<CTile> partial(n, CTile(tiles[0].impl->getContext()));
+  int threads = resolveNumThreads(numThreads);
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+  for (size_t i = 0; i < n; ++i) {
+    partial[i] = tiles[2 * i];
+    if (2 * i + 1 < tiles.size())
+      partial[i].add(tiles[2 * i + 1]);
+  }
+
+  for (size_t stride = 1; stride < n; stride *= 2) {
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (size_t i = 0; i < n - stride; i += 2 * stride)
+      partial[i].add(partial[i + stride]);
+  }
+
+  return move(partial[0]);
+}
+
+void CTile::addPlain(const PTile& plain) { modified().addPlain(*plain.impl); }
+
+void CTile::addPlainRaw(const PTile& plain)
+{
+  modified().addPlainRaw(*plain.impl);
+}
+
+void CTile::subPlain(const PTile& plain) { modified().subPlain(*plain.impl); }
+
+void CTile::subPlainRaw(const PTile& plain)
+{
+  modified().subPlainRaw(*plain.impl);
+}
 
 void CTile::multiplyPlain(const PTile& plain)
 {
-  impl->multiplyPlain(*plain.impl);
+  modified().multiplyPlain(*plain.impl);
 }
 
 void CTile::multiplyPlainRaw(const PTile& plain)
 {
-  impl->multiplyPlainRaw(*plain.impl);
+  modified().multiplyPlainRaw(*plain.impl);
 }
 
-void CTile::square() { impl->square(); }
+void CTile::square() { modified().square(); }
 
-void CTile::squareRaw() { impl->squareRaw(); }
+void CTile::squareRaw() { modified().squareRaw(); }
 
-void CTile::addScalar(int scalar) { impl->addScalar(scalar); }
+void CTile::addScalar(int scalar) { modified().addScalar(scalar); }
 
-void CTile::addScalar(double scalar) { impl->addScalar(scalar); }
+void CTile::addScalar(double scalar) { modified().addScalar(scalar); }
 
-void CTile::multiplyScalar(int scalar) { impl->multiplyScalar(scalar); }
+void CTile::multiplyScalar(int scalar)
+{
+  modified().multiplyScalar(scalar);
+}
 
-void CTile::multiplyScalar(double scalar) { impl->multiplyScalar(scalar); }
+void CTile::multiplyScalar(double scalar)
+{
+  modified().multiplyScalar(scalar);
+}
 
-void CTile::negate() { impl->negate(); }
+void CTile::negate()
+{
+  detach();
+  impl->negate();
+  if (pendingAddend)
+    pendingAddend->negate();
+}
 
 void CTile::multiplyByChangingScale(double factor)
 {
-  impl->multiplyByChangingScale(factor);
+  modified().multiplyByChangingScale(factor);
 }
 
-void CTile::setScale(double scale) { impl->setScale(scale); }
+void CTile::setScale(double scale) { modified().setScale(scale); }
+
+double CTile::getScale() const { return maintained()->getScale(); }
 
-double CTile::getScale() const { return impl->getScale(); }
+void CTile::relinearize()
+{
+  detach();
+  pendingRelinearize = false;
+  impl->relinearize();
+}
 
-void CTile::relinearize() { impl->relinearize(); }
+void CTile::rescale()
+{
+  detach();
+  // A pending rescale is performed instead of an additional one.
+  bool rescaled = pendingRescale;
+  flushMaintenance();
+  if (!rescaled)
+    impl->rescale();
+}
 
-void CTile::rescale() { impl->rescale(); }
+void CTile::rescaleRaw() { modified().rescaleRaw(); }
 
-void CTile::rescaleRaw() { impl->rescaleRaw(); }
+void CTile::compact() { modified().compact(); }
 
-void CTile::reduceChainIndex() { impl->reduceChainIndex(); }
+void CTile::reduceChainIndex() { modified().reduceChainIndex(); }
 
 void CTile::setChainIndex(const CTile& other)
 {
-  impl->setChainIndex(*other.impl);
+  modified().setChainIndex(*other.maintained());
+}
+
+void CTile::setChainIndex(int chainIndex)
+{
+  modified().setChainIndex(chainIndex);
 }
 
-void CTile::setChainIndex(int chainIndex) { impl->setChainIndex(chainIndex); }
+int CTile::getChainIndex() const { return maintained()->getChainIndex(); }
 
-int CTile::getChainIndex() const { return impl->getChainIndex(); }
+AbstractCiphertext& CTile::getImpl()
+{
+  detach();
+  return *impl;
+}
 
 int CTile::slotCount() const { return impl->slotCount(); }
 
@@ -146,6 +505,6 @@ void CTile::debugPrint(const string& title,
                        int verbose,
                        ostream& out) const
 {
-  return impl->debugPrint(title, maxElements, verbose, out);
+  return maintained()->debugPrint(title, maxElements, verbose, out);
 }
 } // namespace helayers
@@ -46,27 +46,99 @@ class CTile : public Saveable
 
   std::shared_ptr<AbstractCiphertext> impl;
 
+  // Maintenance operations requested with relinearizeLazy()/rescaleLazy()
+  // and not yet performed.
+  bool pendingRelinearize = false;
+  bool pendingRescale = false;
+
+  // A maintained ciphertext added to or subtracted from this one while its
+  // rescale was pending, to be added once the pending maintenance is
+  // performed. Only set while a rescale is pending.
+  std::shared_ptr<AbstractCiphertext> pendingAddend;
+
+  /// Wraps an existing implementation, used for results of evaluators.
+  explicit CTile(const std::shared_ptr<AbstractCiphertext>& impl);
+
+  /// Returns the implementation with pending maintenance performed, for
+  /// operations that only read the ciphertext. A const CTile is never
+  /// modified: if maintenance is pending, it is performed on a copy.
+  std::shared_ptr<AbstractCiphertext> maintained() const;
+
+  /// Like maintained(), for operations that modify the ciphertext in place.
+  /// Takes a private copy of an implementation shared with other CTiles.
+  AbstractCiphertext& modified();
+
+  /// Clears pending maintenance and returns the implementation, for
+  /// operations that overwrite the ciphertext.
+  AbstractCiphertext& overwritten();
+
+  /// Takes a private copy of the implementation if it is shared.
+  void detach();
+
+  /// Before a raw addition or subtraction of other, detaches this CTile and
+  /// resolves pending rescales that the two operands do not share. Returns
+  /// the implementation of other to add or subtract.
+  std::shared_ptr<AbstractCiphertext> alignMaintenance(const CTile& other);
+
+  /// Adds other to this CTile, or subtracts it if "negate" is true. If only
+  /// one of the operands has a pending rescale, the other is kept in
+  /// pendingAddend rather than forcing that rescale.
+  void addLazy(const CTile& other, bool negate);
+
+  /// Copies src into this CTile, reusing the storage of its ciphertext if it
+  /// isn't shared.
+  void copyFrom(const CTile& src);
+
   friend class Encoder;
 
   friend class BitwiseEvaluator;
 
   friend class NativeFunctionEvaluator;
 
+  friend class CTilePool;
+
+  template <class Cipher, class Plain>
+  friend class StaticCTile;
+
 public:
   /// Constructs an empty object.
   /// @param[in] he the underlying context.
   CTile(HeContext& he);
 
   /// Copy constructor.
+  /// The ciphertext is copied, unless copy-on-write is enabled (see
+  /// setCopyOnWrite()).
   /// @param[in] src Object to copy.
   CTile(const CTile& src);
 
+  /// Move constructor. "src" is left without a ciphertext and may only be
+  /// assigned to or destroyed.
+  /// @param[in] src Object to move from.
+  CTile(CTile&& src) noexcept;
+
   ~CTile();
 
   /// Copy from another object.
+  /// The ciphertext is copied, unless copy-on-write is enabled (see
+  /// setCopyOnWrite()).
   /// @param[in] src Object to copy.
   CTile& operator=(const CTile& src);
 
+  /// Move from another object. "src" is left without a ciphertext and may
+  /// only be assigned to or destroyed.
+  /// @param[in] src Object to move from.
+  CTile& operator=(CTile&& src) noexcept;
+
+  /// Enables or disables copy-on-write. When enabled, copies of a CTile share
+  /// its ciphertext, and a private copy is made only when one of them is
+  /// modified. CTiles with pending maintenance are always copied.
+  /// Disabled by default.
+  /// @param[in] val Whether to enable copy-on-write.
+  static void setCopyOnWrite(bool val);
+
+  /// Returns whether copy-on-write is enabled. See setCopyOnWrite().
+  static bool getCopyOnWrite();
+
   ///  Saves this CTile to a stream in binary form.
   ///
   ///  @param[in] stream output stream to write to
@@ -93,6 +165,12 @@ public:
   ///  @param[in] n rotate offset
   void rotate(int n);
 
+  ///  Returns copies of this CTile rotated left by each of the given offsets.
+  ///  Equivalent to rotating separate copies, but backends supporting
+  ///  hoisted rotations share most of the work between them.
+  ///  @param[in] ns rotate offsets
+  std::vector<CTile> rotateMany(const std::vector<int>& ns) const;
+
   /// Add content of another ciphertext to this one, elementwise.
   /// Result is stored in place.
   /// Depending on scheme, this may perform some additional
@@ -129,6 +207,52 @@ public:
   /// see multiply()
   void multiplyRaw(const CTile& other);
 
+  /// Adds the elementwise product of "a" and "b" to this ciphertext.
+  /// Relinearization and rescaling of the product are left pending (see
+  /// relinearizeLazy()), so a sequence of multiplyAdd() calls on the same
+  /// accumulator performs them once. An empty CTile is a valid accumulator.
+  ///  @param[in] a first factor.
+  ///  @param[in] b second factor.
+  void multiplyAdd(const CTile& a, const CTile& b);
+
+  /// Like multiplyAdd(const CTile&, const CTile&), computing the product in
+  /// "buffer". Passing the same buffer for all the terms of a sum reuses its
+  /// ciphertext instead of allocating one per term.
+  ///  @param[in] a first factor.
+  ///  @param[in] b second factor.
+  ///  @param[in,out] buffer scratch CTile of the same context. Its content
+  ///                        is overwritten.
+  void multiplyAdd(const CTile& a, const CTile& b, CTile& buffer);
+
+  /// Adds the elementwise product of "a" and "plain" to this ciphertext,
+  /// computing it in "buffer" like multiplyAdd(). Rescaling of the product
+  /// is left pending (see rescaleLazy()).
+  ///  @param[in] a ciphertext factor.
+  ///  @param[in] plain plaintext factor.
+  ///  @param[in,out] buffer scratch CTile of the same context. Its content
+  ///                        is overwritten.
+  void multiplyPlainAdd(const CTile& a, const PTile& plain, CTile& buffer);
+
+  /// Returns the sum of the elementwise products a[i]*b[i]. Products are
+  /// computed in parallel and summed with sum(), then relinearized and
+  /// rescaled once.
+  ///  @param[in] a first factors.
+  ///  @param[in] b second factors, of the same size as "a".
+  ///  @param[in] numThreads number of threads. 0 means use OpenMP's
+  ///                        default.
+  ///  @throw invalid_argument if the sizes differ or are zero.
+  static CTile dotProduct(const std::vector<CTile>& a,
+                          const std::vector<CTile>& b,
+                          int numThreads = 0);
+
+  /// Returns the sum of the given ciphertexts, added in parallel along a
+  /// balanced binary tree.
+  ///  @param[in] tiles ciphertexts to sum.
+  ///  @param[in] numThreads number of threads. 0 means use OpenMP's
+  ///                        default.
+  ///  @throw invalid_argument if "tiles" is empty.
+  static CTile sum(const std::vector<CTile>& tiles, int numThreads = 0);
+
   /// Add content of another PTile to this one, elementwise.
   /// Result is stored in place.
   /// Depending on scheme, this may perform some additional
@@ -224,6 +348,29 @@ public:
   /// See rescale()
   void rescaleRaw();
 
+  /// Marks this ciphertext as needing relinearization, without performing it.
+  /// It will be performed by the first subsequent operation that requires it
+  /// (e.g., multiplication, rotation, save or decryption), or by
+  /// flushMaintenance(). Additions and subtractions keep it pending, so a
+  /// sum of several products is relinearized once.
+  void relinearizeLazy();
+
+  /// Marks this ciphertext as needing a rescale, without performing it.
+  /// See relinearizeLazy().
+  void rescaleLazy();
+
+  /// Performs any pending relinearize and rescale operations.
+  /// Operations on a const CTile with pending maintenance perform it on a
+  /// temporary copy each time, so a CTile that is about to be read several
+  /// times should be flushed by its owner first.
+  void flushMaintenance();
+
+  /// Returns true if relinearize or rescale operations are pending.
+  bool hasPendingMaintenance() const
+  {
+    return pendingRelinearize || pendingRescale;
+  }
+
   /// Negates content of this ciphertext.
   void negate();
 
@@ -236,6 +383,13 @@ public:
   /// Returns the attached meta data scale of the ciphertext.
   double getScale() const;
 
+  /// Switches the ciphertext to the smallest modulus that still allows
+  /// decrypting it, which reduces its serialized size considerably.
+  /// Use on ciphertexts that are about to be saved and sent for decryption;
+  /// little or no further computation is possible afterwards.
+  /// Ignored if not supported.
+  void compact();
+
   /// Reduces the chain-index property of the ciphertext by 1.
   /// Ignored if not supported.
   /// @throw runtime_error If chain index is already at lowest value
@@ -314,7 +468,7 @@ public:
   const AbstractCiphertext& getImpl() const { return *impl; };
 
   /// Reserved for debugging and internal use.
-  AbstractCiphertext& getImpl() { return *impl; };
+  AbstractCiphertext& getImpl();
 };
 } // namespace helayers
 
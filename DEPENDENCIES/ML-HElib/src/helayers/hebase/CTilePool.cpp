@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CTilePool.h"
+#include "CTile.h"
+#include "HeContext.h"
+#include "impl/AbstractCiphertext.h"
+
+using namespace std;
+
+namespace helayers {
+
+CTilePool::CTilePool(HeContext& he, size_t capacity)
+    : he(he), freeList(make_shared<FreeList>())
+{
+  freeList->capacity = capacity;
+}
+
+CTilePool::~CTilePool() {}
+
+void CTilePool::recycle(const weak_ptr<FreeList>& freeList,
+                        long generation,
+                        const shared_ptr<AbstractCiphertext>& obj)
+{
+  shared_ptr<FreeList> list = freeList.lock();
+  if (!list)
+    return;
+  lock_guard<mutex> lock(list->mtx);
+  if (list->generation == generation &&
+      list->objects.size() < list->capacity)
+    list->objects.push_back(obj);
+}
+
+shared_ptr<AbstractCiphertext> CTilePool::copyOf(const AbstractCiphertext& src)
+{
+  if (&src.getContext() != &he)
+    throw invalid_argument("Ciphertext does not belong to the pool's context");
+
+  shared_ptr<AbstractCiphertext> obj;
+  long generation;
+  {
+    lock_guard<mutex> lock(freeList->mtx);
+    generation = freeList->generation;
+    if (!freeList->objects.empty()) {
+      obj = move(freeList->objects.back());
+      freeList->objects.pop_back();
+    }
+  }
+
+  if (obj) {
+    ++hits;
+    obj->copyFrom(src);
+  } else {
+    ++misses;
+    obj = src.clone();
+  }
+
+  // The returned pointer shares the object but not its ownership: once the
+  // last copy of it is released, the deleter hands the object back.
+  weak_ptr<FreeList> list = freeList;
+  return shared_ptr<AbstractCiphertext>(
+      obj.get(), [list, generation, obj](AbstractCiphertext*) {
+        recycle(list, generation, obj);
+      });
+}
+
+CTile CTilePool::copyOf(const CTile& src)
+{
+  return CTile(copyOf(*src.maintained()));
+}
+
+void CTilePool::setCapacity(size_t capacity)
+{
+  lock_guard<mutex> lock(freeList->mtx);
+  freeList->capacity = capacity;
+  if (freeList->objects.size() > capacity)
+    freeList->objects.resize(capacity);
+}
+
+size_t CTilePool::getCapacity() const
+{
+  lock_guard<mutex> lock(freeList->mtx);
+  return freeList->capacity;
+}
+
+size_t CTilePool::size() const
+{
+  lock_guard<mutex> lock(freeList->mtx);
+  return freeList->objects.size();
+}
+
+void CTilePool::clear()
+{
+  lock_guard<mutex> lock(freeList->mtx);
+  freeList->objects.clear();
+  ++freeList->generation;
+}
+
+void CTilePool::resetCounters()
+{
+  hits = 0;
+  misses = 0;
+}
+} // namespace helayers
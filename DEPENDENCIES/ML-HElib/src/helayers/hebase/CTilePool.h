@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_CTILEPOOL_H
+#define SRC_HELAYERS_CTILEPOOL_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace helayers {
+
+class HeContext;
+class AbstractCiphertext;
+class CTile;
+
+/// A pool of ciphertext objects for temporaries of evaluation loops.
+/// Ciphertexts handed out by the pool return to it once the last reference
+/// to them is released, and the next copy taken from the pool is written
+/// into their already allocated polynomials instead of allocating new ones.
+/// Each HeContext owns one such pool, available via HeContext::getCTilePool()
+/// and used by innerSum() and similar loops. Scoped pools can be created
+/// directly; ciphertexts outliving their pool are simply freed.
+/// This class is thread safe.
+class CTilePool
+{
+  struct FreeList
+  {
+    std::mutex mtx;
+    std::vector<std::shared_ptr<AbstractCiphertext>> objects;
+    size_t capacity;
+    // incremented by clear(), so ciphertexts handed out before are not
+    // returned to the pool
+    long generation = 0;
+  };
+
+  HeContext& he;
+
+  std::shared_ptr<FreeList> freeList;
+
+  std::atomic<long> hits{0};
+
+  std::atomic<long> misses{0};
+
+  static void recycle(const std::weak_ptr<FreeList>& freeList,
+                      long generation,
+                      const std::shared_ptr<AbstractCiphertext>& obj);
+
+public:
+  /// Constructs an empty pool.
+  /// @param[in] he       The context of the pooled ciphertexts.
+  /// @param[in] capacity Maximal number of idle ciphertexts to keep.
+  CTilePool(HeContext& he, size_t capacity = 16);
+
+  ~CTilePool();
+
+  CTilePool(const CTilePool& src) = delete;
+
+  CTilePool& operator=(const CTilePool& src) = delete;
+
+  /// Returns a copy of "src" stored in a recycled ciphertext if one is
+  /// available, or in a newly allocated one otherwise.
+  /// @param[in] src The ciphertext to copy.
+  std::shared_ptr<AbstractCiphertext> copyOf(const AbstractCiphertext& src);
+
+  /// Returns a copy of "src" whose ciphertext is taken from the pool.
+  /// @param[in] src The tile to copy.
+  CTile copyOf(const CTile& src);
+
+  /// Sets the maximal number of idle ciphertexts kept, freeing extra ones if
+  /// needed. A capacity of 0 disables pooling.
+  /// @param[in] capacity The new capacity.
+  void setCapacity(size_t capacity);
+
+  /// Returns the maximal number of idle ciphertexts kept.
+  size_t getCapacity() const;
+
+  /// Returns the number of idle ciphertexts currently in the pool.
+  size_t size() const;
+
+  /// Frees all idle ciphertexts. Ciphertexts currently in use are freed once
+  /// released instead of returning to the pool.
+  void clear();
+
+  /// Returns the number of copies stored in recycled ciphertexts.
+  long getHits() const { return hits; }
+
+  /// Returns the number of copies that required allocating a ciphertext.
+  long getMisses() const { return misses; }
+
+  /// Resets the hit and miss counters.
+  void resetCounters();
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_CTILEPOOL_H */
@@ -23,6 +23,8 @@
  */
 
 #include "Encoder.h"
+#include "PTileCache.h"
+#include "EncryptionPool.h"
 
 using namespace std;
 
@@ -65,6 +67,13 @@ vector<T> Encoder::adjustEncodeVectorSize(const vector<T>& vec) const
   return vecCopy;
 }
 
+void Encoder::checkBufferSize(int size) const
+{
+  if (size < 0 || size > he.slotCount())
+    throw runtime_error("Illegal buffer size " + to_string(size) +
+                        " where slot count=" + to_string(he.slotCount()));
+}
+
 void Encoder::setDefaultScale(double scale) { impl->setDefaultScale(scale); }
 
 double Encoder::getDefaultScale() const { return impl->getDefaultScale(); }
@@ -121,22 +130,52 @@ void Encoder::encode(PTile& res,
                      const vector<double>& vals,
                      int chainIndex) const
 {
-  impl->encode(*res.impl,
-               checkEncodeVectorSize(vals) ? vals
-                                           : adjustEncodeVectorSize(vals),
-               validateChainIndex(chainIndex));
+  encode(res, vals.data(), vals.size(), chainIndex);
+}
+
+void Encoder::encode(PTile& res,
+                     const double* vals,
+                     int size,
+                     int chainIndex) const
+{
+  checkBufferSize(size);
+  impl->encode(*res.impl, vals, size, validateChainIndex(chainIndex));
 }
 
 void Encoder::encode(PTile& res,
                      const vector<complex<double>>& vals,
                      int chainIndex) const
 {
-  impl->encode(*res.impl,
-               checkEncodeVectorSize(vals) ? vals
-                                           : adjustEncodeVectorSize(vals),
-               validateChainIndex(chainIndex));
+  encode(res, vals.data(), vals.size(), chainIndex);
+}
+
+void Encoder::encode(PTile& res,
+                     const complex<double>* vals,
+                     int size,
+                     int chainIndex) const
+{
+  checkBufferSize(size);
+  impl->encode(*res.impl, vals, size, validateChainIndex(chainIndex));
+}
+
+void Encoder::encodeCached(PTile& res, double val, int chainIndex) const
+{
+  res.impl = he.getPTileCache()
+                 .getScalar(val, validateChainIndex(chainIndex))
+                 ->clone();
 }
 
+void Encoder::encodeCached(PTile& res,
+                           const vector<double>& vals,
+                           int chainIndex) const
+{
+  checkBufferSize(vals.size());
+  res.impl =
+      he.getPTileCache().get(vals, validateChainIndex(chainIndex))->clone();
+}
+
+void Encoder::prepare(PTile& res) const { impl->prepare(*res.impl); }
+
 vector<int> Encoder::decodeInt(const PTile& src) const
 {
   return impl->decodeInt(*src.impl);
@@ -157,22 +196,44 @@ vector<complex<double>> Encoder::decodeComplex(const PTile& src) const
   return impl->decodeComplex(*src.impl);
 }
 
+void Encoder::decodeDouble(const PTile& src, double* out, int size) const
+{
+  checkBufferSize(size);
+  impl->decodeDouble(*src.impl, out, size);
+}
+
+void Encoder::decodeComplex(const PTile& src,
+                            complex<double>* out,
+                            int size) const
+{
+  checkBufferSize(size);
+  impl->decodeComplex(*src.impl, out, size);
+}
+
 void Encoder::encrypt(CTile& res, const PTile& src) const
 {
-  impl->encrypt(*res.impl, *src.impl);
+  if (encryptionPool && encryptionPool->encrypt(res, src))
+    return;
+  impl->encrypt(res.overwritten(), *src.impl);
 }
 
 void Encoder::decrypt(PTile& res, const CTile& src) const
 {
-  impl->decrypt(*res.impl, *src.impl);
+  impl->decrypt(*res.impl, *src.maintained());
 }
 
 void Encoder::encodeEncrypt(CTile& res,
                             const vector<int>& vals,
                             int chainIndex) const
 {
+  if (encryptionPool) {
+    PTile p(he);
+    encode(p, vals, chainIndex);
+    encrypt(res, p);
+    return;
+  }
   impl->encodeEncrypt(
-      *res.impl,
+      res.overwritten(),
       checkEncodeVectorSize(vals) ? vals : adjustEncodeVectorSize(vals),
       validateChainIndex(chainIndex));
 }
@@ -181,8 +242,14 @@ void Encoder::encodeEncrypt(CTile& res,
                             const vector<long>& vals,
                             int chainIndex) const
 {
+  if (encryptionPool) {
+    PTile p(he);
+    encode(p, vals, chainIndex);
+    encrypt(res, p);
+    return;
+  }
   impl->encodeEncrypt(
-      *res.impl,
+      res.overwritten(),
       checkEncodeVectorSize(vals) ? vals : adjustEncodeVectorSize(vals),
       validateChainIndex(chainIndex));
 }
@@ -191,40 +258,82 @@ void Encoder::encodeEncrypt(CTile& res,
                             const vector<double>& vals,
                             int chainIndex) const
 {
+  encodeEncrypt(res, vals.data(), vals.size(), chainIndex);
+}
+
+void Encoder::encodeEncrypt(CTile& res,
+                            const double* vals,
+                            int size,
+                            int chainIndex) const
+{
+  checkBufferSize(size);
+  if (encryptionPool) {
+    PTile p(he);
+    impl->encode(*p.impl, vals, size, validateChainIndex(chainIndex));
+    encrypt(res, p);
+    return;
+  }
   impl->encodeEncrypt(
-      *res.impl,
-      checkEncodeVectorSize(vals) ? vals : adjustEncodeVectorSize(vals),
-      validateChainIndex(chainIndex));
+      res.overwritten(), vals, size, validateChainIndex(chainIndex));
 }
 
 void Encoder::encodeEncrypt(CTile& res,
                             const vector<complex<double>>& vals,
                             int chainIndex) const
 {
+  encodeEncrypt(res, vals.data(), vals.size(), chainIndex);
+}
+
+void Encoder::encodeEncrypt(CTile& res,
+                            const complex<double>* vals,
+                            int size,
+                            int chainIndex) const
+{
+  checkBufferSize(size);
+  if (encryptionPool) {
+    PTile p(he);
+    impl->encode(*p.impl, vals, size, validateChainIndex(chainIndex));
+    encrypt(res, p);
+    return;
+  }
   impl->encodeEncrypt(
-      *res.impl,
-      checkEncodeVectorSize(vals) ? vals : adjustEncodeVectorSize(vals),
-      validateChainIndex(chainIndex));
+      res.overwritten(), vals, size, validateChainIndex(chainIndex));
 }
 
 vector<int> Encoder::decryptDecodeInt(const CTile& src) const
 {
-  return impl->decryptDecodeInt(*src.impl);
+  return impl->decryptDecodeInt(*src.maintained());
 }
 
 vector<long> Encoder::decryptDecodeLong(const CTile& src) const
 {
-  return impl->decryptDecodeLong(*src.impl);
+  return impl->decryptDecodeLong(*src.maintained());
 }
 
 vector<double> Encoder::decryptDecodeDouble(const CTile& src) const
 {
-  return impl->decryptDecodeDouble(*src.impl);
+  return impl->decryptDecodeDouble(*src.maintained());
 }
 
 vector<complex<double>> Encoder::decryptDecodeComplex(const CTile& src) const
 {
-  return impl->decryptDecodeComplex(*src.impl);
+  return impl->decryptDecodeComplex(*src.maintained());
+}
+
+void Encoder::decryptDecodeDouble(const CTile& src,
+                                  double* out,
+                                  int size) const
+{
+  checkBufferSize(size);
+  impl->decryptDecodeDouble(*src.maintained(), out, size);
+}
+
+void Encoder::decryptDecodeComplex(const CTile& src,
+                                   complex<double>* out,
+                                   int size) const
+{
+  checkBufferSize(size);
+  impl->decryptDecodeComplex(*src.maintained(), out, size);
 }
 
 void Encoder::printErrorStats(CTile& actualC,
@@ -297,7 +406,8 @@ double Encoder::assertEquals(const CTile& c,
                              double eps,
                              bool percent) const
 {
-  return impl->assertEquals(*c.impl, title, expectedVals, eps, percent);
+  return impl->assertEquals(
+      *c.maintained(), title, expectedVals, eps, percent);
 }
 
 double Encoder::assertEquals(const CTile& c,
@@ -306,7 +416,8 @@ double Encoder::assertEquals(const CTile& c,
                              double eps,
                              bool percent) const
 {
-  return impl->assertEquals(*c.impl, title, expectedVals, eps, percent);
+  return impl->assertEquals(
+      *c.maintained(), title, expectedVals, eps, percent);
 }
 
 double Encoder::assertEquals(const CTile& c,
@@ -315,7 +426,8 @@ double Encoder::assertEquals(const CTile& c,
                              double eps,
                              bool percent) const
 {
-  return impl->assertEquals(*c.impl, title, expectedVals, eps, percent);
+  return impl->assertEquals(
+      *c.maintained(), title, expectedVals, eps, percent);
 }
 
 double Encoder::assertEquals(const CTile& c,
@@ -324,6 +436,7 @@ double Encoder::assertEquals(const CTile& c,
                              double eps,
                              bool percent) const
 {
-  return impl->assertEquals(*c.impl, title, expectedVals, eps, percent);
+  return impl->assertEquals(
+      *c.maintained(), title, expectedVals, eps, percent);
 }
 } // namespace helayers
@@ -33,6 +33,8 @@
 
 namespace helayers {
 
+class EncryptionPool;
+
 /// A class used to encode, encrypt, decode and decrypt ciphertexts and
 /// plaintexts.
 class Encoder
@@ -42,6 +44,8 @@ class Encoder
 
   std::shared_ptr<AbstractEncoder> impl;
 
+  std::shared_ptr<EncryptionPool> encryptionPool;
+
   /// Checks if a vector have appropriate number of slots.
   template <typename T>
   bool checkEncodeVectorSize(const std::vector<T>& vec) const;
@@ -50,6 +54,11 @@ class Encoder
   template <typename T>
   std::vector<T> adjustEncodeVectorSize(const std::vector<T>& vec) const;
 
+  /// Checks that a buffer of "size" values fits into the slots of a tile.
+  /// Shorter buffers are zero padded by the underlying encoder, like
+  /// vectors are by adjustEncodeVectorSize().
+  void checkBufferSize(int size) const;
+
 public:
   /// Constructs a ready to use object.
   /// @param[in] he the underlying context.
@@ -186,6 +195,65 @@ public:
               const std::vector<std::complex<double>>& vals,
               int chainIndex = -1) const;
 
+  /// Encodes "size" doubles starting at "vals" into a PTile, without copying
+  /// them first. Slots beyond "size" are set to zero.
+  /// @param[out] res        The encoded PTile
+  /// @param[in] vals        Pointer to the values to encode
+  /// @param[in] size        Number of values to encode
+  /// @param[in] chainIndex  If HeContext is a CKKS context, specifies the
+  ///                        chainIndex of the resulting PTile. otherwise, this
+  ///                        parameter is ignored.
+  /// @throw runtime_error if size > slot count
+  void encode(PTile& res,
+              const double* vals,
+              int size,
+              int chainIndex = -1) const;
+
+  /// Encodes "size" complex numbers starting at "vals" into a PTile, without
+  /// copying them first. Slots beyond "size" are set to zero.
+  /// @param[out] res        The encoded PTile
+  /// @param[in] vals        Pointer to the values to encode
+  /// @param[in] size        Number of values to encode
+  /// @param[in] chainIndex  If HeContext is a CKKS context, specifies the
+  ///                        chainIndex of the resulting PTile. otherwise, this
+  ///                        parameter is ignored.
+  /// @throw runtime_error if size > slot count
+  void encode(PTile& res,
+              const std::complex<double>* vals,
+              int size,
+              int chainIndex = -1) const;
+
+  /// Like encode(PTile&, double, int), but reuses a previous encoding of the
+  /// same value, chain index and scale from the context's PTileCache.
+  /// @param[out] res        The encoded PTile
+  /// @param[in] val         The value to encode
+  /// @param[in] chainIndex  If HeContext is a CKKS context, specifies the
+  ///                        chainIndex of the resulting PTile. otherwise, this
+  ///                        parameter is ignored.
+  void encodeCached(PTile& res, double val, int chainIndex = -1) const;
+
+  /// Like encode(PTile&, const std::vector<double>&, int), but reuses a
+  /// previous encoding of the same values, chain index and scale from the
+  /// context's PTileCache.
+  /// @param[out] res        The encoded PTile
+  /// @param[in] vals        The vector to encode
+  /// @param[in] chainIndex  If HeContext is a CKKS context, specifies the
+  ///                        chainIndex of the resulting PTile. otherwise, this
+  ///                        parameter is ignored.
+  /// @throw runtime_error if vals.size() > slot count
+  void encodeCached(PTile& res,
+                    const std::vector<double>& vals,
+                    int chainIndex = -1) const;
+
+  /// Computes and stores in "res" the form of its plaintext that ciphertext
+  /// operations use, so that CTile operations with "res" skip encoding it
+  /// again each time. Meant for plaintexts used many times, such as model
+  /// weights and masks, as it may take several times the memory of the
+  /// plaintext. Encoding into "res" again discards this form.
+  /// Has no effect in schemes where plaintexts are already in this form.
+  /// @param[in,out] res The PTile to prepare
+  void prepare(PTile& res) const;
+
   /// Decodes the value of the given PTile into a vector of ints.
   /// If the underlying FHE scheme is a scheme that supports floating point
   /// values, then "src" is first decrypted into a vector of doubles and then
@@ -208,6 +276,36 @@ public:
   /// @param[in] src The PTile to decode.
   std::vector<std::complex<double>> decodeComplex(const PTile& src) const;
 
+  /// Decodes the first "size" slots of the given PTile into "out".
+  /// @param[in] src   The PTile to decode.
+  /// @param[out] out  Buffer with room for at least "size" values.
+  /// @param[in] size  Number of slots to decode.
+  /// @throw runtime_error if size > slot count
+  void decodeDouble(const PTile& src, double* out, int size) const;
+
+  /// Decodes the first "size" slots of the given PTile into "out".
+  /// @param[in] src   The PTile to decode.
+  /// @param[out] out  Buffer with room for at least "size" values.
+  /// @param[in] size  Number of slots to decode.
+  /// @throw runtime_error if size > slot count
+  void decodeComplex(const PTile& src,
+                     std::complex<double>* out,
+                     int size) const;
+
+  /// Sets a pool of encryptions of zero for encrypt() and encodeEncrypt() to
+  /// use when it has one ready. Pass nullptr to stop using a pool.
+  /// @param[in] pool The pool to use.
+  void setEncryptionPool(const std::shared_ptr<EncryptionPool>& pool)
+  {
+    encryptionPool = pool;
+  }
+
+  /// Returns the pool set by setEncryptionPool(), or nullptr.
+  const std::shared_ptr<EncryptionPool>& getEncryptionPool() const
+  {
+    return encryptionPool;
+  }
+
   /// Encrypts "src" into "res".
   /// @param[out] res  The resulting CTile.
   /// @param[in]  src  The PTile to encrypt
@@ -277,6 +375,36 @@ public:
                      const std::vector<std::complex<double>>& vals,
                      int chainIndex = -1) const;
 
+  /// Encodes and then encrypts "size" doubles starting at "vals" into a
+  /// CTile, without copying them first. Slots beyond "size" are set to zero.
+  /// @param[out] res        The resulting CTile
+  /// @param[in] vals        Pointer to the values to encode
+  /// @param[in] size        Number of values to encode
+  /// @param[in] chainIndex  If HeContext is a CKKS context, specifies the
+  ///                        chainIndex of the resulting CTile. otherwise, this
+  ///                        parameter is ignored.
+  /// @throw runtime_error if size > slot count
+  void encodeEncrypt(CTile& res,
+                     const double* vals,
+                     int size,
+                     int chainIndex = -1) const;
+
+  /// Encodes and then encrypts "size" complex numbers starting at "vals" into
+  /// a CTile, without copying them first. Slots beyond "size" are set to zero.
+  /// @param[out] res        The resulting CTile
+  /// @param[in] vals        Pointer to the values to encode
+  /// @param[in] size        Number of values to encode
+  /// @param[in] chainIndex  If HeContext is a CKKS context, specifies the
+  ///                        chainIndex of the resulting CTile. otherwise, this
+  ///                        parameter is ignored.
+  /// @throw runtime_error If size > slot count
+  /// @throw runtime_error If the underlying FHE scheme does not support
+  ///                      complex values.
+  void encodeEncrypt(CTile& res,
+                     const std::complex<double>* vals,
+                     int size,
+                     int chainIndex = -1) const;
+
   /// Decodes and then decryots the given CTile into a vector of ints.
   /// If the underlying FHE scheme is a scheme that supports floating point
   /// values, then "src" is first decrypted into a vector of doubles and then
@@ -301,6 +429,24 @@ public:
   std::vector<std::complex<double>> decryptDecodeComplex(
       const CTile& src) const;
 
+  /// Decrypts the given CTile and decodes its first "size" slots into "out".
+  /// Unlike the vector returning variant, no result vector is allocated.
+  /// @param[in] src   The CTile to decode and decrypt.
+  /// @param[out] out  Buffer with room for at least "size" values.
+  /// @param[in] size  Number of slots to decode.
+  /// @throw runtime_error if size > slot count
+  void decryptDecodeDouble(const CTile& src, double* out, int size) const;
+
+  /// Decrypts the given CTile and decodes its first "size" slots into "out".
+  /// Unlike the vector returning variant, no result vector is allocated.
+  /// @param[in] src   The CTile to decode and decrypt.
+  /// @param[out] out  Buffer with room for at least "size" values.
+  /// @param[in] size  Number of slots to decode.
+  /// @throw runtime_error if size > slot count
+  void decryptDecodeComplex(const CTile& src,
+                            std::complex<double>* out,
+                            int size) const;
+
   /// Prints statstical information relating to the difference between "actualC"
   /// and "expectedZ".
   /// @param[in] actualC     The CTile to decode-decrypt and to compare to
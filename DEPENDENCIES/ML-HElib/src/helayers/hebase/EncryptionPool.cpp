@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "EncryptionPool.h"
+#include "Encoder.h"
+#include "HelayersTimer.h"
+
+using namespace std;
+
+namespace helayers {
+
+EncryptionPool::EncryptionPool(HeContext& he, size_t capacity, int numThreads)
+    : he(he),
+      zero(he),
+      capacity(capacity),
+      countersStart(chrono::steady_clock::now())
+{
+  if (numThreads <= 0)
+    throw invalid_argument("Number of threads must be positive, got " +
+                           to_string(numThreads));
+  Encoder enc(he);
+  enc.encode(zero, 0);
+  for (int i = 0; i < numThreads; ++i)
+    threads.emplace_back(&EncryptionPool::refill, this);
+}
+
+EncryptionPool::~EncryptionPool()
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    stopping = true;
+  }
+  refillCv.notify_all();
+  filledCv.notify_all();
+  for (thread& t : threads)
+    t.join();
+}
+
+void EncryptionPool::refill()
+{
+  Encoder enc(he);
+  unique_lock<mutex> lock(mtx);
+  while (true) {
+    refillCv.wait(lock, [this]() {
+      return stopping || zeros.size() + inProgress < capacity;
+    });
+    if (stopping)
+      return;
+
+    ++inProgress;
+    lock.unlock();
+    CTile c(he);
+    {
+      HELAYERS_TIMER("EncryptionPool::refill");
+      enc.encrypt(c, zero);
+    }
+    lock.lock();
+    --inProgress;
+
+    // the capacity may have been reduced meanwhile
+    if (zeros.size() < capacity)
+      zeros.push_back(move(c));
+    ++generated;
+    filledCv.notify_all();
+  }
+}
+
+bool EncryptionPool::encrypt(CTile& res, const PTile& src)
+{
+  if (src.getChainIndex() != zero.getChainIndex()) {
+    ++misses;
+    return false;
+  }
+  {
+    lock_guard<mutex> lock(mtx);
+    if (zeros.empty()) {
+      ++misses;
+      return false;
+    }
+    res = move(zeros.front());
+    zeros.pop_front();
+  }
+  refillCv.notify_one();
+  ++hits;
+
+  HELAYERS_TIMER("EncryptionPool::encrypt");
+  res.addPlain(src);
+  return true;
+}
+
+void EncryptionPool::setCapacity(size_t val)
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    capacity = val;
+    while (zeros.size() > capacity)
+      zeros.pop_back();
+  }
+  refillCv.notify_all();
+  filledCv.notify_all();
+}
+
+size_t EncryptionPool::getCapacity() const
+{
+  lock_guard<mutex> lock(mtx);
+  return capacity;
+}
+
+size_t EncryptionPool::size() const
+{
+  lock_guard<mutex> lock(mtx);
+  return zeros.size();
+}
+
+void EncryptionPool::waitUntilFull() const
+{
+  unique_lock<mutex> lock(mtx);
+  filledCv.wait(lock,
+                [this]() { return stopping || zeros.size() >= capacity; });
+}
+
+double EncryptionPool::getHitRate() const
+{
+  long h = hits;
+  long total = h + misses;
+  return total == 0 ? 0 : (double)h / total;
+}
+
+double EncryptionPool::getRefillRate() const
+{
+  chrono::duration<double> elapsed;
+  {
+    lock_guard<mutex> lock(mtx);
+    elapsed = chrono::steady_clock::now() - countersStart;
+  }
+  return elapsed.count() > 0 ? generated / elapsed.count() : 0;
+}
+
+void EncryptionPool::resetCounters()
+{
+  lock_guard<mutex> lock(mtx);
+  hits = 0;
+  misses = 0;
+  generated = 0;
+  countersStart = chrono::steady_clock::now();
+}
+} // namespace helayers
@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_ENCRYPTIONPOOL_H
+#define SRC_HELAYERS_ENCRYPTIONPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CTile.h"
+#include "PTile.h"
+
+namespace helayers {
+
+/// A pool of fresh encryptions of zero, generated ahead of time on background
+/// threads. Encrypting a plaintext with the pool takes one of them and adds
+/// the plaintext to it, replacing the public key encryption on the request
+/// path with a single addition. Each pooled ciphertext is used once.
+///
+/// Attach it to an Encoder with Encoder::setEncryptionPool() to make its
+/// encrypt() and encodeEncrypt() methods use it. The background threads
+/// refill the pool whenever it is below capacity, so it fills up during idle
+/// time between online encryptions.
+///
+/// The pool must be destroyed before its context is destroyed or loaded.
+/// This class is thread safe.
+class EncryptionPool
+{
+  HeContext& he;
+
+  PTile zero;
+
+  size_t capacity;
+
+  std::deque<CTile> zeros;
+
+  // encryptions of zero being computed by the background threads
+  size_t inProgress = 0;
+
+  bool stopping = false;
+
+  mutable std::mutex mtx;
+
+  std::condition_variable refillCv;
+
+  mutable std::condition_variable filledCv;
+
+  std::vector<std::thread> threads;
+
+  std::atomic<long> hits{0};
+
+  std::atomic<long> misses{0};
+
+  std::atomic<long> generated{0};
+
+  std::chrono::steady_clock::time_point countersStart;
+
+  void refill();
+
+public:
+  /// Constructs a pool and starts filling it in the background.
+  /// @param[in] he         The context to encrypt with.
+  /// @param[in] capacity   Number of encryptions of zero to keep ready.
+  /// @param[in] numThreads Number of background threads filling the pool.
+  /// @throw invalid_argument if numThreads is not positive.
+  EncryptionPool(HeContext& he, size_t capacity = 16, int numThreads = 1);
+
+  /// Stops the background threads, waiting for encryptions in progress.
+  ~EncryptionPool();
+
+  EncryptionPool(const EncryptionPool& src) = delete;
+
+  EncryptionPool& operator=(const EncryptionPool& src) = delete;
+
+  /// Encrypts "src" into "res" using an encryption of zero from the pool.
+  /// Returns false, leaving "res" unchanged, if the pool is empty or "src" is
+  /// at a different chain index than the pooled ciphertexts. The caller then
+  /// encrypts it directly.
+  /// @param[out] res The resulting ciphertext.
+  /// @param[in]  src The plaintext to encrypt.
+  bool encrypt(CTile& res, const PTile& src);
+
+  /// Sets the number of encryptions of zero to keep ready, dropping extra
+  /// ones if needed.
+  /// @param[in] capacity The new capacity.
+  void setCapacity(size_t capacity);
+
+  /// Returns the number of encryptions of zero kept ready.
+  size_t getCapacity() const;
+
+  /// Returns the number of encryptions of zero currently ready.
+  size_t size() const;
+
+  /// Blocks until the pool is full. Useful to warm it up before an online
+  /// phase.
+  void waitUntilFull() const;
+
+  /// Returns the number of encryptions served from the pool.
+  long getHits() const { return hits; }
+
+  /// Returns the number of encryptions that found the pool empty or could not
+  /// use it.
+  long getMisses() const { return misses; }
+
+  /// Returns the fraction of encryptions served from the pool, or 0 if there
+  /// were none.
+  double getHitRate() const;
+
+  /// Returns the number of encryptions of zero generated by the background
+  /// threads.
+  long getGenerated() const { return generated; }
+
+  /// Returns the number of encryptions of zero generated per second, since
+  /// construction or the last resetCounters().
+  double getRefillRate() const;
+
+  /// Resets the hit, miss and generated counters.
+  void resetCounters();
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_ENCRYPTIONPOOL_H */
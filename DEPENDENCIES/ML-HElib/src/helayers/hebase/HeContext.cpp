@@ -23,11 +23,23 @@
  */
 
 #include "HeContext.h"
+#include "PTileCache.h"
+#include "CTilePool.h"
+#include "CTile.h"
+#include "PTile.h"
+#include "Encoder.h"
+#include "FileUtils.h"
 #include "utils/BinIoUtils.h"
+#include "utils/HelayersConfig.h"
 #include "AlwaysAssert.h"
 #include "impl/AbstractFunctionEvaluator.h"
 #include "utils/Saveable.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <sstream>
 
 using namespace std;
 
@@ -39,21 +51,36 @@ HeContext::ContextMap& HeContext::getRegisteredHeContextMap()
   return contextMap;
 }
 
-HeContext::HeContext(){};
+HeContext::HeContext()
+    : ptileCache(make_shared<PTileCache>(*this)),
+      ctilePool(make_shared<CTilePool>(*this)){};
 
 HeContext::~HeContext(){};
 
-void HeContext::saveToFile(const std::string& fileName, bool withSecretKey)
+void HeContext::saveToFile(const std::string& fileName,
+                           bool withSecretKey,
+                           bool compressed)
 {
   ofstream out = Saveable::openOfstream(fileName);
-  save(out, withSecretKey);
+  if (compressed) {
+    ostringstream raw;
+    save(raw, withSecretKey);
+    BinIoUtils::writeCompressed(out, raw.str());
+  } else {
+    save(out, withSecretKey);
+  }
   out.close();
 }
 
-void HeContext::loadFromFile(const std::string& fileName)
+void HeContext::loadFromFile(const std::string& fileName, bool compressed)
 {
   ifstream in = Saveable::openIfstream(fileName);
-  load(in);
+  if (compressed) {
+    istringstream raw(BinIoUtils::readCompressed(in));
+    load(raw);
+  } else {
+    load(in);
+  }
   in.close();
 }
 
@@ -104,6 +131,139 @@ void HeContext::load(std::istream& in)
     throw runtime_error("Context for " + getContextFileHeaderCode() +
                         " trying to read a context for " + key);
   in.read((char*)&defaultScale, sizeof(defaultScale));
+
+  // cached encodings belong to the previous configuration
+  ptileCache->clear();
+  ctilePool->clear();
+  lock_guard<mutex> lock(estimatedLatenciesMutex);
+  estimatedLatencies.reset();
+}
+
+// Returns the median latency in microseconds of op, calling setup before each
+// repetition outside of the measured time.
+static double measureLatency(int repetitions,
+                             const function<void()>& setup,
+                             const function<void()>& op)
+{
+  vector<double> micros;
+  // the first run warms up caches and lazily built tables
+  for (int i = 0; i <= repetitions; ++i) {
+    setup();
+    auto start = chrono::steady_clock::now();
+    op();
+    chrono::duration<double, micro> elapsed =
+        chrono::steady_clock::now() - start;
+    if (i > 0)
+      micros.push_back(elapsed.count());
+  }
+  nth_element(micros.begin(), micros.begin() + micros.size() / 2, micros.end());
+  return micros[micros.size() / 2];
+}
+
+shared_ptr<JsonWrapper> HeContext::calibrateLatencies(int repetitions)
+{
+  if (repetitions <= 0)
+    throw invalid_argument("repetitions must be positive");
+  Encoder enc(*this);
+  vector<double> vals(slotCount(), 1);
+  PTile p(*this);
+  CTile c1(*this), c2(*this), res(*this);
+  enc.encode(p, vals);
+  enc.encrypt(c1, p);
+  enc.encrypt(c2, p);
+  auto nop = [] {};
+  auto copyC1 = [&] { res = c1; };
+
+  shared_ptr<JsonWrapper> latencies = make_shared<JsonWrapper>();
+  latencies->init();
+  latencies->setString("signature", getSignature());
+  latencies->setInt("repetitions", repetitions);
+  latencies->setDouble(
+      "encode", measureLatency(repetitions, nop, [&] { enc.encode(p, vals); }));
+  latencies->setDouble(
+      "encrypt",
+      measureLatency(repetitions, nop, [&] { enc.encrypt(res, p); }));
+  if (hasSecretKey()) {
+    PTile decrypted(*this);
+    latencies->setDouble(
+        "decrypt", measureLatency(repetitions, nop, [&] {
+          enc.decrypt(decrypted, c1);
+        }));
+  }
+  latencies->setDouble(
+      "add", measureLatency(repetitions, copyC1, [&] { res.add(c2); }));
+  latencies->setDouble(
+      "multiplyPlain",
+      measureLatency(repetitions, copyC1, [&] { res.multiplyPlain(p); }));
+  latencies->setDouble(
+      "multiplyRaw",
+      measureLatency(repetitions, copyC1, [&] { res.multiplyRaw(c2); }));
+  CTile product(c1);
+  product.multiplyRaw(c2);
+  auto copyProduct = [&] { res = product; };
+  latencies->setDouble(
+      "relinearize",
+      measureLatency(repetitions, copyProduct, [&] { res.relinearize(); }));
+  if (traits.getSupportsExplicitRescale())
+    latencies->setDouble(
+        "rescale",
+        measureLatency(repetitions, copyProduct, [&] { res.rescale(); }));
+  latencies->setDouble(
+      "multiply",
+      measureLatency(repetitions, copyC1, [&] { res.multiply(c2); }));
+  latencies->setDouble(
+      "rotate", measureLatency(repetitions, copyC1, [&] { res.rotate(1); }));
+  stringstream saved;
+  auto clearSaved = [&] { saved.str(""); };
+  latencies->setDouble(
+      "save",
+      measureLatency(repetitions, clearSaved, [&] { c1.save(saved); }));
+  auto rewindSaved = [&] { saved.seekg(0); };
+  latencies->setDouble(
+      "load", measureLatency(repetitions, rewindSaved, [&] {
+        res.load(saved);
+      }));
+  return latencies;
+}
+
+string HeContext::getEstimatedLatenciesFile() const
+{
+  string name = getSignature();
+  replace_if(
+      name.begin(),
+      name.end(),
+      [](char ch) { return !isalnum((unsigned char)ch) && ch != '-'; },
+      '_');
+  return getCacheDir() + "/latencies_" + name + ".json";
+}
+
+shared_ptr<JsonWrapper> HeContext::getEstimatedLatencies()
+{
+  lock_guard<mutex> lock(estimatedLatenciesMutex);
+  if (estimatedLatencies)
+    return estimatedLatencies;
+
+  string fileName = getEstimatedLatenciesFile();
+  if (FileUtils::fileExists(fileName)) {
+    try {
+      shared_ptr<JsonWrapper> cached = make_shared<JsonWrapper>();
+      ifstream in(fileName);
+      cached->load(in);
+      if (cached->getString("signature") == getSignature()) {
+        estimatedLatencies = cached;
+        return estimatedLatencies;
+      }
+    } catch (const exception&) {
+      // an unreadable cache file is replaced below
+    }
+  }
+
+  estimatedLatencies = calibrateLatencies();
+  FileUtils::createDir(getCacheDir());
+  ofstream out = Saveable::openOfstream(fileName);
+  estimatedLatencies->print(out, true);
+  out.close();
+  return estimatedLatencies;
 }
 
 shared_ptr<AbstractFunctionEvaluator> HeContext::getFunctionEvaluator()
@@ -112,14 +272,21 @@ shared_ptr<AbstractFunctionEvaluator> HeContext::getFunctionEvaluator()
 }
 
 std::shared_ptr<HeContext> HeContext::loadHeContextFromFile(
-    const std::string& fileName)
+    const std::string& fileName,
+    bool compressed)
 {
   ifstream in;
   in.open(fileName);
   if (in.fail())
     throw runtime_error("Failed to open file " + fileName);
   in.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-  std::shared_ptr<HeContext> res = loadHeContext(in);
+  std::shared_ptr<HeContext> res;
+  if (compressed) {
+    istringstream raw(BinIoUtils::readCompressed(in));
+    res = loadHeContext(raw);
+  } else {
+    res = loadHeContext(in);
+  }
   in.close();
   return res;
 }
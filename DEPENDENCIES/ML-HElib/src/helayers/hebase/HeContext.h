@@ -30,6 +30,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
 #include "HeTraits.h"
 #include "utils/JsonWrapper.h"
 
@@ -40,6 +41,8 @@ class AbstractPlaintext;
 class AbstractEncoder;
 class AbstractFunctionEvaluator;
 class AbstractBitwiseEvaluator;
+class PTileCache;
+class CTilePool;
 
 ///@brief For internal use.
 struct HeConfigRequirement
@@ -93,6 +96,14 @@ class HeContext
 {
   double defaultScale = 1;
 
+  std::shared_ptr<PTileCache> ptileCache;
+
+  std::shared_ptr<CTilePool> ctilePool;
+
+  std::shared_ptr<JsonWrapper> estimatedLatencies;
+
+  std::mutex estimatedLatenciesMutex;
+
   typedef std::map<std::string, const HeContext*> ContextMap;
 
   /// returns registered context map.
@@ -147,6 +158,16 @@ public:
     return nullptr;
   }
 
+  /// Returns the cache of encoded plaintexts owned by this context.
+  /// It is used by scalar operations on ciphertexts, and can be used directly
+  /// to reuse encodings of frequently used constants and masks.
+  PTileCache& getPTileCache() { return *ptileCache; }
+
+  /// Returns the pool of ciphertexts owned by this context.
+  /// It supplies the temporaries of innerSum() and similar loops, and can be
+  /// used directly via CTilePool::copyOf() for an application's own loops.
+  CTilePool& getCTilePool() { return *ctilePool; }
+
   /// Returns an HeTraits object containing various properties of the
   /// underlying scheme.
   inline const HeTraits& getTraits() { return traits; }
@@ -215,12 +236,16 @@ public:
   ///
   ///  @param[in] fileName file to write to
   ///  @param[in] withSecretKey whether to include the secret key
-  void saveToFile(const std::string& fileName, bool withSecretKey);
+  ///  @param[in] compressed whether to compress the file with zlib
+  void saveToFile(const std::string& fileName,
+                  bool withSecretKey,
+                  bool compressed = false);
 
   ///  Loads context saved by the saveToFile() method
   ///
   ///  @param[in] fileName file to read from
-  void loadFromFile(const std::string& fileName);
+  ///  @param[in] compressed must match the value used when saving
+  void loadFromFile(const std::string& fileName, bool compressed = false);
 
   /// save secret key to the given file. \n
   /// @param[out] fileName the path of the file to save to.
@@ -251,17 +276,34 @@ public:
   /// to load previously stored contexts based on their signatures.
   virtual std::string getSignature() const { return getSchemeName(); };
 
-  /// For internal use
-  inline virtual std::shared_ptr<JsonWrapper> getEstimatedLatencies() const
-  {
-    throw std::runtime_error("not implemented");
-  };
+  /// Returns the estimated latency in microseconds of each primitive
+  /// operation over this context, keyed by operation name: "encode",
+  /// "encrypt", "decrypt", "add", "multiplyPlain", "multiplyRaw",
+  /// "relinearize", "rescale", "multiply", "rotate", "save" and "load".
+  /// Operations the context does not support are omitted.
+  ///
+  /// The latencies are measured by calibrateLatencies() on first use, and
+  /// cached in memory and in a file under getCacheDir() named after
+  /// getSignature(), so that later runs with the same configuration on the
+  /// same machine do not measure them again. Delete the file to recalibrate.
+  virtual std::shared_ptr<JsonWrapper> getEstimatedLatencies();
+
+  /// Returns the file in which getEstimatedLatencies() caches its results.
+  std::string getEstimatedLatenciesFile() const;
+
+  /// Measures the latencies reported by getEstimatedLatencies(), ignoring
+  /// any cached results. Each latency is the median of the given number of
+  /// repetitions, on ciphertexts at the top chain index.
+  /// @param[in] repetitions Number of times to repeat each operation.
+  virtual std::shared_ptr<JsonWrapper> calibrateLatencies(int repetitions = 5);
 
   /// Returns a pointer to a context initialized from file.
   /// Context type is dynamically determined by content of file.
   /// @param[in] fileName file to read from
+  /// @param[in] compressed must match the value used when saving
   static std::shared_ptr<HeContext> loadHeContextFromFile(
-      const std::string& fileName);
+      const std::string& fileName,
+      bool compressed = false);
 
   /// Returns a pointer to a context initialized from stream.
   /// Context type is dynamically determined by content of stream.
@@ -24,12 +24,14 @@
 
 #include "HelayersTimer.h"
 #include "AlwaysAssert.h"
+#include "utils/JsonWrapper.h"
 #include <iostream>
+#include <algorithm>
 #include <iomanip>
 #include <mutex>
 #include <math.h>
-#include <time.h>
 #include <omp.h>
+#include <time.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -40,8 +42,19 @@ using namespace std;
 
 namespace helayers {
 
-HelayersTimer::SectionInfo HelayersTimer::top("all");
-HelayersTimer::SectionInfo* HelayersTimer::current = &top;
+mutex HelayersTimer::registryMtx;
+unordered_map<string, int> HelayersTimer::sectionIds;
+deque<string> HelayersTimer::sectionNames;
+vector<shared_ptr<HelayersTimer::ThreadTree>> HelayersTimer::threadTrees;
+int HelayersTimer::nextThreadIndex = 0;
+HelayersTimer::SectionInfo HelayersTimer::retired("all");
+vector<pair<int, vector<HelayersTimer::TraceEvent>>>
+    HelayersTimer::retiredTraces;
+atomic<int64_t> HelayersTimer::serialPosition(-1);
+atomic<int> HelayersTimer::samplingRate(1);
+atomic<bool> HelayersTimer::traceEnabled(false);
+const high_resolution_clock::time_point HelayersTimer::traceOrigin =
+    high_resolution_clock::now();
 bool HelayersTimer::multiThreadMode = false;
 
 HelayersTimer::HelayersTimer()
@@ -51,22 +64,148 @@ HelayersTimer::HelayersTimer()
   cpu_start = getProcessCPUTime();
 }
 
-HelayersTimer::SectionInfo& HelayersTimer::SectionInfo::getSubSection(
-    const std::string& title)
+int HelayersTimer::intern(const std::string& section)
+{
+  const lock_guard<mutex> lock(registryMtx);
+  auto it = sectionIds.find(section);
+  if (it != sectionIds.end())
+    return it->second;
+  int id = sectionNames.size();
+  sectionNames.push_back(section);
+  sectionIds[section] = id;
+  return id;
+}
+
+const string& HelayersTimer::getSectionName(int sectionId)
+{
+  const lock_guard<mutex> lock(registryMtx);
+  if (sectionId < 0 || sectionId >= (int)sectionNames.size())
+    throw invalid_argument("unknown section id " + to_string(sectionId));
+  return sectionNames[sectionId];
+}
+
+HelayersTimer::ThreadTree::ThreadTree() { nodes.emplace_back(-1, -1); }
+
+void HelayersTimer::ThreadTree::clear()
 {
   const lock_guard<mutex> lock(mtx);
-  if (subSections.count(title) == 0) {
-    SectionInfo& res = subSections[title];
-    res.parent = this;
-    res.name = title;
-    return res;
+  nodes.clear();
+  nodes.emplace_back(-1, -1);
+  current = 0;
+  startPoints.clear();
+  trace.clear();
+  inheritedPosition = -1;
+  inheritedNode = 0;
+}
+
+int HelayersTimer::ThreadTree::getChild(int node, int sectionId)
+{
+  for (const auto& child : nodes[node].children)
+    if (child.first == sectionId)
+      return child.second;
+
+  const lock_guard<mutex> lock(mtx);
+  int res = nodes.size();
+  nodes.emplace_back(sectionId, node);
+  nodes[node].children.push_back({sectionId, res});
+  return res;
+}
+
+void HelayersTimer::ThreadTree::addTraceEvent(
+    int sectionId,
+    char phase,
+    high_resolution_clock::time_point time)
+{
+  int64_t ts = duration_cast<microseconds>(time - traceOrigin).count();
+  const lock_guard<mutex> lock(mtx);
+  trace.push_back({sectionId, phase, ts});
+}
+
+void HelayersTimer::ThreadTree::mergeInto(int node, SectionInfo& target) const
+{
+  for (const auto& child : nodes[node].children) {
+    const ThreadNode& n = nodes[child.second];
+    SectionInfo& sub = target.getSubSection(getSectionName(child.first));
+
+    SectionInfo measured;
+    measured.count = n.count.load(memory_order_relaxed);
+    int64_t sampled = n.sampledCount.load(memory_order_relaxed);
+    if (sampled > 0) {
+      // Scale the sums of the timed visits to all visits.
+      double scale = (double)measured.count / sampled;
+      measured.sum = llround(n.sum.load(memory_order_relaxed) * scale);
+      measured.sumSquares =
+          llround(n.sumSquares.load(memory_order_relaxed) * scale);
+      measured.sumCPU = llround(n.sumCPU.load(memory_order_relaxed) * scale);
+    }
+    sub.add(measured);
+
+    mergeInto(child.second, sub);
   }
-  return subSections[title];
 }
 
-HelayersTimer::SectionInfo& HelayersTimer::SectionInfo::find(
+HelayersTimer::ThreadTreeHolder::ThreadTreeHolder()
+    : tree(make_shared<ThreadTree>())
+{
+  const lock_guard<mutex> lock(registryMtx);
+  tree->index = nextThreadIndex++;
+  threadTrees.push_back(tree);
+}
+
+HelayersTimer::ThreadTreeHolder::~ThreadTreeHolder()
+{
+  // Merge the measures of the exiting thread, so they still appear in
+  // summaries, and drop its tree. The tree is merged before taking the
+  // registry lock, since merging looks up section names.
+  SectionInfo measures("all");
+  vector<TraceEvent> trace;
+  {
+    const lock_guard<mutex> lock(tree->mtx);
+    tree->mergeInto(0, measures);
+    trace.swap(tree->trace);
+  }
+
+  const lock_guard<mutex> lock(registryMtx);
+  retired.merge(measures);
+  if (!trace.empty())
+    retiredTraces.push_back({tree->index, move(trace)});
+  threadTrees.erase(find(threadTrees.begin(), threadTrees.end(), tree));
+}
+
+HelayersTimer::ThreadTree& HelayersTimer::getThreadTree()
+{
+  thread_local ThreadTreeHolder holder;
+  return *holder.tree;
+}
+
+HelayersTimer::SectionInfo HelayersTimer::collect()
+{
+  vector<shared_ptr<ThreadTree>> trees;
+  SectionInfo res("all");
+  {
+    const lock_guard<mutex> lock(registryMtx);
+    trees = threadTrees;
+    res = retired;
+  }
+
+  for (const auto& tree : trees) {
+    const lock_guard<mutex> lock(tree->mtx);
+    tree->mergeInto(0, res);
+  }
+  return res;
+}
+
+HelayersTimer::SectionInfo& HelayersTimer::SectionInfo::getSubSection(
+    const std::string& title)
+{
+  SectionInfo& res = subSections[title];
+  res.name = title;
+  return res;
+}
+
+const HelayersTimer::SectionInfo& HelayersTimer::SectionInfo::find(
     const std::string& title,
-    const std::string& prefix)
+    const std::string& prefix) const
 {
   if (title.empty())
     return *this;
@@ -79,7 +218,7 @@ HelayersTimer::SectionInfo& HelayersTimer::SectionInfo::find(
     key = title.substr(0, p);
     cont = title.substr(p + 1);
   }
-  map<string, SectionInfo>::iterator n = subSections.find(key);
+  map<string, SectionInfo>::const_iterator n = subSections.find(key);
   if (n == subSections.end())
     throw invalid_argument("missing " + key + " in " + prefix);
   return n->second.find(cont, prefix + key + ".");
@@ -90,40 +229,131 @@ HelayersTimer::HelayersTimer(const string& title) : HelayersTimer()
   restart(title);
 }
 
+HelayersTimer::HelayersTimer(int sectionId) : HelayersTimer()
+{
+  restart(sectionId);
+}
+
 HelayersTimer::~HelayersTimer() { stop(); }
 
-void HelayersTimer::restart(const string& t)
+void HelayersTimer::restart(const string& title) { restart(intern(title)); }
+
+void HelayersTimer::restart(int id)
 {
   stop();
 
-  title = t;
   last = high_resolution_clock::now();
   cpu_last = getProcessCPUTime();
   lastSet = true;
-  info = &current->getSubSection(title);
+  sectionId = id;
+  ThreadTree& tree = getThreadTree();
+  info = &tree.nodes[tree.getChild(getBaseNode(tree), sectionId)];
+  traced = traceEnabled.load(memory_order_relaxed);
+  if (traced)
+    tree.addTraceEvent(sectionId, 'B', last);
 }
 
-void HelayersTimer::push(const std::string& section)
+void HelayersTimer::publishPosition(const ThreadTree& tree)
 {
-  if (omp_in_parallel())
+  if (omp_get_level() != 0)
     return;
-  current = &current->getSubSection(section);
-  current->start = high_resolution_clock::now();
-  current->cpu_start = getProcessCPUTime();
-  // if (section=="innerSum")
-  //    cout << "TIME innerSum START" << endl;
+  int64_t position = ((int64_t)tree.index << 32) | tree.current;
+  if (serialPosition.load(memory_order_relaxed) != position)
+    serialPosition.store(position, memory_order_relaxed);
 }
 
-void HelayersTimer::pop()
+vector<int> HelayersTimer::getSerialPath(int64_t position)
 {
-  if (omp_in_parallel())
-    return;
-  if (current->parent == NULL) {
-    throw runtime_error("already at top. current name=" + current->name);
+  vector<int> res;
+  if (position < 0)
+    return res;
+  int index = position >> 32;
+  int node = position & 0xffffffff;
+
+  shared_ptr<ThreadTree> owner;
+  {
+    const lock_guard<mutex> lock(registryMtx);
+    for (const auto& tree : threadTrees)
+      if (tree->index == index)
+        owner = tree;
   }
+  // The thread may have exited since.
+  if (!owner)
+    return res;
 
-  current->addMeasure(current->start, current->cpu_start);
-  current = current->parent;
+  const lock_guard<mutex> lock(owner->mtx);
+  if (node >= (int)owner->nodes.size())
+    return res;
+  for (; node > 0; node = owner->nodes[node].parent)
+    res.push_back(owner->nodes[node].sectionId);
+  reverse(res.begin(), res.end());
+  return res;
+}
+
+int HelayersTimer::getBaseNode(ThreadTree& tree)
+{
+  if (!tree.startPoints.empty())
+    return tree.current;
+  if (omp_get_level() == 0)
+    return 0;
+
+  // An OpenMP worker with no open section inherits the sections open when
+  // the parallel region started. The matching node is created in the
+  // worker's own tree once per region, without being measured.
+  int64_t position = serialPosition.load(memory_order_relaxed);
+  if (position != tree.inheritedPosition) {
+    int node = 0;
+    for (int sectionId : getSerialPath(position))
+      node = tree.getChild(node, sectionId);
+    tree.inheritedPosition = position;
+    tree.inheritedNode = node;
+  }
+  return tree.inheritedNode;
+}
+
+void HelayersTimer::push(const std::string& section) { push(intern(section)); }
+
+void HelayersTimer::push(int sectionId)
+{
+  ThreadTree& tree = getThreadTree();
+  tree.current = tree.getChild(getBaseNode(tree), sectionId);
+  publishPosition(tree);
+
+  int64_t visits = tree.nodes[tree.current].count.load(memory_order_relaxed);
+  bool sampled = visits % samplingRate.load(memory_order_relaxed) == 0;
+  bool tracing = traceEnabled.load(memory_order_relaxed);
+  high_resolution_clock::time_point now;
+  if (sampled || tracing)
+    now = high_resolution_clock::now();
+  if (tracing)
+    tree.addTraceEvent(sectionId, 'B', now);
+  tree.startPoints.push_back({now, sampled ? getProcessCPUTime() : 0, sampled});
+}
+
+void HelayersTimer::pop()
+{
+  ThreadTree& tree = getThreadTree();
+  if (tree.startPoints.empty())
+    throw runtime_error("already at top");
+  ThreadNode& node = tree.nodes[tree.current];
+
+  const StartPoint& sp = tree.startPoints.back();
+  bool tracing = traceEnabled.load(memory_order_relaxed);
+  high_resolution_clock::time_point now;
+  if (sp.sampled || tracing)
+    now = high_resolution_clock::now();
+  if (sp.sampled) {
+    int64_t microsecs = duration_cast<microseconds>(now - sp.wall).count();
+    int64_t cpuMicrosecs = (getProcessCPUTime() - sp.cpu) / 1000;
+    node.addMeasure(microsecs, cpuMicrosecs);
+  } else {
+    node.count.fetch_add(1, memory_order_relaxed);
+  }
+  if (tracing)
+    tree.addTraceEvent(node.sectionId, 'E', now);
+  tree.startPoints.pop_back();
+  tree.current = node.parent;
+  publishPosition(tree);
 }
 
 void HelayersTimer::pop(int count)
@@ -134,52 +364,176 @@ void HelayersTimer::pop(int count)
   }
 }
 
+void HelayersTimer::setSamplingRate(int rate)
+{
+  if (rate < 1)
+    throw invalid_argument("sampling rate must be positive, got " +
+                           to_string(rate));
+  samplingRate = rate;
+}
+
+void HelayersTimer::setTraceEnabled(bool enabled) { traceEnabled = enabled; }
+
+void HelayersTimer::clearTrace()
+{
+  vector<shared_ptr<ThreadTree>> trees;
+  {
+    const lock_guard<mutex> lock(registryMtx);
+    trees = threadTrees;
+    retiredTraces.clear();
+  }
+  for (const auto& tree : trees) {
+    const lock_guard<mutex> lock(tree->mtx);
+    tree->trace.clear();
+  }
+}
+
+void HelayersTimer::reset()
+{
+  vector<shared_ptr<ThreadTree>> trees;
+  {
+    const lock_guard<mutex> lock(registryMtx);
+    trees = threadTrees;
+    retired = SectionInfo("all");
+    retiredTraces.clear();
+    serialPosition = -1;
+  }
+  for (const auto& tree : trees)
+    tree->clear();
+}
+
+void HelayersTimer::SectionInfo::exportJson(JsonWrapper& jw,
+                                            vector<string>& path) const
+{
+  // Names are added as separate keys of the path, since they may contain
+  // dots.
+  path.push_back("count");
+  jw.setInt64ByPath(path, count);
+  path.back() = "sum";
+  jw.setInt64ByPath(path, sum);
+  path.back() = "sumSquares";
+  jw.setInt64ByPath(path, sumSquares);
+  path.back() = "sumCPU";
+  jw.setInt64ByPath(path, sumCPU);
+
+  path.back() = "subSections";
+  for (const auto& sub : subSections) {
+    path.push_back(sub.first);
+    sub.second.exportJson(jw, path);
+    path.pop_back();
+  }
+  path.pop_back();
+}
+
+void HelayersTimer::exportJson(JsonWrapper& jw)
+{
+  jw.init();
+  jw.setInt("samplingRate", getSamplingRate());
+  vector<string> path{"sections"};
+  collect().exportJson(jw, path);
+}
+
+// Returns the given string as a quoted JSON string.
+static string jsonQuote(const string& str)
+{
+  ostringstream res;
+  res << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      res << '\\' << c;
+    else if ((unsigned char)c < 0x20)
+      res << "\\u" << hex << setw(4) << setfill('0') << (int)c << dec;
+    else
+      res << c;
+  }
+  res << '"';
+  return res.str();
+}
+
+void HelayersTimer::exportChromeTrace(ostream& out)
+{
+  vector<shared_ptr<ThreadTree>> trees;
+  vector<pair<int, vector<TraceEvent>>> traces;
+  {
+    const lock_guard<mutex> lock(registryMtx);
+    trees = threadTrees;
+    traces = retiredTraces;
+  }
+  for (const auto& tree : trees) {
+    const lock_guard<mutex> lock(tree->mtx);
+    traces.push_back({tree->index, tree->trace});
+  }
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& trace : traces) {
+    for (const TraceEvent& e : trace.second) {
+      out << (first ? "\n" : ",\n");
+      first = false;
+      out << "{\"name\":" << jsonQuote(getSectionName(e.sectionId))
+          << ",\"ph\":\"" << e.phase << "\",\"ts\":" << e.ts
+          << ",\"pid\":0,\"tid\":" << trace.first << "}";
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+}
+
 void HelayersTimer::stop()
 {
-  if (lastSet)
-    info->addMeasure(last, cpu_last);
+  if (lastSet) {
+    high_resolution_clock::time_point now = high_resolution_clock::now();
+    int64_t microsecs = duration_cast<microseconds>(now - last).count();
+    info->addMeasure(microsecs, (getProcessCPUTime() - cpu_last) / 1000);
+    if (traced)
+      getThreadTree().addTraceEvent(sectionId, 'E', now);
+  }
   lastSet = false;
+  traced = false;
   info = NULL;
 }
 
-void HelayersTimer::SectionInfo::addMeasure(
-    std::chrono::high_resolution_clock::time_point s,
-    int64_t cpu_s)
+void HelayersTimer::ThreadNode::addMeasure(int64_t microsecs,
+                                           int64_t cpu_microsecs)
 {
-  auto end_time = high_resolution_clock::now();
-  int64_t microsecs = duration_cast<microseconds>(end_time - s).count();
+  sum.fetch_add(microsecs, memory_order_relaxed);
+  sumSquares.fetch_add(microsecs * microsecs, memory_order_relaxed);
+  count.fetch_add(1, memory_order_relaxed);
+  sampledCount.fetch_add(1, memory_order_relaxed);
+  sumCPU.fetch_add(cpu_microsecs, memory_order_relaxed);
+}
 
-  auto end_cpu = getProcessCPUTime();
-  int64_t cpu_microsecs = (end_cpu - cpu_s) / 1000;
+int HelayersTimer::getSum(const std::string& title)
+{
+  return collect().find(title, "").sum;
+}
 
-  const lock_guard<mutex> lock(mtx);
-  sum += microsecs;
-  sumSquares += microsecs * microsecs;
-  count += 1;
-  sumCPU += cpu_microsecs;
+int64_t HelayersTimer::getCount(const std::string& title)
+{
+  return collect().find(title, "").count;
 }
 
-int HelayersTimer::getSum(const std::string& title)
+void HelayersTimer::addMeasure(const std::string& section, int64_t microsecs)
 {
-  return top.find(title, "").sum;
+  ThreadTree& tree = getThreadTree();
+  tree.nodes[tree.getChild(0, intern(section))].addMeasure(microsecs, 0);
 }
 
 void HelayersTimer::printMeasureSummary(const string& sectionName,
                                         std::ostream& out)
 {
-  top.printMeasureSummary(sectionName, out);
+  collect().printMeasureSummary(sectionName, out);
 }
 
 void HelayersTimer::printMeasuresSummary(std::ostream& out)
 {
-  top.printMeasuresSummary(-1, out);
+  collect().printMeasuresSummary(-1, out);
 }
 
 void HelayersTimer::printMeasuresSummaryFlat(std::ostream& out)
 {
   cout << "Flat summary:" << endl;
   std::map<std::string, SectionInfo> flat;
-  top.addToFlat(flat);
+  collect().addToFlat(flat);
   for (std::map<string, SectionInfo>::iterator iter = flat.begin();
        iter != flat.end();
        ++iter)
@@ -224,17 +578,26 @@ int64_t HelayersTimer::getProcessCPUTime()
 
 void HelayersTimer::SectionInfo::add(const SectionInfo& other)
 {
-  const lock_guard<mutex> lock(mtx);
   count += other.count;
   sum += other.sum;
   sumSquares += other.sumSquares;
+  sumCPU += other.sumCPU;
 }
 
-void HelayersTimer::SectionInfo::addToFlat(map<string, SectionInfo>& flat)
+void HelayersTimer::SectionInfo::merge(const SectionInfo& other)
+{
+  add(other);
+  for (const auto& sub : other.subSections)
+    getSubSection(sub.first).merge(sub.second);
+}
+
+void HelayersTimer::SectionInfo::addToFlat(
+    map<string, SectionInfo>& flat) const
 {
 
   if (subSections.size() > 0) {
-    for (std::map<string, SectionInfo>::iterator iter = subSections.begin();
+    for (std::map<string, SectionInfo>::const_iterator iter =
+             subSections.begin();
          iter != subSections.end();
          ++iter)
       iter->second.addToFlat(flat);
@@ -290,14 +653,14 @@ void HelayersTimer::SectionInfo::printMeasureSummary(const string& sectionName,
 }
 
 void HelayersTimer::SectionInfo::printMeasuresSummary(int depth,
-                                                      std::ostream& out)
+                                                      std::ostream& out) const
 {
 
   if (depth >= 0) {
     printTopMeasureSummary(depth, out);
   }
 
-  for (std::map<string, SectionInfo>::iterator iter = subSections.begin();
+  for (std::map<string, SectionInfo>::const_iterator iter = subSections.begin();
        iter != subSections.end();
        ++iter)
     iter->second.printMeasuresSummary(depth + 1, out);
@@ -325,11 +688,10 @@ void HelayersTimer::printState(const std::string& title)
   cout << "HelayersTimer state: " << title << endl;
   if (multiThreadMode)
     cout << "**MULTITHREADMODE**" << endl;
-  SectionInfo* si = current;
-  while (si != NULL) {
-    cout << si->name << endl;
-    si = si->parent;
-  }
+  const ThreadTree& tree = getThreadTree();
+  for (int node = tree.current; node > 0; node = tree.nodes[node].parent)
+    cout << getSectionName(tree.nodes[node].sectionId) << endl;
+  cout << "all" << endl;
 }
 
 void HelayersTimer::printOverview(std::ostream& out)
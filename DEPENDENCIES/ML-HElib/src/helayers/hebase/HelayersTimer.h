@@ -25,26 +25,50 @@
 #ifndef SRC_HELAYERS_SIMPLETIMER_H
 #define SRC_HELAYERS_SIMPLETIMER_H
 
+#include <atomic>
 #include <cstdint>
 #include <chrono>
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
 
 #ifndef NO_INTERNAL_HELAYERS_PROFILING
 
-#define HELAYERS_TIMER(title) helayers::HelayersTimer _helayers_timer(title)
+// The TIMER, SECTION, PUSH and RESTART macros intern their title once per
+// call site, so their title must be the same on every call. Use the _ID
+// variants with an id returned by HelayersTimer::intern() for titles computed
+// at run time.
+#define HELAYERS_TIMER(title)                                                  \
+  static const int _helayers_timer_id =                                        \
+      helayers::HelayersTimer::intern(title);                                  \
+  helayers::HelayersTimer _helayers_timer(_helayers_timer_id)
 #define HELAYERS_TIMER_SECTION(title)                                          \
-  helayers::HelayersTimer::Guard guard(title)
-#define HELAYERS_TIMER_PUSH(title) helayers::HelayersTimer::push(title)
+  static const int _helayers_timer_section_id =                                \
+      helayers::HelayersTimer::intern(title);                                  \
+  helayers::HelayersTimer::Guard guard(_helayers_timer_section_id)
+#define HELAYERS_TIMER_SECTION_ID(id) helayers::HelayersTimer::Guard guard(id)
+#define HELAYERS_TIMER_PUSH(title)                                             \
+  helayers::HelayersTimer::push([]() {                                         \
+    static const int id = helayers::HelayersTimer::intern(title);              \
+    return id;                                                                 \
+  }())
+#define HELAYERS_TIMER_PUSH_ID(id) helayers::HelayersTimer::push(id)
 #define HELAYERS_TIMER_POP() helayers::HelayersTimer::pop()
 #define HELAYERS_TIMER_POP_COUNT(count) helayers::HelayersTimer::pop(count)
 
 #define HELAYERS_TIMER_PRINT_STATE(title)                                      \
   helayers::HelayersTimer::printState(title)
-#define HELAYERS_TIMER_RESTART(title) _helayers_timer.restart(title)
+#define HELAYERS_TIMER_RESTART(title)                                          \
+  _helayers_timer.restart([]() {                                               \
+    static const int id = helayers::HelayersTimer::intern(title);              \
+    return id;                                                                 \
+  }())
 #define HELAYERS_TIMER_STOP() _helayers_timer.stop()
 
 #define HELAYERS_TIMER_PRINT_MEASURE_SUMMARY(sectionName)                      \
@@ -60,7 +84,9 @@
 
 #define HELAYERS_TIMER(title)
 #define HELAYERS_TIMER_SECTION(title)
+#define HELAYERS_TIMER_SECTION_ID(id)
 #define HELAYERS_TIMER_PUSH(title)
+#define HELAYERS_TIMER_PUSH_ID(id)
 #define HELAYERS_TIMER_POP()
 #define HELAYERS_TIMER_POP_COUNT(count)
 #define HELAYERS_TIMER_SECTION_THREAD_MODE(section)
@@ -68,74 +94,160 @@
 #define HELAYERS_TIMER_RESTART(st, title)
 #define HELAYERS_TIMER_STOP(st)
 #define HELAYERS_TIMER_PRINT_MEASURE_SUMMARY(sectionName)
-#define HELAYERS_TIMER_PRINT_MEASURES_SUMMARY
-#define HELAYERS_TIMER_PRINT_MEASURES_SUMMARY_FLAT
+#define HELAYERS_TIMER_PRINT_MEASURES_SUMMARY()
+#define HELAYERS_TIMER_PRINT_MEASURES_SUMMARY_FLAT()
 
 #endif
 
 namespace helayers {
 
+class JsonWrapper;
+
 /// A class currently for internal use only.
 /// Used for performing internal profiling research.
+///
+/// Every thread records into its own sections tree, so pushing and popping
+/// sections takes no locks and is safe inside OpenMP workers. The trees of
+/// all threads are merged by section name when a summary is requested.
+///
+/// Sections pushed by an OpenMP worker that has no open section are nested
+/// under the sections that were open when the parallel region started, i.e.,
+/// those open on the thread that most recently pushed or popped a section
+/// outside of any parallel region. Sections pushed by other threads with no
+/// open section are merged under the top level section.
+///
+/// The tree of a thread is merged into a shared tree when the thread exits,
+/// so the number of trees is bounded by the number of live threads.
 class HelayersTimer
 {
+  // A node of a merged sections tree, used for reporting.
   struct SectionInfo
   {
-    std::mutex mtx;
     std::int64_t sum = 0;
     std::int64_t sumSquares = 0;
     std::int64_t count = 0;
     std::int64_t sumCPU = 0;
 
-    std::chrono::high_resolution_clock::time_point start;
-    int64_t cpu_start;
-
     std::map<std::string, SectionInfo> subSections;
-    SectionInfo* parent = NULL;
     std::string name;
 
     SectionInfo() {}
     SectionInfo(const std::string& n) : name(n) {}
-    SectionInfo(const SectionInfo& other)
-        : name(other.name),
-          sum(other.sum),
-          sumSquares(other.sumSquares),
-          count(other.count),
-          sumCPU(other.sumCPU),
-          subSections(other.subSections)
-    {}
-
-    SectionInfo& operator=(const SectionInfo& other)
-    {
-      if (&other != this) {
-        sum = other.sum;
-        sumSquares = other.sumSquares;
-        count = other.count;
-        sumCPU = other.sumCPU;
-        subSections = other.subSections;
-        parent = other.parent;
-        name = other.name;
-      }
-      return *this;
-    }
 
     void printTopMeasureSummary(int depth, std::ostream& out) const;
     void printMeasureSummary(const std::string& sectionName,
                              std::ostream& out) const;
-    void printMeasuresSummary(int depth, std::ostream& out);
-    void addToFlat(std::map<std::string, SectionInfo>& flat);
+    void printMeasuresSummary(int depth, std::ostream& out) const;
+    void addToFlat(std::map<std::string, SectionInfo>& flat) const;
 
-    SectionInfo& find(const std::string& title, const std::string& prefix);
+    const SectionInfo& find(const std::string& title,
+                            const std::string& prefix) const;
+    void exportJson(JsonWrapper& jw, std::vector<std::string>& path) const;
 
-    void addMeasure(std::chrono::high_resolution_clock::time_point s,
-                    int64_t cpu_s);
     SectionInfo& getSubSection(const std::string& title);
     void add(const SectionInfo& other);
+    void merge(const SectionInfo& other);
+  };
+
+  // A node of a per-thread sections tree. Its counters are only updated by
+  // the owning thread, and are atomic so they can be merged concurrently.
+  struct ThreadNode
+  {
+    int sectionId;
+    int parent;
+    // Pairs of (section id, node index), in order of creation.
+    std::vector<std::pair<int, int>> children;
+
+    std::atomic<std::int64_t> sum{0};
+    std::atomic<std::int64_t> sumSquares{0};
+    std::atomic<std::int64_t> count{0};
+    std::atomic<std::int64_t> sampledCount{0};
+    std::atomic<std::int64_t> sumCPU{0};
+
+    ThreadNode(int sectionId, int parent)
+        : sectionId(sectionId), parent(parent)
+    {}
+
+    void addMeasure(std::int64_t microsecs, std::int64_t cpuMicrosecs);
+  };
+
+  struct StartPoint
+  {
+    std::chrono::high_resolution_clock::time_point wall;
+    int64_t cpu;
+    bool sampled;
+  };
+
+  struct TraceEvent
+  {
+    int sectionId;
+    // 'B' for push and 'E' for pop, as in the Chrome trace event format.
+    char phase;
+    std::int64_t ts;
+  };
+
+  struct ThreadTree
+  {
+    // Guards changes to the tree structure and to the trace against
+    // concurrent merges and exports.
+    std::mutex mtx;
+    // A deque, so that nodes are never moved once created.
+    std::deque<ThreadNode> nodes;
+    int current = 0;
+    std::vector<StartPoint> startPoints;
+    // Unique index of the owning thread, in order of first use of the timer.
+    int index = 0;
+    std::vector<TraceEvent> trace;
+    // The last serialPosition inherited by this OpenMP worker, and the node
+    // of this tree matching it.
+    std::int64_t inheritedPosition = -1;
+    int inheritedNode = 0;
+
+    ThreadTree();
+
+    void clear();
+
+    void addTraceEvent(
+        int sectionId,
+        char phase,
+        std::chrono::high_resolution_clock::time_point time);
+
+    int getChild(int node, int sectionId);
+    void mergeInto(int node, SectionInfo& target) const;
   };
-  static SectionInfo top;
-  static SectionInfo* current;
+
+  // Registers the tree of a thread on first use, and retires it when the
+  // thread exits.
+  struct ThreadTreeHolder
+  {
+    std::shared_ptr<ThreadTree> tree;
+
+    ThreadTreeHolder();
+    ~ThreadTreeHolder();
+  };
+
+  static std::mutex registryMtx;
+  static std::unordered_map<std::string, int> sectionIds;
+  static std::deque<std::string> sectionNames;
+  static std::vector<std::shared_ptr<ThreadTree>> threadTrees;
+  static int nextThreadIndex;
+  // Measures and trace events of exited threads.
+  static SectionInfo retired;
+  static std::vector<std::pair<int, std::vector<TraceEvent>>> retiredTraces;
+  // The index of the thread that most recently pushed or popped a section
+  // outside of a parallel region, in the high 32 bits, and its current node.
+  static std::atomic<std::int64_t> serialPosition;
+  static std::atomic<int> samplingRate;
+  static std::atomic<bool> traceEnabled;
+  static const std::chrono::high_resolution_clock::time_point traceOrigin;
   static bool multiThreadMode;
 
+  static ThreadTree& getThreadTree();
+  static SectionInfo collect();
+  static void publishPosition(const ThreadTree& tree);
+  static int getBaseNode(ThreadTree& tree);
+  static std::vector<int> getSerialPath(std::int64_t position);
+
 public:
   /// @brief Defines a HelayersTimer::Guard local variable to automatically push
   /// a timer section and pop it when the scope ends.
@@ -143,23 +255,103 @@ public:
   {
   public:
     Guard(const std::string& title) { HelayersTimer::push(title); }
+    Guard(int sectionId) { HelayersTimer::push(sectionId); }
     ~Guard() { HelayersTimer::pop(); }
   };
 
   HelayersTimer();
   HelayersTimer(const std::string& title);
+
+  /// Starts measuring a section given by an id returned by intern().
+  /// @param[in] sectionId id returned by intern()
+  HelayersTimer(int sectionId);
   ~HelayersTimer();
 
+  /// Returns a unique id for the given section name, to be used with the
+  /// id overloads of push(). Takes a lock, so call sites that are executed
+  /// often should intern their section names once and keep the id.
+  /// Thread safe.
+  /// @param[in] section name of the section
+  static int intern(const std::string& section);
+
+  /// Returns the name of a section interned by intern().
+  /// @param[in] sectionId id returned by intern()
+  static const std::string& getSectionName(int sectionId);
+
   static void push(const std::string& section);
+
+  /// Pushes a section given by an id returned by intern(). Does not lock
+  /// or allocate once the section was visited from the current position.
+  /// @param[in] sectionId id returned by intern()
+  static void push(int sectionId);
   static void pop();
   static void pop(int count);
 
+  /// Sets the sampling rate. With a rate of n, only every n-th visit of
+  /// each section is timed, and the sums of the other visits are estimated
+  /// from the timed ones. Visit counts are always exact.
+  /// @param[in] rate positive sampling rate (1 times every visit)
+  /// @throw invalid_argument if rate is not positive
+  static void setSamplingRate(int rate);
+
+  /// Returns the sampling rate. See setSamplingRate().
+  static int getSamplingRate() { return samplingRate.load(); }
+
+  /// Enables or disables recording a timeline of push and pop events,
+  /// for exportChromeTrace(). Recording takes an uncontended lock per event
+  /// and keeps all events in memory until clearTrace() is called.
+  /// @param[in] enabled whether to record events
+  static void setTraceEnabled(bool enabled);
+
+  /// Returns whether a timeline of events is being recorded.
+  static bool isTraceEnabled() { return traceEnabled.load(); }
+
+  /// Discards all recorded timeline events.
+  static void clearTrace();
+
+  /// Discards all measures and recorded timeline events, including those of
+  /// exited threads. Section ids returned by intern() remain valid.
+  /// Must not be called while any thread has an open section or a running
+  /// HelayersTimer object.
+  static void reset();
+
+  /// Exports the merged measures of all sections into a JSON object.
+  /// The object holds the sampling rate, and under "sections" the top level
+  /// section. Each section has the keys "count", "sum", "sumSquares" and
+  /// "sumCPU", with times in microseconds, and its nested sections under
+  /// "subSections", keyed by name. Since section names may contain dots,
+  /// use JsonWrapper::getInt64ByPath() to read the measures.
+  /// @param[out] jw JSON object to initialize and fill
+  static void exportJson(JsonWrapper& jw);
+
+  /// Writes the recorded timeline of events in the Chrome trace event
+  /// format, to be viewed in chrome://tracing or Perfetto. Each thread that
+  /// used the timer appears as a separate thread id.
+  /// @param[in] out stream to write to
+  static void exportChromeTrace(std::ostream& out);
+
   static void printState(const std::string& title = "");
 
   static int getSum(const std::string& title);
 
+  /// Returns the number of visits of a section, summed over all threads.
+  /// @param[in] title full section name, with nested sections separated by
+  ///                  dots
+  static std::int64_t getCount(const std::string& title);
+
+  /// Adds an externally measured duration to a top level section.
+  /// Useful for measuring spans that start and end on different threads.
+  /// Thread safe.
+  /// @param[in] section name of the top level section
+  /// @param[in] microsecs measured duration in microseconds
+  static void addMeasure(const std::string& section, std::int64_t microsecs);
+
   void restart(const std::string& title);
 
+  /// Like restart(const std::string&), with an id returned by intern().
+  /// @param[in] sectionId id returned by intern()
+  void restart(int sectionId);
+
   void stop();
 
   /// Prints an overview of run time.
@@ -190,8 +382,10 @@ private:
   std::chrono::high_resolution_clock::time_point last;
   int64_t cpu_start;
   int64_t cpu_last;
-  std::string title;
-  SectionInfo* info = NULL;
+  ThreadNode* info = NULL;
+  int sectionId = -1;
+  // Whether a begin event was recorded for the current measure.
+  bool traced = false;
 
   bool lastSet;
 };
@@ -36,7 +36,7 @@ NativeFunctionEvaluator::~NativeFunctionEvaluator() {}
 
 void NativeFunctionEvaluator::powerInPlace(CTile& c, int p) const
 {
-  impl->powerInPlace(*c.impl, p);
+  impl->powerInPlace(c.modified(), p);
 }
 
 void NativeFunctionEvaluator::totalProduct(
@@ -46,9 +46,9 @@ void NativeFunctionEvaluator::totalProduct(
   int size = multiplicands.size();
   std::vector<shared_ptr<helayers::AbstractCiphertext>> absMultiplicands(size);
   for (int i = 0; i < size; i++) {
-    absMultiplicands[i] = (multiplicands[i]).impl;
+    absMultiplicands[i] = (multiplicands[i]).maintained();
   }
-  impl->totalProduct(*result.impl, absMultiplicands);
+  impl->totalProduct(result.overwritten(), absMultiplicands);
 }
 
 } // namespace helayers
\ No newline at end of file
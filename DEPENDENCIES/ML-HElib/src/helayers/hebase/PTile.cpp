@@ -33,6 +33,8 @@ PTile::PTile(HeContext& he) : impl(he.createAbstractPlain()) {}
 
 PTile::PTile(const PTile& src) : impl(src.impl->clone()) {}
 
+PTile::PTile(PTile&& src) noexcept : impl(move(src.impl)) {}
+
 PTile::~PTile() {}
 
 PTile& PTile::operator=(const PTile& src)
@@ -42,6 +44,12 @@ PTile& PTile::operator=(const PTile& src)
   return *this;
 }
 
+PTile& PTile::operator=(PTile&& src) noexcept
+{
+  impl = move(src.impl);
+  return *this;
+}
+
 streamoff PTile::save(ostream& stream) const { return impl->save(stream); }
 
 streamoff PTile::load(istream& stream) { return impl->load(stream); }
@@ -59,6 +67,8 @@ int PTile::getChainIndex() const { return impl->getChainIndex(); }
 
 int PTile::slotCount() const { return impl->slotCount(); }
 
+bool PTile::isPrepared() const { return impl->isPrepared(); }
+
 void PTile::debugPrint(const string& title,
                        int maxElements,
                        int verbose,
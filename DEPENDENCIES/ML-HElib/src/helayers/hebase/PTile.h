@@ -53,12 +53,22 @@ public:
   /// @param[in] src Object to copy.
   PTile(const PTile& src);
 
+  /// Move constructor. "src" is left without a plaintext and may only be
+  /// assigned to or destroyed.
+  /// @param[in] src Object to move from.
+  PTile(PTile&& src) noexcept;
+
   ~PTile();
 
   /// Copy from another object.
   /// @param[in] src Object to copy.
   PTile& operator=(const PTile& src);
 
+  /// Move from another object. "src" is left without a plaintext and may
+  /// only be assigned to or destroyed.
+  /// @param[in] src Object to move from.
+  PTile& operator=(PTile&& src) noexcept;
+
   /// Reduces the chain-index property of this object by 1.
   /// Ignored if not supported.
   /// @throw runtime_error If chain index is already at lowest value
@@ -89,6 +99,10 @@ public:
   /// This method returns the number of slots in this object.
   int slotCount() const;
 
+  /// Returns whether this PTile holds the form ciphertext operations use. See
+  /// Encoder::prepare().
+  bool isPrepared() const;
+
   ///  Saves this PTile to a stream in binary form.
   ///
   ///  @param[in] stream output stream to write to
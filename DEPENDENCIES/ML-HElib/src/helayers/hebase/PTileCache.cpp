@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "PTileCache.h"
+#include "HeContext.h"
+#include "impl/AbstractEncoder.h"
+
+using namespace std;
+
+namespace helayers {
+
+static void hashCombine(size_t& seed, size_t h)
+{
+  seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+bool PTileCache::Key::operator==(const Key& other) const
+{
+  return hash == other.hash && fill == other.fill &&
+         chainIndex == other.chainIndex && scale == other.scale &&
+         vals == other.vals;
+}
+
+PTileCache::PTileCache(HeContext& he, size_t capacity)
+    : he(he), capacity(capacity)
+{}
+
+PTileCache::~PTileCache() {}
+
+PTileCache::Key PTileCache::makeKey(const vector<double>& vals,
+                                    bool fill,
+                                    int chainIndex) const
+{
+  Key key{vals, fill, chainIndex, he.getDefaultScale(), 0};
+  hash<double> hasher;
+  for (double v : vals)
+    hashCombine(key.hash, hasher(v));
+  hashCombine(key.hash, fill);
+  hashCombine(key.hash, chainIndex);
+  hashCombine(key.hash, hasher(key.scale));
+  return key;
+}
+
+shared_ptr<const AbstractPlaintext> PTileCache::getScalar(double val,
+                                                          int chainIndex)
+{
+  return get(makeKey(vector<double>{val}, true, chainIndex));
+}
+
+shared_ptr<const AbstractPlaintext> PTileCache::get(const vector<double>& vals,
+                                                    int chainIndex)
+{
+  return get(makeKey(vals, false, chainIndex));
+}
+
+shared_ptr<const AbstractPlaintext> PTileCache::get(Key&& key)
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    auto it = index.find(key);
+    if (it != index.end()) {
+      ++hits;
+      lru.splice(lru.begin(), lru, it->second);
+      return it->second->second;
+    }
+  }
+  ++misses;
+
+  // Encode without holding the lock, so that concurrent lookups of other
+  // entries are not blocked.
+  shared_ptr<AbstractPlaintext> pt = he.createAbstractPlain();
+  shared_ptr<AbstractEncoder> encoder = he.getEncoder();
+  if (key.fill)
+    encoder->encode(*pt, key.vals[0], key.chainIndex);
+  else
+    encoder->encode(*pt, key.vals, key.chainIndex);
+
+  lock_guard<mutex> lock(mtx);
+  if (capacity == 0)
+    return pt;
+  auto it = index.find(key);
+  if (it != index.end())
+    return it->second->second; // encoded concurrently by another thread
+  lru.emplace_front(move(key), pt);
+  index.emplace(lru.front().first, lru.begin());
+  evict();
+  return pt;
+}
+
+void PTileCache::evict()
+{
+  while (lru.size() > capacity) {
+    index.erase(lru.back().first);
+    lru.pop_back();
+  }
+}
+
+void PTileCache::setCapacity(size_t capacity)
+{
+  lock_guard<mutex> lock(mtx);
+  this->capacity = capacity;
+  evict();
+}
+
+size_t PTileCache::getCapacity() const
+{
+  lock_guard<mutex> lock(mtx);
+  return capacity;
+}
+
+size_t PTileCache::size() const
+{
+  lock_guard<mutex> lock(mtx);
+  return lru.size();
+}
+
+void PTileCache::clear()
+{
+  lock_guard<mutex> lock(mtx);
+  index.clear();
+  lru.clear();
+}
+
+void PTileCache::resetCounters()
+{
+  hits = 0;
+  misses = 0;
+}
+} // namespace helayers
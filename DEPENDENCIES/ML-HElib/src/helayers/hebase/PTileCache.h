@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_PTILECACHE_H
+#define SRC_HELAYERS_PTILECACHE_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace helayers {
+
+class HeContext;
+class AbstractPlaintext;
+
+/// A size bounded, least recently used cache of encoded plaintexts.
+/// Entries are keyed by their content, chain index and the context's default
+/// scale, so that masks and constants used repeatedly are encoded only once.
+/// Each HeContext owns one such cache, used by the scalar operations of
+/// ciphertexts and available to applications via HeContext::getPTileCache()
+/// and Encoder::encodeCached().
+/// This class is thread safe.
+class PTileCache
+{
+  struct Key
+  {
+    std::vector<double> vals;
+    // whether the single value in vals fills all slots
+    bool fill;
+    int chainIndex;
+    double scale;
+    size_t hash;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  typedef std::pair<Key, std::shared_ptr<const AbstractPlaintext>> Entry;
+
+  HeContext& he;
+
+  size_t capacity;
+
+  mutable std::mutex mtx;
+
+  // most recently used entries first
+  std::list<Entry> lru;
+
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+  std::atomic<long> hits{0};
+
+  std::atomic<long> misses{0};
+
+  Key makeKey(const std::vector<double>& vals, bool fill, int chainIndex) const;
+
+  std::shared_ptr<const AbstractPlaintext> get(Key&& key);
+
+  void evict();
+
+public:
+  /// Constructs an empty cache.
+  /// @param[in] he       The context to encode plaintexts with.
+  /// @param[in] capacity Maximal number of plaintexts to keep.
+  PTileCache(HeContext& he, size_t capacity = 64);
+
+  ~PTileCache();
+
+  PTileCache(const PTileCache& src) = delete;
+
+  PTileCache& operator=(const PTileCache& src) = delete;
+
+  /// Returns a plaintext with "val" in all slots at the given chain index,
+  /// encoding it only if it is not already cached.
+  /// @param[in] val        The value to encode.
+  /// @param[in] chainIndex The chain index of the plaintext.
+  std::shared_ptr<const AbstractPlaintext> getScalar(double val,
+                                                     int chainIndex);
+
+  /// Returns a plaintext encoding "vals" at the given chain index, encoding
+  /// it only if it is not already cached.
+  /// @param[in] vals       The values to encode.
+  /// @param[in] chainIndex The chain index of the plaintext.
+  std::shared_ptr<const AbstractPlaintext> get(const std::vector<double>& vals,
+                                               int chainIndex);
+
+  /// Sets the maximal number of cached plaintexts, evicting the least
+  /// recently used ones if needed. A capacity of 0 disables caching.
+  /// @param[in] capacity The new capacity.
+  void setCapacity(size_t capacity);
+
+  /// Returns the maximal number of cached plaintexts.
+  size_t getCapacity() const;
+
+  /// Returns the number of currently cached plaintexts.
+  size_t size() const;
+
+  /// Removes all cached plaintexts. Hit and miss counters are kept.
+  void clear();
+
+  /// Returns the number of lookups served from the cache.
+  long getHits() const { return hits; }
+
+  /// Returns the number of lookups that required encoding.
+  long getMisses() const { return misses; }
+
+  /// Resets the hit and miss counters.
+  void resetCounters();
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_PTILECACHE_H */
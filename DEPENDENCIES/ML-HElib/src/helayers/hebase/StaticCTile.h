@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_STATICCTILE_H
+#define SRC_HELAYERS_STATICCTILE_H
+
+#include <memory>
+#include <stdexcept>
+#include "CTile.h"
+#include "PTile.h"
+
+namespace helayers {
+
+/// A ciphertext of a backend known at compile time, for hot loops of cheap
+/// operations where CTile's virtual calls and the backend's casts of its
+/// operands are noticeable.
+///
+/// Cipher and Plain are the backend's concrete AbstractCiphertext and
+/// AbstractPlaintext classes. Operations are dispatched statically when
+/// Cipher is final, and take their operands as Cipher and Plain objects, so
+/// a backend that overloads its operations for these types skips the casts.
+/// The HElib backend does, see HelibCkksCTile and HelibBgvCTile.
+///
+/// Convert CTiles and PTiles once, outside the loop: the constructor and
+/// plainOf() check the backend, and toCTile() converts back. Operations are
+/// performed eagerly, without CTile's lazy maintenance or copy-on-write.
+template <class Cipher, class Plain>
+class StaticCTile
+{
+  std::shared_ptr<Cipher> impl;
+
+public:
+  /// Constructs from a CTile, taking over its ciphertext if src is an
+  /// rvalue. Pending maintenance of src is performed.
+  /// @param[in] src The CTile to convert.
+  /// @throw invalid_argument if src is not a Cipher.
+  explicit StaticCTile(CTile src)
+  {
+    src.modified();
+    impl = std::dynamic_pointer_cast<Cipher>(std::move(src.impl));
+    if (!impl)
+      throw std::invalid_argument("CTile is of a different backend");
+  }
+
+  /// Copy constructor. The ciphertext is always copied.
+  /// @param[in] src Object to copy.
+  StaticCTile(const StaticCTile& src)
+      : impl(std::static_pointer_cast<Cipher>(src.impl->clone()))
+  {}
+
+  StaticCTile(StaticCTile&& src) noexcept = default;
+
+  /// Copy from another object. The ciphertext is always copied.
+  /// @param[in] src Object to copy.
+  StaticCTile& operator=(const StaticCTile& src)
+  {
+    if (this != &src)
+      impl = std::static_pointer_cast<Cipher>(src.impl->clone());
+    return *this;
+  }
+
+  StaticCTile& operator=(StaticCTile&& src) noexcept = default;
+
+  /// Returns the implementation of plain, for the plaintext operations.
+  /// @param[in] plain The PTile.
+  /// @throw bad_cast if plain is not a Plain.
+  static const Plain& plainOf(const PTile& plain)
+  {
+    return dynamic_cast<const Plain&>(plain.getImpl());
+  }
+
+  /// Returns a copy of this ciphertext as a CTile.
+  CTile toCTile() const& { return CTile(impl->clone()); }
+
+  /// Moves this ciphertext into a CTile. This object may only be destroyed
+  /// or assigned to afterwards.
+  CTile toCTile() &&
+  {
+    return CTile(std::shared_ptr<AbstractCiphertext>(std::move(impl)));
+  }
+
+  /// Returns the backend implementation of this ciphertext.
+  const Cipher& getImpl() const { return *impl; }
+
+  void add(const StaticCTile& other) { impl->add(*other.impl); }
+
+  void addRaw(const StaticCTile& other) { impl->addRaw(*other.impl); }
+
+  void sub(const StaticCTile& other) { impl->sub(*other.impl); }
+
+  void subRaw(const StaticCTile& other) { impl->subRaw(*other.impl); }
+
+  void multiply(const StaticCTile& other) { impl->multiply(*other.impl); }
+
+  void multiplyRaw(const StaticCTile& other)
+  {
+    impl->multiplyRaw(*other.impl);
+  }
+
+  void addPlain(const Plain& plain) { impl->addPlain(plain); }
+
+  void addPlainRaw(const Plain& plain) { impl->addPlainRaw(plain); }
+
+  void subPlain(const Plain& plain) { impl->subPlain(plain); }
+
+  void subPlainRaw(const Plain& plain) { impl->subPlainRaw(plain); }
+
+  void multiplyPlain(const Plain& plain) { impl->multiplyPlain(plain); }
+
+  void multiplyPlainRaw(const Plain& plain) { impl->multiplyPlainRaw(plain); }
+
+  void addScalar(int scalar) { impl->addScalar(scalar); }
+
+  void addScalar(double scalar) { impl->addScalar(scalar); }
+
+  void multiplyScalar(int scalar) { impl->multiplyScalar(scalar); }
+
+  void multiplyScalar(double scalar) { impl->multiplyScalar(scalar); }
+
+  void square() { impl->square(); }
+
+  void negate() { impl->negate(); }
+
+  void rotate(int n) { impl->rotate(n); }
+
+  void relinearize() { impl->relinearize(); }
+
+  void rescale() { impl->rescale(); }
+
+  int slotCount() const { return impl->slotCount(); }
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_STATICCTILE_H */
@@ -28,12 +28,16 @@
 #include "AlwaysAssert.h"
 #include "BitwiseEvaluator.h"
 #include "CTile.h"
+#include "CTilePool.h"
 #include "Encoder.h"
+#include "EncryptionPool.h"
 #include "FileUtils.h"
 #include "NativeFunctionEvaluator.h"
 #include "HeContext.h"
 #include "HeTraits.h"
 #include "PTile.h"
+#include "PTileCache.h"
+#include "StaticCTile.h"
 #include "HelayersTimer.h"
 #include "utils/HelayersConfig.h"
 
@@ -41,29 +41,66 @@ shared_ptr<AbstractCiphertext> HelibBgvCiphertext::doClone() const
   return shared_ptr<HelibBgvCiphertext>(new HelibBgvCiphertext(*this));
 }
 
+void HelibBgvCiphertext::addPlain(const HelibBgvPlaintext& p)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::addPlain");
+  addPlainRaw(p);
+}
+
 void HelibBgvCiphertext::addPlainRaw(const AbstractPlaintext& p)
+{
+  addPlainRaw(dynamic_cast<const HelibBgvPlaintext&>(p));
+}
+
+void HelibBgvCiphertext::addPlainRaw(const HelibBgvPlaintext& p)
 {
   HELAYERS_TIMER("HelibBgvCiphertext::addPlainRaw");
-  const HelibBgvPlaintext& castedOther =
-      dynamic_cast<const HelibBgvPlaintext&>(p);
-  ctxt.addConstant(castedOther.getPlaintext());
+  if (p.isPrepared())
+    ctxt.addConstant(*p.getPrepared().expand(ctxt.getPrimeSet()));
+  else
+    ctxt.addConstant(p.getPlaintext());
+}
+
+void HelibBgvCiphertext::subPlain(const HelibBgvPlaintext& p)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::subPlain");
+  subPlainRaw(p);
 }
 
 void HelibBgvCiphertext::subPlainRaw(const AbstractPlaintext& p)
+{
+  subPlainRaw(dynamic_cast<const HelibBgvPlaintext&>(p));
+}
+
+void HelibBgvCiphertext::subPlainRaw(const HelibBgvPlaintext& p)
 {
   HELAYERS_TIMER("HelibBgvCiphertext::subPlainRaw");
-  const HelibBgvPlaintext& castedOther =
-      dynamic_cast<const HelibBgvPlaintext&>(p);
-  helib::Ptxt<helib::BGV> ptxtCopy(castedOther.getPlaintext());
+  if (p.isPrepared()) {
+    ctxt.addConstant(*p.getPrepared().expand(ctxt.getPrimeSet()), true);
+    return;
+  }
+  helib::Ptxt<helib::BGV> ptxtCopy(p.getPlaintext());
   ctxt.addConstant(ptxtCopy.negate());
 }
 
+void HelibBgvCiphertext::multiplyPlain(const HelibBgvPlaintext& p)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::multiplyPlain");
+  multiplyPlainRaw(p);
+}
+
 void HelibBgvCiphertext::multiplyPlainRaw(const AbstractPlaintext& p)
+{
+  multiplyPlainRaw(dynamic_cast<const HelibBgvPlaintext&>(p));
+}
+
+void HelibBgvCiphertext::multiplyPlainRaw(const HelibBgvPlaintext& p)
 {
   HELAYERS_TIMER("HelibBgvCiphertext::multiplyPlainRaw");
-  const HelibBgvPlaintext& castedOther =
-      dynamic_cast<const HelibBgvPlaintext&>(p);
-  ctxt.multByConstant(castedOther.getPlaintext());
+  if (p.isPrepared())
+    ctxt.multByConstant(*p.getPrepared().expand(ctxt.getPrimeSet()));
+  else
+    ctxt.multByConstant(p.getPlaintext());
 }
 
 void HelibBgvCiphertext::negate()
@@ -85,11 +122,43 @@ void HelibBgvCiphertext::conjugateRaw()
 void HelibBgvCiphertext::rotate(int n)
 {
   HELAYERS_TIMER("HelibBgvCiphertext::rotate");
+  he.recordRotation(n);
   if (he.getMirrored())
     he.getEncryptedArray().rotate(ctxt, n);
   else
     he.getEncryptedArray().rotate(ctxt, -n);
 }
 
+vector<shared_ptr<AbstractCiphertext>> HelibBgvCiphertext::rotateMany(
+    const vector<int>& ns) const
+{
+  HELAYERS_TIMER_SECTION("HelibBgvCiphertext::rotateMany");
+  const auto& ea = he.getEncryptedArray();
+  // Hoisting only applies when a rotation is a single automorphism.
+  if (ea.dimension() != 1 || !ea.nativeDimension(0))
+    return AbstractCiphertext::rotateMany(ns);
+
+  vector<long> amounts;
+  amounts.reserve(ns.size());
+  for (int n : ns)
+    amounts.push_back(he.getMirrored() ? n : -n);
+
+  vector<shared_ptr<helib::Ctxt>> rotated =
+      hoistedRotate(ea.getPAlgebra(), ea.sizeOfDimension(0), amounts);
+  if (rotated.empty())
+    return AbstractCiphertext::rotateMany(ns);
+  for (int n : ns)
+    he.recordRotation(n);
+
+  vector<shared_ptr<AbstractCiphertext>> res;
+  res.reserve(rotated.size());
+  for (const auto& r : rotated) {
+    shared_ptr<HelibBgvCiphertext> c = clone();
+    c->ctxt = *r;
+    res.push_back(c);
+  }
+  return res;
+}
+
 int HelibBgvCiphertext::slotCount() const { return he.slotCount(); }
 } // namespace helayers
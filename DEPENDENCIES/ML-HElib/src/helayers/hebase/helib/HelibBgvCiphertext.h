@@ -27,11 +27,14 @@
 
 #include "HelibBgvContext.h"
 #include "HelibCiphertext.h"
+#include "helayers/hebase/StaticCTile.h"
 
 namespace helayers {
 
+class HelibBgvPlaintext;
+
 ///@brief A concrete implementation of CTile API for HElib's BGV scheme.
-class HelibBgvCiphertext : public HelibCiphertext
+class HelibBgvCiphertext final : public HelibCiphertext
 {
   HelibBgvContext& he;
 
@@ -58,6 +61,24 @@ public:
 
   void multiplyPlainRaw(const AbstractPlaintext& plain) override;
 
+  using HelibCiphertext::addPlain;
+  using HelibCiphertext::subPlain;
+  using HelibCiphertext::multiplyPlain;
+
+  /// The following overloads for plaintexts of this scheme do not cast their
+  /// operand. See StaticCTile.
+  void addPlain(const HelibBgvPlaintext& plain);
+
+  void addPlainRaw(const HelibBgvPlaintext& plain);
+
+  void subPlain(const HelibBgvPlaintext& plain);
+
+  void subPlainRaw(const HelibBgvPlaintext& plain);
+
+  void multiplyPlain(const HelibBgvPlaintext& plain);
+
+  void multiplyPlainRaw(const HelibBgvPlaintext& plain);
+
   void conjugate() override;
 
   void conjugateRaw() override;
@@ -65,10 +86,18 @@ public:
   // rotate right
   void rotate(int n) override;
 
+  std::vector<std::shared_ptr<AbstractCiphertext>> rotateMany(
+      const std::vector<int>& ns) const override;
+
   void negate() override;
 
   int slotCount() const override;
 };
+
+/// A CTile for code that knows it works over a HelibBgvContext. See
+/// StaticCTile.
+typedef StaticCTile<HelibBgvCiphertext, HelibBgvPlaintext>
+    HelibBgvCTile;
 } // namespace helayers
 
 #endif /* SRC_HELAYERS_HELIBBGVCIPHER_H_ */
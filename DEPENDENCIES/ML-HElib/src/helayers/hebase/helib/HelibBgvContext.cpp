@@ -73,7 +73,7 @@ void HelibBgvContext::init(const HelibConfig& conf)
 
   secretKey = new helib::SecKey(*context);
   secretKey->GenSecKey();
-  addSome1DMatrices(*secretKey);
+  addRotationMatrices();
   publicKey = secretKey;
   initCommon(context);
 }
@@ -40,6 +40,7 @@ void HelibBgvEncoder::encode(AbstractPlaintext& res,
                              int chainIndex) const
 {
   HelibBgvPlaintext& p = dynamic_cast<HelibBgvPlaintext&>(res);
+  p.prepared.reset();
   for (int i_vals = 0; i_vals < he.slotCount(); ++i_vals) {
     int i_p = he.getMirrored() ? he.slotCount() - i_vals - 1 : i_vals;
     p.pt[i_p] = (i_vals < vals.size() ? (vals[i_vals]) : 0);
@@ -50,6 +51,7 @@ void HelibBgvEncoder::encode(AbstractPlaintext& res,
                              int chainIndex) const
 {
   HelibBgvPlaintext& p = dynamic_cast<HelibBgvPlaintext&>(res);
+  p.prepared.reset();
   for (int i_vals = 0; i_vals < he.slotCount(); ++i_vals) {
     int i_p = he.getMirrored() ? he.slotCount() - i_vals - 1 : i_vals;
     p.pt[i_p] = (i_vals < vals.size() ? (vals[i_vals]) : 0);
@@ -59,11 +61,20 @@ void HelibBgvEncoder::encode(AbstractPlaintext& res,
 void HelibBgvEncoder::encode(AbstractPlaintext& res,
                              const vector<double>& vals,
                              int chainIndex) const
+{
+  encode(res, vals.data(), vals.size(), chainIndex);
+}
+
+void HelibBgvEncoder::encode(AbstractPlaintext& res,
+                             const double* vals,
+                             int size,
+                             int chainIndex) const
 {
   HelibBgvPlaintext& p = dynamic_cast<HelibBgvPlaintext&>(res);
+  p.prepared.reset();
   for (int i_vals = 0; i_vals < he.slotCount(); ++i_vals) {
     int i_p = he.getMirrored() ? he.slotCount() - i_vals - 1 : i_vals;
-    p.pt[i_p] = (i_vals < vals.size() ? (vals[i_vals]) : 0);
+    p.pt[i_p] = (i_vals < size ? (vals[i_vals]) : 0);
   }
 }
 
@@ -96,17 +107,29 @@ vector<int> HelibBgvEncoder::decodeInt(const AbstractPlaintext& src) const
   return res;
 }
 
+void HelibBgvEncoder::prepare(AbstractPlaintext& res) const
+{
+  dynamic_cast<HelibBgvPlaintext&>(res).prepare();
+}
+
 vector<double> HelibBgvEncoder::decodeDouble(const AbstractPlaintext& src) const
 {
-  const HelibBgvPlaintext& p = dynamic_cast<const HelibBgvPlaintext&>(src);
   vector<double> res(he.slotCount());
-  for (int i_slot = 0; i_slot < he.slotCount(); ++i_slot) {
-    int i_vec = (he.getMirrored()) ? he.slotCount() - i_slot - 1 : i_slot;
-    res[i_vec] = (long)p.pt[i_slot];
-  }
+  decodeDouble(src, res.data(), res.size());
   return res;
 }
 
+void HelibBgvEncoder::decodeDouble(const AbstractPlaintext& src,
+                                   double* out,
+                                   int size) const
+{
+  const HelibBgvPlaintext& p = dynamic_cast<const HelibBgvPlaintext&>(src);
+  for (int i_vec = 0; i_vec < size; ++i_vec) {
+    int i_slot = (he.getMirrored()) ? he.slotCount() - i_vec - 1 : i_vec;
+    out[i_vec] = (long)p.pt[i_slot];
+  }
+}
+
 vector<complex<double>> HelibBgvEncoder::decodeComplex(
     const AbstractPlaintext& src) const
 {
@@ -130,6 +153,7 @@ void HelibBgvEncoder::decrypt(AbstractPlaintext& res,
 {
   const HelibBgvCiphertext& c = dynamic_cast<const HelibBgvCiphertext&>(src);
   HelibBgvPlaintext& p = dynamic_cast<HelibBgvPlaintext&>(res);
+  p.prepared.reset();
   he.getSecretKey().Decrypt(p.pt, c.ctxt);
 }
 
@@ -153,9 +177,17 @@ void HelibBgvEncoder::encodeEncrypt(AbstractCiphertext& res,
 void HelibBgvEncoder::encodeEncrypt(AbstractCiphertext& res,
                                     const vector<double>& vals,
                                     int chainIndex) const
+{
+  encodeEncrypt(res, vals.data(), vals.size(), chainIndex);
+}
+
+void HelibBgvEncoder::encodeEncrypt(AbstractCiphertext& res,
+                                    const double* vals,
+                                    int size,
+                                    int chainIndex) const
 {
   shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
-  encode(*p, vals, chainIndex);
+  encode(*p, vals, size, chainIndex);
   encrypt(res, *p);
 }
 
@@ -192,6 +224,15 @@ vector<double> HelibBgvEncoder::decryptDecodeDouble(
   return decodeDouble(*p);
 }
 
+void HelibBgvEncoder::decryptDecodeDouble(const AbstractCiphertext& src,
+                                          double* out,
+                                          int size) const
+{
+  shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
+  decrypt(*p, src);
+  decodeDouble(*p, out, size);
+}
+
 vector<complex<double>> HelibBgvEncoder::decryptDecodeComplex(
     const AbstractCiphertext& src) const
 {
@@ -53,6 +53,13 @@ public:
   void encode(AbstractPlaintext& res,
               const std::vector<std::complex<double>>& vals,
               int chainIndex) const override;
+  void encode(AbstractPlaintext& res,
+              const double* vals,
+              int size,
+              int chainIndex) const override;
+
+  // prepare
+  void prepare(AbstractPlaintext& res) const override;
 
   // decode
   std::vector<int> decodeInt(const AbstractPlaintext& src) const override;
@@ -60,6 +67,9 @@ public:
   std::vector<double> decodeDouble(const AbstractPlaintext& src) const override;
   std::vector<std::complex<double>> decodeComplex(
       const AbstractPlaintext& src) const override;
+  void decodeDouble(const AbstractPlaintext& src,
+                    double* out,
+                    int size) const override;
 
   // encrypt
   void encrypt(AbstractCiphertext& res,
@@ -82,6 +92,10 @@ public:
   void encodeEncrypt(AbstractCiphertext& res,
                      const std::vector<std::complex<double>>& vals,
                      int chainIndex) const override;
+  void encodeEncrypt(AbstractCiphertext& res,
+                     const double* vals,
+                     int size,
+                     int chainIndex) const override;
 
   // decrypt + decode
   std::vector<int> decryptDecodeInt(
@@ -92,6 +106,9 @@ public:
       const AbstractCiphertext& src) const override;
   std::vector<std::complex<double>> decryptDecodeComplex(
       const AbstractCiphertext& src) const override;
+  void decryptDecodeDouble(const AbstractCiphertext& src,
+                           double* out,
+                           int size) const override;
 };
 } // namespace helayers
 
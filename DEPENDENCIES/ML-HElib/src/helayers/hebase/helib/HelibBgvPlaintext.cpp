@@ -51,6 +51,7 @@ streamoff HelibBgvPlaintext::load(istream& stream)
   streampos streamStartPos = stream.tellg();
 
   readPtxtFromBinary(stream, pt, heContext.getContext());
+  prepared.reset();
 
   streampos streamEndPos = stream.tellg();
 
@@ -73,6 +74,25 @@ const helib::Ptxt<helib::BGV>& HelibBgvPlaintext::getPlaintext() const
   return pt;
 }
 
+void HelibBgvPlaintext::prepare()
+{
+  if (prepared)
+    return;
+  vector<long> vals(pt.size());
+  for (size_t i = 0; i < vals.size(); ++i)
+    vals[i] = (long)pt[i];
+  PtxtArray slots(heContext.getContext());
+  slots.load(vals);
+  prepared = make_shared<HelibPreparedPtxt>(heContext.getContext(), slots);
+}
+
+const HelibPreparedPtxt& HelibBgvPlaintext::getPrepared() const
+{
+  if (!prepared)
+    throw runtime_error("This plaintext is not prepared");
+  return *prepared;
+}
+
 void HelibBgvPlaintext::writePtxtToBinary(std::ostream& stream,
                                           const helib::Ptxt<helib::BGV>& pt)
 {
@@ -27,6 +27,7 @@
 
 #include "helayers/hebase/impl/AbstractPlaintext.h"
 #include "HelibBgvContext.h"
+#include "HelibPreparedPtxt.h"
 
 namespace helayers {
 
@@ -39,6 +40,9 @@ class HelibBgvPlaintext : public AbstractPlaintext
 
   helib::Ptxt<helib::BGV> pt;
 
+  /// Set by prepare(), and reset whenever pt changes.
+  std::shared_ptr<const HelibPreparedPtxt> prepared;
+
   /// @brief A default copy constructor.
   HelibBgvPlaintext(const HelibBgvPlaintext& src) = default;
 
@@ -90,6 +94,16 @@ public:
   /// scheme.
   const helib::Ptxt<helib::BGV>& getPlaintext() const;
 
+  /// @brief Computes the ring form of this plaintext for repeated use by
+  /// ciphertext operations, unless already computed. See Encoder::prepare().
+  void prepare();
+
+  bool isPrepared() const override { return prepared != nullptr; }
+
+  /// @brief Returns the ring form computed by prepare().
+  /// @throw runtime_error if this plaintext is not prepared.
+  const HelibPreparedPtxt& getPrepared() const;
+
   /// @brief Writes the given helib::Ptxt into the given binary stream.
   /// @param out The binary stream to save to.
   /// @param pt  The helib::Ptxt object to save.
@@ -30,6 +30,43 @@ using namespace std;
 
 namespace helayers {
 
+vector<shared_ptr<helib::Ctxt>> HelibCiphertext::hoistedRotate(
+    const helib::PAlgebra& zMStar,
+    long ord,
+    const vector<long>& ns) const
+{
+  vector<shared_ptr<helib::Ctxt>> res;
+  if (ns.empty())
+    return res;
+
+  const helib::PubKey& pubKey = ctxt.getPubKey();
+  vector<long> exps;
+  exps.reserve(ns.size());
+  for (long n : ns) {
+    long amt = ((n % ord) + ord) % ord;
+    long k = zMStar.genToPow(0, amt);
+    if (amt != 0 && !pubKey.haveKeySWmatrix(1, k, 0, 0))
+      return res;
+    exps.push_back(k);
+  }
+
+  HELAYERS_TIMER_SECTION("HelibCiphertext::hoistedRotate");
+  helib::BasicAutomorphPrecon precon(ctxt);
+  res.reserve(exps.size());
+  for (long k : exps)
+    res.push_back(precon.automorph(k));
+  return res;
+}
+
+void HelibCiphertext::copyFrom(const AbstractCiphertext& src)
+{
+  HELAYERS_TIMER("HelibCiphertext::copyFrom");
+  const HelibCiphertext& castedSrc = dynamic_cast<const HelibCiphertext&>(src);
+  // Assigning a Ctxt assigns its parts in place, keeping their polynomials'
+  // allocations when the sizes match.
+  ctxt = castedSrc.ctxt;
+}
+
 streamoff HelibCiphertext::save(ostream& stream) const
 {
   HELAYERS_TIMER("HelibCiphertext::save");
@@ -60,12 +97,21 @@ void HelibCiphertext::add(const AbstractCiphertext& other)
   addRaw(other);
 }
 
+void HelibCiphertext::add(const HelibCiphertext& other)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::add");
+  addRaw(other);
+}
+
 void HelibCiphertext::addRaw(const AbstractCiphertext& other)
+{
+  addRaw(dynamic_cast<const HelibCiphertext&>(other));
+}
+
+void HelibCiphertext::addRaw(const HelibCiphertext& other)
 {
   HELAYERS_TIMER("HelibCiphertext::addRaw");
-  const HelibCiphertext& castedOther =
-      dynamic_cast<const HelibCiphertext&>(other);
-  ctxt += castedOther.ctxt;
+  ctxt += other.ctxt;
 }
 
 void HelibCiphertext::sub(const AbstractCiphertext& other)
@@ -74,28 +120,43 @@ void HelibCiphertext::sub(const AbstractCiphertext& other)
   subRaw(other);
 }
 
+void HelibCiphertext::sub(const HelibCiphertext& other)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::sub");
+  subRaw(other);
+}
+
 void HelibCiphertext::subRaw(const AbstractCiphertext& other)
+{
+  subRaw(dynamic_cast<const HelibCiphertext&>(other));
+}
+
+void HelibCiphertext::subRaw(const HelibCiphertext& other)
 {
   HELAYERS_TIMER("HelibCiphertext::subRaw");
-  const HelibCiphertext& castedOther =
-      dynamic_cast<const HelibCiphertext&>(other);
-  ctxt -= castedOther.ctxt;
+  ctxt -= other.ctxt;
 }
 
 void HelibCiphertext::multiply(const AbstractCiphertext& other)
+{
+  multiply(dynamic_cast<const HelibCiphertext&>(other));
+}
+
+void HelibCiphertext::multiply(const HelibCiphertext& other)
 {
   HELAYERS_TIMER("HelibCiphertext::multiply");
-  const HelibCiphertext& castedOther =
-      dynamic_cast<const HelibCiphertext&>(other);
-  ctxt.multiplyBy(castedOther.ctxt);
+  ctxt.multiplyBy(other.ctxt);
 }
 
 void HelibCiphertext::multiplyRaw(const AbstractCiphertext& other)
+{
+  multiplyRaw(dynamic_cast<const HelibCiphertext&>(other));
+}
+
+void HelibCiphertext::multiplyRaw(const HelibCiphertext& other)
 {
   HELAYERS_TIMER("HelibCiphertext::multiplyRaw");
-  const HelibCiphertext& castedOther =
-      dynamic_cast<const HelibCiphertext&>(other);
-  ctxt.multLowLvl(castedOther.ctxt);
+  ctxt.multLowLvl(other.ctxt);
 }
 
 void HelibCiphertext::addPlain(const AbstractPlaintext& plain)
@@ -119,13 +180,13 @@ void HelibCiphertext::multiplyPlain(const AbstractPlaintext& plain)
 void HelibCiphertext::square()
 {
   HELAYERS_TIMER_SECTION("HelibCiphertext::square");
-  squareRaw();
+  ctxt.multiplyBy(ctxt);
 }
 
 void HelibCiphertext::squareRaw()
 {
   HELAYERS_TIMER("HelibCiphertext::squareRaw");
-  multiply(*this);
+  ctxt.multLowLvl(ctxt);
 }
 
 void HelibCiphertext::relinearize()
@@ -136,6 +197,12 @@ void HelibCiphertext::relinearize()
 
 void HelibCiphertext::reduceChainIndex() {}
 
+void HelibCiphertext::compact()
+{
+  HELAYERS_TIMER("HelibCiphertext::compact");
+  ctxt.bringToSet(ctxt.naturalPrimeSet());
+}
+
 void HelibCiphertext::setChainIndex(const AbstractCiphertext& other) {}
 
 void HelibCiphertext::setChainIndex(int chainIndex) {}
@@ -37,12 +37,26 @@ class HelibCiphertext : public AbstractCiphertext
 protected:
   helib::Ctxt ctxt;
 
+  /// Rotates ctxt by each of the given offsets along a single native
+  /// dimension, sharing the key switching decomposition between them
+  /// (HElib's hoisting). Returns an empty vector if the public key has no
+  /// direct key switching matrix for one of the rotations.
+  /// @param[in] zMStar the underlying algebra
+  /// @param[in] ord size of the rotated dimension
+  /// @param[in] ns rotate offsets, in HElib's direction
+  std::vector<std::shared_ptr<helib::Ctxt>> hoistedRotate(
+      const helib::PAlgebra& zMStar,
+      long ord,
+      const std::vector<long>& ns) const;
+
 public:
   HelibCiphertext(HelibContext& h)
       : AbstractCiphertext(h), ctxt(h.getPublicKey())
   {}
   virtual ~HelibCiphertext() {}
 
+  void copyFrom(const AbstractCiphertext& src) override;
+
   std::streamoff save(std::ostream& stream) const override;
 
   std::streamoff load(std::istream& stream) override;
@@ -59,6 +73,20 @@ public:
 
   void multiplyRaw(const AbstractCiphertext& other) override;
 
+  /// The following overloads for HElib operands are not virtual and do not
+  /// cast their operand. See StaticCTile.
+  void add(const HelibCiphertext& other);
+
+  void addRaw(const HelibCiphertext& other);
+
+  void sub(const HelibCiphertext& other);
+
+  void subRaw(const HelibCiphertext& other);
+
+  void multiply(const HelibCiphertext& other);
+
+  void multiplyRaw(const HelibCiphertext& other);
+
   void addPlain(const AbstractPlaintext& plain) override;
 
   void subPlain(const AbstractPlaintext& plain) override;
@@ -80,6 +108,8 @@ public:
 
   void reduceChainIndex() override;
 
+  void compact() override;
+
   void setChainIndex(const AbstractCiphertext& other) override;
 
   void setChainIndex(int chainIndex) override;
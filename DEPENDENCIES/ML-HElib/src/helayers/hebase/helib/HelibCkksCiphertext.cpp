@@ -39,28 +39,64 @@ shared_ptr<AbstractCiphertext> HelibCkksCiphertext::doClone() const
   return shared_ptr<HelibCkksCiphertext>(new HelibCkksCiphertext(*this));
 }
 
+void HelibCkksCiphertext::addPlain(const HelibCkksPlaintext& p)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::addPlain");
+  addPlainRaw(p);
+}
+
 void HelibCkksCiphertext::addPlainRaw(const AbstractPlaintext& p)
+{
+  addPlainRaw(dynamic_cast<const HelibCkksPlaintext&>(p));
+}
+
+void HelibCkksCiphertext::addPlainRaw(const HelibCkksPlaintext& p)
 {
   HELAYERS_TIMER("HelibCkksCiphertext::addPlainRaw");
-  const HelibCkksPlaintext& castedOther =
-      dynamic_cast<const HelibCkksPlaintext&>(p);
-  ctxt += castedOther.getPlaintext();
+  if (p.isPrepared())
+    ctxt.addConstant(*p.getPrepared().expand(ctxt.getPrimeSet()));
+  else
+    ctxt += p.getPlaintext();
+}
+
+void HelibCkksCiphertext::subPlain(const HelibCkksPlaintext& p)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::subPlain");
+  subPlainRaw(p);
 }
 
 void HelibCkksCiphertext::subPlainRaw(const AbstractPlaintext& p)
+{
+  subPlainRaw(dynamic_cast<const HelibCkksPlaintext&>(p));
+}
+
+void HelibCkksCiphertext::subPlainRaw(const HelibCkksPlaintext& p)
 {
   HELAYERS_TIMER_SECTION("HelibCkksCiphertext::subPlainRaw");
-  const HelibCkksPlaintext& castedOther =
-      dynamic_cast<const HelibCkksPlaintext&>(p);
-  ctxt -= castedOther.getPlaintext();
+  if (p.isPrepared())
+    ctxt.addConstant(*p.getPrepared().expand(ctxt.getPrimeSet()), true);
+  else
+    ctxt -= p.getPlaintext();
+}
+
+void HelibCkksCiphertext::multiplyPlain(const HelibCkksPlaintext& p)
+{
+  HELAYERS_TIMER_SECTION("HelibCiphertext::multiplyPlain");
+  multiplyPlainRaw(p);
 }
 
 void HelibCkksCiphertext::multiplyPlainRaw(const AbstractPlaintext& p)
+{
+  multiplyPlainRaw(dynamic_cast<const HelibCkksPlaintext&>(p));
+}
+
+void HelibCkksCiphertext::multiplyPlainRaw(const HelibCkksPlaintext& p)
 {
   HELAYERS_TIMER("HelibCkksCiphertext::multiplyPlainRaw");
-  const HelibCkksPlaintext& castedOther =
-      dynamic_cast<const HelibCkksPlaintext&>(p);
-  ctxt *= castedOther.getPlaintext();
+  if (p.isPrepared())
+    ctxt.multByConstant(*p.getPrepared().expand(ctxt.getPrimeSet()));
+  else
+    ctxt *= p.getPlaintext();
 }
 
 void HelibCkksCiphertext::addScalar(int scalar)
@@ -123,6 +159,7 @@ void HelibCkksCiphertext::conjugateRaw()
 void HelibCkksCiphertext::rotate(int n)
 {
   HELAYERS_TIMER("HelibCkksCiphertext::rotate");
+  he.recordRotation(n);
   if (he.getMirrored())
     he.getEncryptedArray().rotate(ctxt, n);
   else
@@ -135,5 +172,36 @@ void HelibCkksCiphertext::negate()
   ctxt.negate();
 }
 
+vector<shared_ptr<AbstractCiphertext>> HelibCkksCiphertext::rotateMany(
+    const vector<int>& ns) const
+{
+  HELAYERS_TIMER_SECTION("HelibCkksCiphertext::rotateMany");
+  const auto& ea = he.getEncryptedArray();
+  // Hoisting only applies when a rotation is a single automorphism.
+  if (ea.dimension() != 1 || !ea.nativeDimension(0))
+    return AbstractCiphertext::rotateMany(ns);
+
+  vector<long> amounts;
+  amounts.reserve(ns.size());
+  for (int n : ns)
+    amounts.push_back(he.getMirrored() ? n : -n);
+
+  vector<shared_ptr<helib::Ctxt>> rotated =
+      hoistedRotate(ea.getPAlgebra(), ea.sizeOfDimension(0), amounts);
+  if (rotated.empty())
+    return AbstractCiphertext::rotateMany(ns);
+  for (int n : ns)
+    he.recordRotation(n);
+
+  vector<shared_ptr<AbstractCiphertext>> res;
+  res.reserve(rotated.size());
+  for (const auto& r : rotated) {
+    shared_ptr<HelibCkksCiphertext> c = clone();
+    c->ctxt = *r;
+    res.push_back(c);
+  }
+  return res;
+}
+
 int HelibCkksCiphertext::slotCount() const { return he.slotCount(); }
 } // namespace helayers
@@ -26,12 +26,15 @@
 #define SRC_HELAYERS_HELIBCKKSCIPHER_H_
 
 #include "HelibCiphertext.h"
+#include "helayers/hebase/StaticCTile.h"
 #include "HelibCkksContext.h"
 
 namespace helayers {
 
+class HelibCkksPlaintext;
+
 ///@brief A concrete implementation of CTile API for Helib's CKKS scheme.
-class HelibCkksCiphertext : public HelibCiphertext
+class HelibCkksCiphertext final : public HelibCiphertext
 {
 private:
   HelibCkksContext& he;
@@ -58,6 +61,24 @@ public:
 
   void multiplyPlainRaw(const AbstractPlaintext& plain) override;
 
+  using HelibCiphertext::addPlain;
+  using HelibCiphertext::subPlain;
+  using HelibCiphertext::multiplyPlain;
+
+  /// The following overloads for plaintexts of this scheme do not cast their
+  /// operand. See StaticCTile.
+  void addPlain(const HelibCkksPlaintext& plain);
+
+  void addPlainRaw(const HelibCkksPlaintext& plain);
+
+  void subPlain(const HelibCkksPlaintext& plain);
+
+  void subPlainRaw(const HelibCkksPlaintext& plain);
+
+  void multiplyPlain(const HelibCkksPlaintext& plain);
+
+  void multiplyPlainRaw(const HelibCkksPlaintext& plain);
+
   void addScalar(int scalar) override;
 
   void addScalar(double scalar) override;
@@ -79,10 +100,18 @@ public:
   // rotate right
   void rotate(int n) override;
 
+  std::vector<std::shared_ptr<AbstractCiphertext>> rotateMany(
+      const std::vector<int>& ns) const override;
+
   void negate() override;
 
   int slotCount() const override;
 };
+
+/// A CTile for code that knows it works over a HelibCkksContext. See
+/// StaticCTile.
+typedef StaticCTile<HelibCkksCiphertext, HelibCkksPlaintext>
+    HelibCkksCTile;
 } // namespace helayers
 
 #endif /* SRC_HELAYERS_HELIBCKKSCIPHER_H_ */
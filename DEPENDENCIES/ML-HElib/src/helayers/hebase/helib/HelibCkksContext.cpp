@@ -29,6 +29,7 @@
 #include "HelibCkksEncoder.h"
 #include "helayers/hebase/HelayersTimer.h"
 #include "helayers/hebase/AlwaysAssert.h"
+#include <sstream>
 
 using namespace helib;
 using namespace std;
@@ -93,7 +94,7 @@ void HelibCkksContext::init(const HelibConfig& conf)
 
   secretKey = new helib::SecKey(*context);
   secretKey->GenSecKey();
-  addSome1DMatrices(*secretKey);
+  addRotationMatrices();
   if (conf.enableConjugate) {
     addFrbMatrices(*secretKey);
   }
@@ -102,6 +103,33 @@ void HelibCkksContext::init(const HelibConfig& conf)
   initCommon(context);
 }
 
+void HelibCkksContext::init(const HeConfigRequirement& req)
+{
+  if (context != NULL)
+    throw runtime_error("This context is already initialized");
+
+  HelibConfig conf;
+  ostringstream rationale;
+  if (!conf.initRequirement(req, rationale))
+    throw invalid_argument(rationale.str());
+  init(conf);
+
+  int securityLevel = getSecurityLevel();
+  rationale << "HElib estimates a security level of " << securityLevel
+            << endl;
+  configRationale = rationale.str();
+  if (securityLevel < req.securityLevel)
+    throw runtime_error(configRationale);
+}
+
+bool HelibCkksContext::isConfigRequirementFeasible(
+    const HeConfigRequirement& req) const
+{
+  HelibConfig conf;
+  ostringstream rationale;
+  return conf.initRequirement(req, rationale);
+}
+
 void HelibCkksContext::init(const HelibConfig& conf,
                             helib::Context* userContext,
                             helib::SecKey* userSecretKey,
@@ -42,6 +42,8 @@ class HelibCkksContext : public HelibContext
 private:
   const helib::EncryptedArrayCx* ea = NULL;
 
+  std::string configRationale;
+
 protected:
   /// A helper function for init() method
   void initCommon(helib::Context* context);
@@ -63,6 +65,23 @@ public:
   /// @param[in] conf user configuration
   void init(const HelibConfig& conf) override;
 
+  /// Initializes context with the configuration chosen for the given
+  /// requirement by HelibConfig::initRequirement(). See
+  /// getConfigRationale() for the reasoning.
+  /// @param[in] req the requirement
+  /// @throw invalid_argument if no configuration satisfies the requirement.
+  /// @throw runtime_error if HElib's estimate of the security of the
+  ///        initialized context is below the required level.
+  void init(const HeConfigRequirement& req) override;
+
+  bool isConfigRequirementFeasible(
+      const HeConfigRequirement& req) const override;
+
+  /// Returns the reasoning behind the configuration chosen by
+  /// init(const HeConfigRequirement&), or an empty string if the context was
+  /// initialized otherwise.
+  const std::string& getConfigRationale() const { return configRationale; }
+
   /// Initializes context with given context and keys
   /// @param[in] conf user configuration
   /// @param[in] userContext user context
@@ -55,54 +55,97 @@ int HelibCkksEncoder::getDecryptAddedNoisePrecision() const
   return decryptAddedNoisePrecision;
 }
 
+// Reused by decryption so that hot loops do not allocate a slot vector
+// per call.
+static vector<complex<double>>& slotsBuffer()
+{
+  thread_local vector<complex<double>> slots;
+  return slots;
+}
+
 void HelibCkksEncoder::encode(AbstractPlaintext& res,
                               const vector<double>& vals,
                               int chainIndex) const
+{
+  encode(res, vals.data(), vals.size(), chainIndex);
+}
+
+void HelibCkksEncoder::encode(AbstractPlaintext& res,
+                              const vector<complex<double>>& vals,
+                              int chainIndex) const
+{
+  encode(res, vals.data(), vals.size(), chainIndex);
+}
+
+void HelibCkksEncoder::encode(AbstractPlaintext& res,
+                              const double* vals,
+                              int size,
+                              int chainIndex) const
 {
   HelibCkksPlaintext& p = dynamic_cast<HelibCkksPlaintext&>(res);
+  p.prepared.reset();
   for (int i_val = 0; i_val < he.slotCount(); ++i_val) {
     int i_slot = (he.getMirrored()) ? he.slotCount() - i_val - 1 : i_val;
-    p.pt[i_slot] = (i_val < vals.size() ? vals[i_val] : 0);
+    p.pt[i_slot] = (i_val < size ? vals[i_val] : 0);
   }
 }
 
 void HelibCkksEncoder::encode(AbstractPlaintext& res,
-                              const vector<complex<double>>& vals,
+                              const complex<double>* vals,
+                              int size,
                               int chainIndex) const
 {
   HelibCkksPlaintext& p = dynamic_cast<HelibCkksPlaintext&>(res);
+  p.prepared.reset();
   for (int i_val = 0; i_val < he.slotCount(); ++i_val) {
     int i_slot = (he.getMirrored()) ? he.slotCount() - i_val - 1 : i_val;
-    p.pt[i_slot] = (i_val < vals.size() ? vals[i_val] : 0);
+    p.pt[i_slot] = (i_val < size ? vals[i_val] : 0);
   }
 }
 
+void HelibCkksEncoder::prepare(AbstractPlaintext& res) const
+{
+  dynamic_cast<HelibCkksPlaintext&>(res).prepare();
+}
+
 vector<double> HelibCkksEncoder::decodeDouble(
     const AbstractPlaintext& src) const
 {
-  const HelibCkksPlaintext& p = dynamic_cast<const HelibCkksPlaintext&>(src);
   vector<double> res(he.slotCount());
-  for (int i = 0; i < he.slotCount(); ++i)
-    if (he.getMirrored())
-      res[he.slotCount() - i - 1] = p.pt[i].real();
-    else
-      res[i] = p.pt[i].real();
+  decodeDouble(src, res.data(), res.size());
   return res;
 }
 
 vector<complex<double>> HelibCkksEncoder::decodeComplex(
     const AbstractPlaintext& src) const
 {
-  const HelibCkksPlaintext& p = dynamic_cast<const HelibCkksPlaintext&>(src);
   vector<complex<double>> res(he.slotCount());
-  for (int i = 0; i < he.slotCount(); ++i)
-    if (he.getMirrored())
-      res[he.slotCount() - i - 1] = p.pt[i];
-    else
-      res[i] = p.pt[i];
+  decodeComplex(src, res.data(), res.size());
   return res;
 }
 
+void HelibCkksEncoder::decodeDouble(const AbstractPlaintext& src,
+                                    double* out,
+                                    int size) const
+{
+  const HelibCkksPlaintext& p = dynamic_cast<const HelibCkksPlaintext&>(src);
+  for (int i = 0; i < size; ++i) {
+    int i_slot = (he.getMirrored()) ? he.slotCount() - i - 1 : i;
+    out[i] = p.pt[i_slot].real();
+  }
+}
+
+void HelibCkksEncoder::decodeComplex(const AbstractPlaintext& src,
+                                     complex<double>* out,
+                                     int size) const
+{
+  const HelibCkksPlaintext& p = dynamic_cast<const HelibCkksPlaintext&>(src);
+  for (int i = 0; i < size; ++i) {
+    int i_slot = (he.getMirrored()) ? he.slotCount() - i - 1 : i;
+    out[i] = p.pt[i_slot];
+  }
+}
+
 void HelibCkksEncoder::encrypt(AbstractCiphertext& res,
                                const AbstractPlaintext& src) const
 {
@@ -111,55 +154,102 @@ void HelibCkksEncoder::encrypt(AbstractCiphertext& res,
   he.getEncryptedArray().encrypt(c.ctxt, he.getPublicKey(), p.pt);
 }
 
-void HelibCkksEncoder::decrypt(AbstractPlaintext& res,
-                               const AbstractCiphertext& src) const
+void HelibCkksEncoder::decryptSlots(const AbstractCiphertext& src,
+                                    vector<complex<double>>& slots) const
 {
   const HelibCkksCiphertext& c = dynamic_cast<const HelibCkksCiphertext&>(src);
-  HelibCkksPlaintext& p = dynamic_cast<HelibCkksPlaintext&>(res);
+  const EncryptedArrayCx& ea = he.getEncryptedArray();
 
-  if (!decryptAddedNoiseEnabled) {
-    vector<complex<double>> res(he.slotCount());
-    he.getEncryptedArray().rawDecrypt(c.ctxt, he.getSecretKey(), res);
-    for (int i = 0; i < he.slotCount(); ++i)
-      p.pt[i] = res[i];
-  } else if (decryptAddedNoisePrecision > 0)
-    he.getEncryptedArray().decrypt(
-        c.ctxt, he.getSecretKey(), p.pt, decryptAddedNoisePrecision);
+  if (!decryptAddedNoiseEnabled)
+    ea.rawDecrypt(c.ctxt, he.getSecretKey(), slots);
+  else if (decryptAddedNoisePrecision > 0)
+    ea.decrypt(c.ctxt, he.getSecretKey(), slots, decryptAddedNoisePrecision);
   else
-    he.getEncryptedArray().decrypt(c.ctxt, he.getSecretKey(), p.pt);
+    ea.decrypt(c.ctxt, he.getSecretKey(), slots);
+}
+
+void HelibCkksEncoder::decrypt(AbstractPlaintext& res,
+                               const AbstractCiphertext& src) const
+{
+  HelibCkksPlaintext& p = dynamic_cast<HelibCkksPlaintext&>(res);
+  p.prepared.reset();
+  vector<complex<double>>& slots = slotsBuffer();
+  decryptSlots(src, slots);
+  for (int i = 0; i < he.slotCount(); ++i)
+    p.pt[i] = slots[i];
 }
 
 void HelibCkksEncoder::encodeEncrypt(AbstractCiphertext& res,
                                      const vector<double>& vals,
                                      int chainIndex) const
+{
+  encodeEncrypt(res, vals.data(), vals.size(), chainIndex);
+}
+
+void HelibCkksEncoder::encodeEncrypt(AbstractCiphertext& res,
+                                     const vector<complex<double>>& vals,
+                                     int chainIndex) const
+{
+  encodeEncrypt(res, vals.data(), vals.size(), chainIndex);
+}
+
+void HelibCkksEncoder::encodeEncrypt(AbstractCiphertext& res,
+                                     const double* vals,
+                                     int size,
+                                     int chainIndex) const
 {
   shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
-  encode(*p, vals, chainIndex);
+  encode(*p, vals, size, chainIndex);
   encrypt(res, *p);
 }
 
 void HelibCkksEncoder::encodeEncrypt(AbstractCiphertext& res,
-                                     const vector<complex<double>>& vals,
+                                     const complex<double>* vals,
+                                     int size,
                                      int chainIndex) const
 {
   shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
-  encode(*p, vals, chainIndex);
+  encode(*p, vals, size, chainIndex);
   encrypt(res, *p);
 }
 
 vector<double> HelibCkksEncoder::decryptDecodeDouble(
     const AbstractCiphertext& src) const
 {
-  shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
-  decrypt(*p, src);
-  return decodeDouble(*p);
+  vector<double> res(he.slotCount());
+  decryptDecodeDouble(src, res.data(), res.size());
+  return res;
 }
 
 vector<complex<double>> HelibCkksEncoder::decryptDecodeComplex(
     const AbstractCiphertext& src) const
 {
-  shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
-  decrypt(*p, src);
-  return decodeComplex(*p);
+  vector<complex<double>> res(he.slotCount());
+  decryptDecodeComplex(src, res.data(), res.size());
+  return res;
+}
+
+void HelibCkksEncoder::decryptDecodeDouble(const AbstractCiphertext& src,
+                                           double* out,
+                                           int size) const
+{
+  vector<complex<double>>& slots = slotsBuffer();
+  decryptSlots(src, slots);
+  for (int i = 0; i < size; ++i) {
+    int i_slot = (he.getMirrored()) ? he.slotCount() - i - 1 : i;
+    out[i] = slots[i_slot].real();
+  }
+}
+
+void HelibCkksEncoder::decryptDecodeComplex(const AbstractCiphertext& src,
+                                            complex<double>* out,
+                                            int size) const
+{
+  vector<complex<double>>& slots = slotsBuffer();
+  decryptSlots(src, slots);
+  for (int i = 0; i < size; ++i) {
+    int i_slot = (he.getMirrored()) ? he.slotCount() - i - 1 : i;
+    out[i] = slots[i_slot];
+  }
 }
 } // namespace helayers
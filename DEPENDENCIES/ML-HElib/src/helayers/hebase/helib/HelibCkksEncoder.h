@@ -39,6 +39,11 @@ class HelibCkksEncoder : public AbstractEncoder
   bool decryptAddedNoiseEnabled = true;
   int decryptAddedNoisePrecision = -1; // -1 means don't supply it
 
+  /// Decrypts "src" into the raw (possibly mirrored) slots, following the
+  /// decrypt added noise policy.
+  void decryptSlots(const AbstractCiphertext& src,
+                    std::vector<std::complex<double>>& slots) const;
+
 public:
   HelibCkksEncoder(HelibCkksContext& he);
   ~HelibCkksEncoder();
@@ -56,11 +61,28 @@ public:
   void encode(AbstractPlaintext& res,
               const std::vector<std::complex<double>>& vals,
               int chainIndex) const override;
+  void encode(AbstractPlaintext& res,
+              const double* vals,
+              int size,
+              int chainIndex) const override;
+  void encode(AbstractPlaintext& res,
+              const std::complex<double>* vals,
+              int size,
+              int chainIndex) const override;
+
+  // prepare
+  void prepare(AbstractPlaintext& res) const override;
 
   // decode
   std::vector<double> decodeDouble(const AbstractPlaintext& src) const override;
   std::vector<std::complex<double>> decodeComplex(
       const AbstractPlaintext& src) const override;
+  void decodeDouble(const AbstractPlaintext& src,
+                    double* out,
+                    int size) const override;
+  void decodeComplex(const AbstractPlaintext& src,
+                     std::complex<double>* out,
+                     int size) const override;
 
   // encrypt
   void encrypt(AbstractCiphertext& res,
@@ -77,12 +99,26 @@ public:
   void encodeEncrypt(AbstractCiphertext& res,
                      const std::vector<std::complex<double>>& vals,
                      int chainIndex) const override;
+  void encodeEncrypt(AbstractCiphertext& res,
+                     const double* vals,
+                     int size,
+                     int chainIndex) const override;
+  void encodeEncrypt(AbstractCiphertext& res,
+                     const std::complex<double>* vals,
+                     int size,
+                     int chainIndex) const override;
 
   // decrypt + decode
   std::vector<double> decryptDecodeDouble(
       const AbstractCiphertext& src) const override;
   std::vector<std::complex<double>> decryptDecodeComplex(
       const AbstractCiphertext& src) const override;
+  void decryptDecodeDouble(const AbstractCiphertext& src,
+                           double* out,
+                           int size) const override;
+  void decryptDecodeComplex(const AbstractCiphertext& src,
+                            std::complex<double>* out,
+                            int size) const override;
 };
 } // namespace helayers
 
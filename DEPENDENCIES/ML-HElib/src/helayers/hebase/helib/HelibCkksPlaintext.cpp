@@ -57,6 +57,7 @@ streamoff HelibCkksPlaintext::load(istream& stream)
 
   stringstream in(data);
   pt = Ptxt<CKKS>::readFromJSON(in, heContext.getContext());
+  prepared.reset();
 
   streampos streamEndPos = stream.tellg();
 
@@ -78,4 +79,20 @@ const helib::Ptxt<helib::CKKS>& HelibCkksPlaintext::getPlaintext() const
 
   return pt;
 }
+
+void HelibCkksPlaintext::prepare()
+{
+  if (prepared)
+    return;
+  PtxtArray slots(heContext.getContext());
+  slots.load(pt.getSlotRepr());
+  prepared = make_shared<HelibPreparedPtxt>(heContext.getContext(), slots);
+}
+
+const HelibPreparedPtxt& HelibCkksPlaintext::getPrepared() const
+{
+  if (!prepared)
+    throw runtime_error("This plaintext is not prepared");
+  return *prepared;
+}
 } // namespace helayers
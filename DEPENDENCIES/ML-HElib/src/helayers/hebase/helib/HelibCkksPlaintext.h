@@ -27,6 +27,7 @@
 
 #include "helayers/hebase/impl/AbstractPlaintext.h"
 #include "HelibCkksContext.h"
+#include "HelibPreparedPtxt.h"
 
 namespace helayers {
 
@@ -38,6 +39,9 @@ class HelibCkksPlaintext : public AbstractPlaintext
 
   helib::Ptxt<helib::CKKS> pt;
 
+  /// Set by prepare(), and reset whenever pt changes.
+  std::shared_ptr<const HelibPreparedPtxt> prepared;
+
   /// @brief A default copy constructor.
   HelibCkksPlaintext(const HelibCkksPlaintext& src) = default;
 
@@ -87,6 +91,16 @@ public:
   /// scheme.
   const helib::Ptxt<helib::CKKS>& getPlaintext() const;
 
+  /// @brief Computes the ring form of this plaintext for repeated use by
+  /// ciphertext operations, unless already computed. See Encoder::prepare().
+  void prepare();
+
+  bool isPrepared() const override { return prepared != nullptr; }
+
+  /// @brief Returns the ring form computed by prepare().
+  /// @throw runtime_error if this plaintext is not prepared.
+  const HelibPreparedPtxt& getPrepared() const;
+
   /// @brief Returns the internal plaintext object of the underlying Helib CKKS
   /// scheme.
   const helib::Ptxt<helib::CKKS>& getRaw() const { return pt; }
@@ -23,9 +23,42 @@
  */
 
 #include "HelibConfig.h"
+#include "helayers/hebase/HeContext.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
 
 namespace helayers {
 
+namespace {
+
+// Largest log2 of the modulus for each ring dimension and security level,
+// for a ternary secret, from the HomomorphicEncryption.org security standard.
+struct SecurityBound
+{
+  unsigned long n;
+  unsigned long bits128;
+  unsigned long bits192;
+  unsigned long bits256;
+};
+
+const SecurityBound securityBounds[] = {{1024, 27, 19, 14},
+                                        {2048, 54, 37, 29},
+                                        {4096, 109, 75, 58},
+                                        {8192, 218, 152, 118},
+                                        {16384, 438, 305, 237},
+                                        {32768, 881, 611, 476}};
+
+// Bits of the modulus kept for the noise of fresh encryptions.
+const unsigned long encryptionNoiseBits = 20;
+
+// Bits consumed by a multiplication beyond the scale.
+const unsigned long multiplicationNoiseBits = 10;
+
+// Bits of HElib's special primes beyond a key-switching digit.
+const unsigned long specialPrimesExtraBits = 20;
+} // namespace
+
 void HelibConfig::initPreset(HelibPreset preset)
 {
   p = -1;
@@ -67,6 +100,77 @@ void HelibConfig::initPreset(HelibPreset preset)
   }
 }
 
+bool HelibConfig::initRequirement(const HeConfigRequirement& req,
+                                  std::ostream& rationale)
+{
+  if (req.integerPartPrecision < 0 || req.fractionalPartPrecision <= 0)
+    throw std::invalid_argument("Invalid precision requirement");
+  if (req.securityLevel > 256) {
+    rationale << "Security levels above 256 bits are not supported"
+              << std::endl;
+    return false;
+  }
+
+  unsigned long depth = std::max(req.multiplicationDepth, 0);
+  p = -1;
+  r = req.fractionalPartPrecision;
+  L = encryptionNoiseBits + req.integerPartPrecision + r +
+      depth * (r + multiplicationNoiseBits);
+  rationale << "r=" << r << " for " << req.fractionalPartPrecision
+            << " bits of fractional precision" << std::endl;
+  rationale << "L=" << L << ": " << encryptionNoiseBits
+            << " bits for encryption noise, "
+            << req.integerPartPrecision + r << " bits for the result and "
+            << depth << " multiplications of " << r + multiplicationNoiseBits
+            << " bits" << std::endl;
+
+  bool found = false;
+  double bestCost = 0;
+  for (const SecurityBound& bound : securityBounds) {
+    if (req.numSlots > 0 && bound.n / 2 < (unsigned long)req.numSlots)
+      continue;
+    unsigned long maxBits = ULONG_MAX;
+    if (req.securityLevel > 192)
+      maxBits = bound.bits256;
+    else if (req.securityLevel > 128)
+      maxBits = bound.bits192;
+    else if (req.securityLevel > 0)
+      maxBits = bound.bits128;
+
+    for (unsigned long cols = 2; cols <= 4; ++cols) {
+      unsigned long bits = L + (L + cols - 1) / cols + specialPrimesExtraBits;
+      rationale << "n=" << bound.n << " c=" << cols << ": " << bits
+                << " bits";
+      if (bits > maxBits) {
+        rationale << " exceed the " << maxBits << " allowed" << std::endl;
+        continue;
+      }
+      // NTTs over all primes dominate, and key switching performs them for
+      // each of the c digits
+      double cost = bound.n * std::log2(bound.n) * bits * (cols + 1);
+      rationale << ", estimated cost " << cost << std::endl;
+      if (!found || cost < bestCost) {
+        found = true;
+        bestCost = cost;
+        m = bound.n * 2;
+        c = cols;
+      }
+    }
+    // a larger ring dimension costs more than twice as much, which fewer
+    // columns cannot make up for
+    if (found)
+      break;
+  }
+
+  if (!found) {
+    rationale << "No configuration satisfies the requirement" << std::endl;
+    return false;
+  }
+  rationale << "Chosen " << *this << " with " << m / 4 << " slots"
+            << std::endl;
+  return true;
+}
+
 void HelibConfig::load(std::istream& in)
 {
   in.read((char*)&m, sizeof(m));
@@ -87,6 +191,9 @@ std::ostream& operator<<(std::ostream& out, const HelibConfig& conf)
 {
   out << "m=" << conf.m << " r=" << conf.r << " L=" << conf.L
       << " c=" << conf.c;
+  if (!conf.rotations.empty())
+    out << " rotations=" << conf.rotations.size()
+        << (conf.addPowerOfTwoRotations ? "+pow2" : "");
   return out;
 }
 } // namespace helayers
@@ -26,9 +26,12 @@
 #define SRC_HELAYERS_HELIB_HELIBCONFIG_H_
 
 #include <iostream>
+#include <vector>
 
 namespace helayers {
 
+struct HeConfigRequirement;
+
 /// Named preset configurations
 enum HelibPreset
 {
@@ -68,9 +71,46 @@ struct HelibConfig
   /// Whether conjugate operation will be enabled in HelibCKKS.
   bool enableConjugate = false;
 
+  /// Rotation steps to generate key-switching matrices for, in the direction
+  /// of CTile::rotate(). If empty, HElib's default set of rotation keys is
+  /// generated. Use HelibContext::getRecordedRotations() on a dry run of the
+  /// workload to find them.
+  /// Contexts with more than one rotation dimension ignore this and generate
+  /// the default set.
+  /// Not part of save() and load(): the generated keys are saved with the
+  /// context itself.
+  std::vector<int> rotations;
+
+  /// When rotations is not empty, whether to also generate keys for rotations
+  /// by powers of two in both directions, so that any other rotation is still
+  /// possible using a logarithmic number of key switches.
+  bool addPowerOfTwoRotations = true;
+
   ///@brief Initializes configuration based on preset.
   void initPreset(HelibPreset preset);
 
+  ///@brief Initializes a CKKS configuration that satisfies the given
+  /// requirement at the lowest estimated cost, and writes the reasoning to
+  /// rationale. A multiplication depth or number of slots of -1 means no
+  /// requirement, and a security level of 0 allows insecure configurations.
+  ///
+  /// r is set to the fractional precision, and L to the bits needed for the
+  /// precision and depth. Every power of two ring dimension with enough slots
+  /// and 2 to 4 key-switching columns is then considered. Candidates whose
+  /// modulus, including an estimate of HElib's special primes, exceeds the
+  /// bound of the HomomorphicEncryption.org security standard are rejected,
+  /// and the one with the lowest estimated cost of a key-switching
+  /// operation is chosen. The standard only covers ring dimensions up to
+  /// 32768, so at most 16384 slots are supported. Since special primes are
+  /// estimated, verify the security of the resulting context.
+  ///
+  ///@param req The requirement.
+  ///@param rationale Stream to write the reasoning to.
+  ///@returns Whether a configuration was found. If not, this object is left
+  /// unspecified.
+  bool initRequirement(const HeConfigRequirement& req,
+                       std::ostream& rationale);
+
   ///@brief Loads this HelibConfig from a binary stream.
   ///@param in The stream to load from.
   void load(std::istream& in);
@@ -31,6 +31,32 @@ using namespace helib;
 
 namespace helayers {
 
+namespace {
+
+/// A stream buffer that discards what is written to it, counting its size.
+class CountingStreamBuf : public std::streambuf
+{
+  streamsize count = 0;
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      ++count;
+    return traits_type::not_eof(c);
+  }
+
+  streamsize xsputn(const char*, streamsize n) override
+  {
+    count += n;
+    return n;
+  }
+
+public:
+  streamsize getCount() const { return count; }
+};
+} // namespace
+
 HelibContext::HelibContext() : HeContext()
 {
   // TODO Auto-generated constructor stub
@@ -82,6 +108,18 @@ void HelibContext::printSignature(std::ostream& out) const
   out << "SecurityLevel=" << getSecurityLevel() << endl;
 }
 
+string HelibContext::getSignature() const
+{
+  ostringstream res;
+  res << getLibraryName() << "_" << getSchemeName() << "_m" << config.m << "_r"
+      << config.r << "_L" << config.L << "_c" << config.c;
+  if (config.p != (unsigned long)-1)
+    res << "_p" << config.p;
+  if (publicKey != nullptr)
+    res << "_k" << getNumKeySwitchingMatrices();
+  return res.str();
+}
+
 void HelibContext::debugPrint(const std::string& title,
                               int verbose,
                               std::ostream& out) const
@@ -141,14 +179,157 @@ void HelibContext::load(std::istream& in)
   }
 }
 
+bool HelibContext::hasSingleNativeRotationDimension() const
+{
+  const EncryptedArray& ea = context->getEA();
+  return ea.dimension() == 1 && ea.nativeDimension(0);
+}
+
+long HelibContext::getRotationAutomorphism(int n) const
+{
+  const EncryptedArray& ea = context->getEA();
+  long ord = ea.sizeOfDimension(0);
+  long amt = mirrored ? n : -n;
+  amt = ((amt % ord) + ord) % ord;
+  return ea.getPAlgebra().genToPow(0, amt);
+}
+
+bool HelibContext::genRotationMatrices(const vector<int>& steps)
+{
+  bool added = false;
+  for (int n : steps) {
+    long k = getRotationAutomorphism(n);
+    if (k != 1 && !secretKey->haveKeySWmatrix(1, k, 0, 0)) {
+      secretKey->GenKeySWmatrix(1, k, 0, 0);
+      added = true;
+    }
+  }
+  return added;
+}
+
+void HelibContext::addRotationMatrices()
+{
+  if (config.rotations.empty() || !hasSingleNativeRotationDimension()) {
+    addSome1DMatrices(*secretKey);
+    return;
+  }
+
+  vector<int> steps = config.rotations;
+  if (config.addPowerOfTwoRotations) {
+    long ord = context->getEA().sizeOfDimension(0);
+    for (long e = 1; e < ord; e *= 2) {
+      steps.push_back(e);
+      steps.push_back(-e);
+    }
+  }
+  genRotationMatrices(steps);
+  secretKey->setKeySwitchMap();
+}
+
+void HelibContext::addRotationKeys(const vector<int>& steps)
+{
+  if (!hasSecretKey())
+    throw runtime_error("This context does not have a secret key");
+  // Ciphertexts switch keys using the public key, which only shares the new
+  // matrices if it is the secret key object itself.
+  if (publicKey != secretKey)
+    throw runtime_error("Rotation keys can only be added to a context "
+                        "initialized or loaded with its secret key");
+  if (!hasSingleNativeRotationDimension())
+    throw runtime_error("Rotation keys can only be added when rotations are "
+                        "single automorphisms");
+
+  if (genRotationMatrices(steps))
+    secretKey->setKeySwitchMap();
+}
+
+int HelibContext::getRotationCost(int n) const
+{
+  if (!hasSingleNativeRotationDimension())
+    throw runtime_error("Rotation cost is only available when rotations are "
+                        "single automorphisms");
+
+  long k = getRotationAutomorphism(n);
+  if (k == 1)
+    return 0;
+  if (!publicKey->isReachable(k, 0))
+    return -1;
+
+  // Follows the key switches of Ctxt::smartAutomorph().
+  long m = context->getZMStar().getM();
+  int cost = 0;
+  while (k != 1) {
+    const KeySwitch& matrix = publicKey->getNextKSWmatrix(k, 0);
+    long amt = matrix.fromKey.getPowerOfX();
+    k = NTL::MulMod(k, NTL::InvMod(amt, m), m);
+    ++cost;
+  }
+  return cost;
+}
+
+int HelibContext::getNumKeySwitchingMatrices() const
+{
+  return publicKey->keySWlist().size();
+}
+
+streamoff HelibContext::getKeySwitchingMatricesSize() const
+{
+  CountingStreamBuf buf;
+  ostream out(&buf);
+  for (const KeySwitch& matrix : publicKey->keySWlist())
+    matrix.writeTo(out);
+  return buf.getCount();
+}
+
+void HelibContext::recordRotationLocked(int n)
+{
+  lock_guard<mutex> lock(recordedRotationsMutex);
+  ++recordedRotations[n];
+}
+
+map<int, long> HelibContext::getRecordedRotations() const
+{
+  lock_guard<mutex> lock(recordedRotationsMutex);
+  return recordedRotations;
+}
+
+void HelibContext::clearRecordedRotations()
+{
+  lock_guard<mutex> lock(recordedRotationsMutex);
+  recordedRotations.clear();
+}
+
+void HelibContext::printRotationReport(std::ostream& out) const
+{
+  out << "Key-switching matrices: " << getNumKeySwitchingMatrices() << " ("
+      << getKeySwitchingMatricesSize() << " bytes)" << endl;
+
+  map<int, long> recorded = getRecordedRotations();
+  if (recorded.empty() || !hasSingleNativeRotationDimension())
+    return;
+  long total = 0;
+  for (const auto& rec : recorded) {
+    int cost = getRotationCost(rec.first);
+    out << "rotate(" << rec.first << "): " << rec.second << " times, ";
+    if (cost < 0)
+      out << "no keys" << endl;
+    else
+      out << cost << " key switches each" << endl;
+    if (cost > 0)
+      total += cost * rec.second;
+  }
+  out << "Key switches in recorded rotations: " << total << endl;
+}
+
 void HelibContext::init(const HeConfigRequirement& req)
 {
-  throw runtime_error("not implemented");
+  throw runtime_error("HeConfigRequirement is not supported by HElib " +
+                      getSchemeName() + ", use init(const HelibConfig&)");
 }
 
 bool HelibContext::isConfigRequirementFeasible(
     const HeConfigRequirement& req) const
 {
-  throw runtime_error("not implemented");
+  return false;
 }
 } // namespace helayers
@@ -25,6 +25,8 @@
 #ifndef SRC_HELAYERS_HELIBCONTEXT_H_
 #define SRC_HELAYERS_HELIBCONTEXT_H_
 
+#include <atomic>
+#include <mutex>
 #include "helayers/hebase/HeContext.h"
 #include "helib/helib.h"
 #include "HelibConfig.h"
@@ -46,10 +48,33 @@ protected:
 
   bool mirrored = false;
 
+  std::atomic<bool> recordRotations{false};
+  mutable std::mutex recordedRotationsMutex;
+  std::map<int, long> recordedRotations;
+
+  /// Generates the rotation key-switching matrices requested by config, or
+  /// HElib's default set if it requests none. For use by init().
+  void addRotationMatrices();
+
+  /// Returns whether rotations are single automorphisms, which is what
+  /// choosing rotation keys by step relies on.
+  bool hasSingleNativeRotationDimension() const;
+
+  /// Returns the automorphism implementing CTile::rotate(n).
+  long getRotationAutomorphism(int n) const;
+
+  /// Generates the missing matrices for rotations by the given steps, without
+  /// updating the key-switch map. Returns whether any were generated.
+  bool genRotationMatrices(const std::vector<int>& steps);
+
+  void recordRotationLocked(int n);
+
 public:
   HelibContext();
   virtual ~HelibContext();
 
+  ///@brief Chooses a configuration for the given requirement. Supported only
+  /// by HelibCkksContext.
   void init(const HeConfigRequirement& req) override;
 
   ///@brief Creates a new HelibContext for either CKKS or BGV, based on a preset
@@ -91,6 +116,59 @@ public:
   inline bool getMirrored() const { return mirrored; }
   inline void setMirrored(bool v) { mirrored = v; }
 
+  ///@brief Generates key-switching matrices for rotations by the given steps
+  /// that have no matrix of their own yet. Contexts saved afterwards include
+  /// them.
+  ///
+  ///@param steps Rotation steps, in the direction of CTile::rotate()
+  ///@throw runtime_error if this context has no secret key, or its secret
+  /// key was loaded separately from its public key.
+  void addRotationKeys(const std::vector<int>& steps);
+
+  ///@brief Returns the number of key switches a rotation by n costs with the
+  /// keys of this context: 0 if it is the identity, -1 if it is impossible.
+  ///
+  ///@param n Rotation step, in the direction of CTile::rotate()
+  ///@throw runtime_error if rotations in this context are not single
+  /// automorphisms.
+  int getRotationCost(int n) const;
+
+  ///@brief Returns the number of key-switching matrices in the public key,
+  /// including the relinearization one.
+  int getNumKeySwitchingMatrices() const;
+
+  ///@brief Returns the serialized size in bytes of all key-switching matrices
+  /// in the public key. They make up most of a context saved without its
+  /// secret key.
+  std::streamoff getKeySwitchingMatricesSize() const;
+
+  ///@brief Sets whether rotations of ciphertexts of this context are
+  /// recorded, e.g. in a dry run of a workload to learn which rotation keys
+  /// it needs.
+  ///
+  ///@param val Whether to record
+  inline void setRecordRotations(bool val) { recordRotations = val; }
+
+  ///@brief Returns the recorded rotation steps, each with the number of times
+  /// it was performed.
+  std::map<int, long> getRecordedRotations() const;
+
+  ///@brief Clears the recorded rotation steps.
+  void clearRecordedRotations();
+
+  ///@brief For internal use. Records a rotation by n if recording is on.
+  inline void recordRotation(int n)
+  {
+    if (recordRotations)
+      recordRotationLocked(n);
+  }
+
+  ///@brief Prints the number and size of the key-switching matrices, and the
+  /// cost of each recorded rotation step.
+  ///
+  ///@param out Output stream to print to
+  void printRotationReport(std::ostream& out = std::cout) const;
+
   void printSignature(std::ostream& out = std::cout) const override;
 
   void debugPrint(const std::string& title = "",
@@ -107,6 +185,12 @@ public:
 
   std::string getLibraryName() const override { return "HELIB"; }
 
+  /// Returns the library, scheme and configuration parameters, and the
+  /// number of key-switching matrices generated.
+  std::string getSignature() const override;
+
+  ///@brief Returns whether init(const HeConfigRequirement&) can satisfy the
+  /// given requirement. Always false, except for HelibCkksContext.
   bool isConfigRequirementFeasible(
       const HeConfigRequirement& req) const override;
 };
@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "HelibPreparedPtxt.h"
+#include "helayers/hebase/HelayersTimer.h"
+
+using namespace std;
+using namespace helib;
+
+namespace helayers {
+
+HelibPreparedPtxt::HelibPreparedPtxt(const Context& context,
+                                     const PtxtArray& slots)
+{
+  HELAYERS_TIMER("HelibPreparedPtxt::encode");
+  slots.encode(encoded);
+  expand(context.getCtxtPrimes());
+}
+
+shared_ptr<const FatEncodedPtxt> HelibPreparedPtxt::expand(
+    const IndexSet& s) const
+{
+  lock_guard<mutex> lock(mtx);
+  if (!expanded || primeSet != s) {
+    HELAYERS_TIMER("HelibPreparedPtxt::expand");
+    shared_ptr<FatEncodedPtxt> res = make_shared<FatEncodedPtxt>();
+    res->expand(encoded, s);
+    // Holders of the previous expansion keep it alive until they are done.
+    expanded = res;
+    primeSet = s;
+  }
+  return expanded;
+}
+} // namespace helayers
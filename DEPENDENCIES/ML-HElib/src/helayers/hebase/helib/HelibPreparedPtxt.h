@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_HELIBPREPAREDPTXT_H_
+#define SRC_HELAYERS_HELIBPREPAREDPTXT_H_
+
+#include <memory>
+#include <mutex>
+#include "helib/helib.h"
+
+namespace helayers {
+
+///@brief The ring form of an HElib plaintext, encoded once for repeated use
+/// with ciphertexts. See Encoder::prepare().
+///
+/// The encoding is expanded to DoubleCRT form at the prime set of the
+/// ciphertext it is applied to. The last expansion is kept, since a plaintext
+/// applied many times is typically applied at the same level. Objects are
+/// immutable apart from this expansion, so plaintext copies share them.
+class HelibPreparedPtxt
+{
+  helib::EncodedPtxt encoded;
+
+  mutable std::mutex mtx;
+  mutable helib::IndexSet primeSet;
+  mutable std::shared_ptr<const helib::FatEncodedPtxt> expanded;
+
+public:
+  ///@brief Encodes the given slots, and expands them at the prime set of
+  /// fresh ciphertexts.
+  ///
+  ///@param context The context of the plaintext
+  ///@param slots   The plaintext slots
+  HelibPreparedPtxt(const helib::Context& context,
+                    const helib::PtxtArray& slots);
+
+  HelibPreparedPtxt(const HelibPreparedPtxt& src) = delete;
+  HelibPreparedPtxt& operator=(const HelibPreparedPtxt& src) = delete;
+
+  ///@brief Returns the encoding expanded at the given prime set. Reuses the
+  /// last expansion if it was at the same prime set.
+  ///
+  ///@param s The prime set of the ciphertext to apply it to
+  std::shared_ptr<const helib::FatEncodedPtxt> expand(
+      const helib::IndexSet& s) const;
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_HELIBPREPAREDPTXT_H_ */
@@ -25,6 +25,8 @@
 #include "AbstractCiphertext.h"
 #include "AbstractEncoder.h"
 #include "helayers/hebase/HelayersTimer.h"
+#include "helayers/hebase/CTilePool.h"
+#include "helayers/hebase/PTileCache.h"
 
 #include <algorithm>
 
@@ -34,16 +36,33 @@ namespace helayers {
 
 void AbstractCiphertext::innerSum(int n) { innerSum(1, n); }
 
+vector<shared_ptr<AbstractCiphertext>> AbstractCiphertext::rotateMany(
+    const vector<int>& ns) const
+{
+  HELAYERS_TIMER_SECTION("AbstractCiphertext::rotateMany");
+  vector<shared_ptr<AbstractCiphertext>> res;
+  res.reserve(ns.size());
+  for (int n : ns) {
+    shared_ptr<AbstractCiphertext> tmp = clone();
+    tmp->rotate(n);
+    res.push_back(tmp);
+  }
+  return res;
+}
+
 void AbstractCiphertext::innerSum(int rot1, int rot2, bool reverse)
 {
   HELAYERS_TIMER_SECTION("AbstractCiphertext::innerSum");
+  CTilePool& pool = he.getCTilePool();
   for (int rot = rot1; rot < rot2; rot *= 2) {
-    shared_ptr<AbstractCiphertext> tmp = clone();
+    shared_ptr<AbstractCiphertext> tmp = pool.copyOf(*this);
     tmp->rotate(reverse ? (-rot) : rot);
     add(*tmp);
   }
 }
 
+void AbstractCiphertext::compact() {}
+
 void AbstractCiphertext::multiplyByChangingScale(double factor)
 {
   HELAYERS_TIMER_SECTION("AbstractCiphertext::multiplyByChangingScale");
@@ -70,7 +89,7 @@ void AbstractCiphertext::sumExpBySquaringLeftToRight(int n)
   int e = 1;
   for (int j = bits.size() - 2; j >= 0; j--) {
     // 3  w <- w + (w >>> e), e <- 2*e
-    shared_ptr<AbstractCiphertext> tmp = clone();
+    shared_ptr<AbstractCiphertext> tmp = he.getCTilePool().copyOf(*this);
     rotateCount++;
     tmp->rotate(e);
     add(*tmp);
@@ -117,7 +136,7 @@ void AbstractCiphertext::sumExpBySquaringRightToLeft(int n)
       }
     }
 
-    shared_ptr<AbstractCiphertext> tmp = clone();
+    shared_ptr<AbstractCiphertext> tmp = he.getCTilePool().copyOf(*this);
     rotateCount++;
     tmp->rotate(currExp);
     add(*tmp);
@@ -169,37 +188,25 @@ void AbstractCiphertext::debugPrint(const string& title,
 void AbstractCiphertext::addScalar(int scalar)
 {
   HELAYERS_TIMER_SECTION("AbstractCiphertext::addScalar(int)");
-  shared_ptr<AbstractEncoder> encoder = he.getEncoder();
-  shared_ptr<AbstractPlaintext> pt = he.createAbstractPlain();
-  encoder->encode(*pt, scalar, getChainIndex());
-  addPlain(*pt);
+  addPlain(*he.getPTileCache().getScalar(scalar, getChainIndex()));
 }
 
 void AbstractCiphertext::addScalar(double scalar)
 {
   HELAYERS_TIMER_SECTION("AbstractCiphertext::addScalar(double)");
-  shared_ptr<AbstractEncoder> encoder = he.getEncoder();
-  shared_ptr<AbstractPlaintext> pt = he.createAbstractPlain();
-  encoder->encode(*pt, scalar, getChainIndex());
-  addPlain(*pt);
+  addPlain(*he.getPTileCache().getScalar(scalar, getChainIndex()));
 }
 
 void AbstractCiphertext::multiplyScalar(int scalar)
 {
   HELAYERS_TIMER_SECTION("AbstractCiphertext::multiplyScalar(int)");
-  shared_ptr<AbstractEncoder> encoder = he.getEncoder();
-  shared_ptr<AbstractPlaintext> pt = he.createAbstractPlain();
-  encoder->encode(*pt, scalar, getChainIndex());
-  multiplyPlain(*pt);
+  multiplyPlain(*he.getPTileCache().getScalar(scalar, getChainIndex()));
 }
 
 void AbstractCiphertext::multiplyScalar(double scalar)
 {
   HELAYERS_TIMER_SECTION("AbstractCiphertext::multiplyScalar(double)");
-  shared_ptr<AbstractEncoder> encoder = he.getEncoder();
-  shared_ptr<AbstractPlaintext> pt = he.createAbstractPlain();
-  encoder->encode(*pt, scalar, getChainIndex());
-  multiplyPlain(*pt);
+  multiplyPlain(*he.getPTileCache().getScalar(scalar, getChainIndex()));
 }
 
 void AbstractCiphertext::rescaleRaw() { rescale(); }
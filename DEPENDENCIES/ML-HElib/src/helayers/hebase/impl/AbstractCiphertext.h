@@ -61,6 +61,10 @@ public:
     return std::static_pointer_cast<AbstractCiphertext>(doClone());
   }
 
+  // overwrites this ciphertext with the contents of src, reusing the storage
+  // already allocated by this object where possible.
+  virtual void copyFrom(const AbstractCiphertext& src) = 0;
+
   inline HeContext& getContext() { return he; }
 
   inline const HeContext& getContext() const { return he; }
@@ -124,6 +128,12 @@ public:
   // rotate left
   virtual void rotate(int n) = 0;
 
+  // returns a rotated copy of this ciphertext for each of the given offsets.
+  // the default rotates a separate clone per offset. backends may override it
+  // to share key switching work between the rotations.
+  virtual std::vector<std::shared_ptr<AbstractCiphertext>> rotateMany(
+      const std::vector<int>& ns) const;
+
   // inner sum of 0..n-1, cyclic
   // todo: rename sum
   virtual void innerSum(int n);
@@ -148,6 +158,10 @@ public:
   ///       work in general settings.
   virtual void remod(int chainIndex = -1);
 
+  // reduces the ciphertext to the smallest modulus that still allows
+  // decrypting it. ignored if not supported.
+  virtual void compact();
+
   virtual int slotCount() const = 0;
 
   virtual void debugPrint(const std::string& title = "",
@@ -22,6 +22,7 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include "AbstractEncoder.h"
 
 using namespace std;
@@ -124,6 +125,89 @@ void AbstractEncoder::encode(AbstractPlaintext& res,
   encode(res, castVector<long, double>(vals), chainIndex);
 }
 
+// below are default implementations of the buffer based variants, which
+// go through the vector based ones. Concrete encoders should override them
+// to read and write slots directly.
+
+// Copies a buffer into a vector for the vector based variants. Like Encoder
+// does for vectors, it is zero padded to the number of slots unless the
+// context is a debug one with empty objects.
+template <typename T, typename Object>
+static vector<T> toSlots(const T* vals, int size, Object& res)
+{
+  vector<T> slots(vals, vals + size);
+  if (!res.getContext().getTraits().getIsDebugEmpty())
+    slots.resize(res.slotCount(), 0);
+  return slots;
+}
+
+void AbstractEncoder::encode(AbstractPlaintext& res,
+                             const double* vals,
+                             int size,
+                             int chainIndex) const
+{
+  encode(res, toSlots(vals, size, res), chainIndex);
+}
+
+void AbstractEncoder::encode(AbstractPlaintext& res,
+                             const complex<double>* vals,
+                             int size,
+                             int chainIndex) const
+{
+  encode(res, toSlots(vals, size, res), chainIndex);
+}
+
+// plaintexts of schemes without a separate prepared form are used as is
+void AbstractEncoder::prepare(AbstractPlaintext& res) const {}
+
+void AbstractEncoder::decodeDouble(const AbstractPlaintext& src,
+                                   double* out,
+                                   int size) const
+{
+  vector<double> vals = decodeDouble(src);
+  copy(vals.begin(), vals.begin() + size, out);
+}
+
+void AbstractEncoder::decodeComplex(const AbstractPlaintext& src,
+                                    complex<double>* out,
+                                    int size) const
+{
+  vector<complex<double>> vals = decodeComplex(src);
+  copy(vals.begin(), vals.begin() + size, out);
+}
+
+void AbstractEncoder::encodeEncrypt(AbstractCiphertext& res,
+                                    const double* vals,
+                                    int size,
+                                    int chainIndex) const
+{
+  encodeEncrypt(res, toSlots(vals, size, res), chainIndex);
+}
+
+void AbstractEncoder::encodeEncrypt(AbstractCiphertext& res,
+                                    const complex<double>* vals,
+                                    int size,
+                                    int chainIndex) const
+{
+  encodeEncrypt(res, toSlots(vals, size, res), chainIndex);
+}
+
+void AbstractEncoder::decryptDecodeDouble(const AbstractCiphertext& src,
+                                          double* out,
+                                          int size) const
+{
+  vector<double> vals = decryptDecodeDouble(src);
+  copy(vals.begin(), vals.begin() + size, out);
+}
+
+void AbstractEncoder::decryptDecodeComplex(const AbstractCiphertext& src,
+                                           complex<double>* out,
+                                           int size) const
+{
+  vector<complex<double>> vals = decryptDecodeComplex(src);
+  copy(vals.begin(), vals.begin() + size, out);
+}
+
 vector<int> AbstractEncoder::decodeInt(const AbstractPlaintext& src) const
 {
   return roundAndCastVector<int>(decodeDouble(src));
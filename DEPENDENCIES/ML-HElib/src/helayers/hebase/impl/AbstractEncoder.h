@@ -77,6 +77,19 @@ public:
                       const std::vector<std::complex<double>>& vals,
                       int chainIndex) const = 0;
 
+  // encode from a caller buffer of "size" values, zero padding the rest
+  virtual void encode(AbstractPlaintext& res,
+                      const double* vals,
+                      int size,
+                      int chainIndex) const;
+  virtual void encode(AbstractPlaintext& res,
+                      const std::complex<double>* vals,
+                      int size,
+                      int chainIndex) const;
+
+  // precompute the form used by ciphertext operations, where applicable
+  virtual void prepare(AbstractPlaintext& res) const;
+
   // decode
   virtual std::vector<int> decodeInt(const AbstractPlaintext& src) const;
   virtual std::vector<long> decodeLong(const AbstractPlaintext& src) const;
@@ -85,6 +98,14 @@ public:
   virtual std::vector<std::complex<double>> decodeComplex(
       const AbstractPlaintext& src) const = 0;
 
+  // decode the first "size" slots into a caller buffer
+  virtual void decodeDouble(const AbstractPlaintext& src,
+                            double* out,
+                            int size) const;
+  virtual void decodeComplex(const AbstractPlaintext& src,
+                             std::complex<double>* out,
+                             int size) const;
+
   // encrypt
   virtual void encrypt(AbstractCiphertext& res,
                        const AbstractPlaintext& src) const = 0;
@@ -106,6 +127,14 @@ public:
   virtual void encodeEncrypt(AbstractCiphertext& res,
                              const std::vector<std::complex<double>>& vals,
                              int chainIndex) const = 0;
+  virtual void encodeEncrypt(AbstractCiphertext& res,
+                             const double* vals,
+                             int size,
+                             int chainIndex) const;
+  virtual void encodeEncrypt(AbstractCiphertext& res,
+                             const std::complex<double>* vals,
+                             int size,
+                             int chainIndex) const;
 
   // decrypt + decode
   virtual std::vector<int> decryptDecodeInt(
@@ -116,6 +145,12 @@ public:
       const AbstractCiphertext& src) const = 0;
   virtual std::vector<std::complex<double>> decryptDecodeComplex(
       const AbstractCiphertext& src) const = 0;
+  virtual void decryptDecodeDouble(const AbstractCiphertext& src,
+                                   double* out,
+                                   int size) const;
+  virtual void decryptDecodeComplex(const AbstractCiphertext& src,
+                                    std::complex<double>* out,
+                                    int size) const;
 
   virtual double assertEquals(const AbstractCiphertext& c,
                               const std::string& title,
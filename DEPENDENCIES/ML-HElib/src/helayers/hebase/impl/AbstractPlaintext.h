@@ -78,6 +78,8 @@ public:
 
   virtual int slotCount() const = 0;
 
+  virtual bool isPrepared() const { return false; }
+
   virtual void debugPrint(const std::string& title = "",
                           int maxElements = -1,
                           int verbose = 0,
@@ -23,6 +23,10 @@
  */
 
 #include <vector>
+#include <sstream>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include "BinIoUtils.h"
 
 using namespace std;
@@ -128,4 +132,36 @@ bool BinIoUtils::readBool(std::istream& in)
   in.read(reinterpret_cast<char*>(&val), sizeof(bool));
   return val;
 }
+streamoff BinIoUtils::writeCompressed(ostream& out, const string& data)
+{
+  ostringstream compressed;
+  {
+    boost::iostreams::filtering_ostream zout;
+    zout.push(boost::iostreams::zlib_compressor(
+        boost::iostreams::zlib::best_speed));
+    zout.push(compressed);
+    zout.write(data.data(), data.size());
+  }
+  const string& buf = compressed.str();
+  writeSizeT(out, buf.size());
+  out.write(buf.data(), buf.size());
+  return sizeof(size_t) + buf.size();
+}
+
+string BinIoUtils::readCompressed(istream& in)
+{
+  size_t sz = readSizeT(in);
+  string buf(sz, '\0');
+  in.read(&buf[0], sz);
+  if (in.gcount() != (streamsize)sz)
+    throw runtime_error("Unexpected end of compressed data");
+
+  istringstream compressed(buf);
+  ostringstream res;
+  boost::iostreams::filtering_istream zin;
+  zin.push(boost::iostreams::zlib_decompressor());
+  zin.push(compressed);
+  boost::iostreams::copy(zin, res);
+  return res.str();
+}
 } // namespace helayers
\ No newline at end of file
@@ -143,6 +143,20 @@ public:
   {
     return static_cast<T>(readInt(in));
   }
+
+  ///@brief Compresses a buffer with zlib and writes it to a binary stream,
+  /// prefixed by its compressed length.
+  ///
+  ///@param out Stream to write to
+  ///@param data The buffer to compress
+  ///@return Number of bytes written
+  static std::streamoff writeCompressed(std::ostream& out,
+                                        const std::string& data);
+
+  ///@brief Returns a buffer written by writeCompressed(), decompressed.
+  ///
+  ///@param in Stream to read from
+  static std::string readCompressed(std::istream& in);
 };
 } // namespace helayers
 
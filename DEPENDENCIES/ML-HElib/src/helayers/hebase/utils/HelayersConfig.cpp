@@ -65,4 +65,12 @@ std::string getResourcesDir()
     return "../resources";
   return val;
 }
+
+std::string getCacheDir()
+{
+  char* val = std::getenv("HELAYERS_CACHE_DIR");
+  if (val == NULL)
+    return "./cache";
+  return val;
+}
 } // namespace helayers
@@ -56,5 +56,11 @@ std::string getTestsOutputDir();
 // located. Default is "../resources" Can be overridden using environment
 // variable HELAYERS_RESOURCES_DIR
 std::string getResourcesDir();
+
+// Returns directory where results that are expensive to compute, such as
+// estimated latencies of HE operations, are kept between runs.
+// Default is "./cache"
+// Can be overridden using environment variable HELAYERS_CACHE_DIR
+std::string getCacheDir();
 } // namespace helayers
 #endif
\ No newline at end of file
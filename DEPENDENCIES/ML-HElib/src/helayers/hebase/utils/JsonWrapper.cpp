@@ -32,6 +32,20 @@ using namespace std;
 
 namespace helayers {
 
+// Returns a path holding the given keys as is. Keys can't contain the null
+// character, so it is used as the separator.
+static boost::property_tree::ptree::path_type toPath(
+    const vector<string>& keys)
+{
+  string res;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (i > 0)
+      res += '\0';
+    res += keys[i];
+  }
+  return boost::property_tree::ptree::path_type(res, '\0');
+}
+
 JsonWrapper::~JsonWrapper() { clear(); }
 
 void JsonWrapper::init()
@@ -84,6 +98,18 @@ int JsonWrapper::getInt(const string& key) const
   return pt->get<int>(key);
 }
 
+int64_t JsonWrapper::getInt64(const string& key) const
+{
+  assertInitialized();
+  return pt->get<int64_t>(key);
+}
+
+int64_t JsonWrapper::getInt64ByPath(const vector<string>& path) const
+{
+  assertInitialized();
+  return pt->get<int64_t>(toPath(path));
+}
+
 double JsonWrapper::getDouble(const string& key) const
 {
   assertInitialized();
@@ -102,6 +128,18 @@ void JsonWrapper::setInt(const string& key, int value)
   pt->put<int>(key, value);
 }
 
+void JsonWrapper::setInt64(const string& key, int64_t value)
+{
+  assertInitialized();
+  pt->put<int64_t>(key, value);
+}
+
+void JsonWrapper::setInt64ByPath(const vector<string>& path, int64_t value)
+{
+  assertInitialized();
+  pt->put<int64_t>(toPath(path), value);
+}
+
 void JsonWrapper::setDouble(const string& key, double value)
 {
   assertInitialized();
@@ -29,8 +29,10 @@
 #ifndef SRC_HELAYERS_JSONWRAPPER_H
 #define SRC_HELAYERS_JSONWRAPPER_H
 
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
@@ -91,6 +93,16 @@ public:
   /// @param[in] key key name or path delimited by .
   int getInt(const std::string& key) const;
 
+  /// Retrieves a 64 bit integer value by key name, or a path containing
+  /// several keys delimited by .
+  /// @param[in] key key name or path delimited by .
+  std::int64_t getInt64(const std::string& key) const;
+
+  /// Retrieves a 64 bit integer value by a path given as a list of keys,
+  /// which may contain dots.
+  /// @param[in] path keys of the path
+  std::int64_t getInt64ByPath(const std::vector<std::string>& path) const;
+
   /// Retrieves an double value by key name, or a path containing
   /// several keys delimited by .
   /// @param[in] key key name or path delimited by .
@@ -108,6 +120,19 @@ public:
   /// @param[in] value the integer value to put under the given key
   void setInt(const std::string& key, int value);
 
+  /// Sets a 64 bit integer value into a key name, or a path containing
+  /// several keys delimited by .
+  /// @param[in] key key name or path delimited by .
+  /// @param[in] value the integer value to put under the given key
+  void setInt64(const std::string& key, std::int64_t value);
+
+  /// Sets a 64 bit integer value by a path given as a list of keys, which
+  /// may contain dots.
+  /// @param[in] path keys of the path
+  /// @param[in] value the integer value to put under the given path
+  void setInt64ByPath(const std::vector<std::string>& path,
+                      std::int64_t value);
+
   /// Sets a double value into a key name, or a path containing several keys
   /// delimited by .
   /// @param[in] key key name or path delimited by .
@@ -23,7 +23,9 @@
  */
 
 #include <fstream>
+#include <sstream>
 #include "Saveable.h"
+#include "BinIoUtils.h"
 
 using namespace std;
 
@@ -37,10 +39,11 @@ std::ofstream Saveable::openOfstream(const std::string& fileName)
   return out;
 }
 
-std::streamoff Saveable::saveToFile(const std::string& fileName) const
+std::streamoff Saveable::saveToFile(const std::string& fileName,
+                                   bool compressed) const
 {
   ofstream out = openOfstream(fileName);
-  streamoff offset = save(out);
+  streamoff offset = compressed ? saveCompressed(out) : save(out);
   out.close();
   return offset;
 }
@@ -55,10 +58,26 @@ std::ifstream Saveable::openIfstream(const std::string& fileName)
   return in;
 }
 
-std::streamoff Saveable::loadFromFile(const std::string& fileName)
+std::streamoff Saveable::loadFromFile(const std::string& fileName,
+                                     bool compressed)
 {
   ifstream in = openIfstream(fileName);
-  streamoff offset = load(in);
+  streamoff offset = compressed ? loadCompressed(in) : load(in);
   in.close();
   return offset;
-}
\ No newline at end of file
+}
+
+std::streamoff Saveable::saveCompressed(std::ostream& stream) const
+{
+  ostringstream raw;
+  save(raw);
+  return helayers::BinIoUtils::writeCompressed(stream, raw.str());
+}
+
+std::streamoff Saveable::loadCompressed(std::istream& stream)
+{
+  streampos streamStartPos = stream.tellg();
+  istringstream raw(helayers::BinIoUtils::readCompressed(stream));
+  load(raw);
+  return stream.tellg() - streamStartPos;
+}
@@ -38,12 +38,30 @@ public:
   ///  Saves this Saveable object to a file in binary form.
   ///
   ///  @param[in] fileName name of file to write to
-  std::streamoff saveToFile(const std::string& fileName) const;
+  ///  @param[in] compressed whether to compress the data (see
+  ///                        saveCompressed())
+  std::streamoff saveToFile(const std::string& fileName,
+                            bool compressed = false) const;
 
   ///  Loads this Saveable object from a file saved by saveToFile()
   ///
   ///  @param[in] fileName name of file to read from
-  std::streamoff loadFromFile(const std::string& fileName);
+  ///  @param[in] compressed must match the value used when saving
+  std::streamoff loadFromFile(const std::string& fileName,
+                              bool compressed = false);
+
+  ///  Saves this Saveable object to a stream in compressed binary form.
+  ///  The output of save() is compressed with zlib. Returns the number of
+  ///  bytes written.
+  ///
+  ///  @param[in] stream output stream to write to
+  std::streamoff saveCompressed(std::ostream& stream) const;
+
+  ///  Loads this Saveable object from a stream written by saveCompressed().
+  ///  Returns the number of bytes read.
+  ///
+  ///  @param[in] stream input stream to read from
+  std::streamoff loadCompressed(std::istream& stream);
 
   ///  Saves this Saveable object to a stream in binary form.
   ///
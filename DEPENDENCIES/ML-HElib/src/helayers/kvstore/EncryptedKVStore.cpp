@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <exception>
+#include "EncryptedKVStore.h"
+
+using namespace std;
+
+namespace helayers {
+
+EncryptedKVStore::EncryptedKVStore(HeContext& he)
+    : he(he), enc(he), segmentStarts(he)
+{
+  if (!he.getTraits().getIsModularArithmetic())
+    throw invalid_argument("EncryptedKVStore requires modular arithmetic");
+}
+
+EncryptedKVStore::~EncryptedKVStore() {}
+
+vector<int> EncryptedKVStore::pack(const vector<string>& strs) const
+{
+  vector<int> res(entriesPerCiphertext * entryWidth, 0);
+  for (size_t e = 0; e < strs.size(); ++e)
+    for (size_t k = 0; k < strs[e].size(); ++k)
+      res[e * entryWidth + k] = (unsigned char)strs[e][k];
+  return res;
+}
+
+void EncryptedKVStore::encrypt(const vector<pair<string, string>>& entries,
+                               int minEntryWidth)
+{
+  HELAYERS_TIMER_SECTION("EncryptedKVStore::encrypt");
+
+  long modulus = he.getTraits().getArithmeticModulus();
+  int maxLen = max(minEntryWidth, 1);
+  for (const auto& entry : entries) {
+    for (const string& str : {entry.first, entry.second}) {
+      for (char c : str)
+        if ((unsigned char)c >= modulus)
+          throw invalid_argument("Character code of " + str +
+                                 " is not below the modulus");
+      maxLen = max(maxLen, (int)str.size());
+    }
+  }
+
+  entryWidth = 1;
+  while (entryWidth < maxLen)
+    entryWidth *= 2;
+  if (entryWidth > he.slotCount())
+    throw invalid_argument("Entries of width " + to_string(entryWidth) +
+                           " do not fit in " + to_string(he.slotCount()) +
+                           " slots");
+  // A power of 2 number of entries lets lookup() gather the segments with
+  // a logarithmic number of rotations.
+  entriesPerCiphertext = 1;
+  while (entriesPerCiphertext * 2 * entryWidth <= he.slotCount())
+    entriesPerCiphertext *= 2;
+
+  numEntries = entries.size();
+  int numCiphertexts =
+      (numEntries + entriesPerCiphertext - 1) / entriesPerCiphertext;
+  keys.assign(numCiphertexts, CTile(he));
+  values.assign(numCiphertexts, CTile(he));
+
+  // Exceptions must not escape the parallel region, so the first one is kept
+  // and rethrown after the loop.
+  exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < numCiphertexts; ++i) {
+    try {
+      vector<string> blockKeys, blockValues;
+      for (int e = i * entriesPerCiphertext;
+           e < min(numEntries, (i + 1) * entriesPerCiphertext);
+           ++e) {
+        blockKeys.push_back(entries[e].first);
+        blockValues.push_back(entries[e].second);
+      }
+      enc.encodeEncrypt(keys[i], pack(blockKeys));
+      enc.encodeEncrypt(values[i], pack(blockValues));
+    } catch (...) {
+#pragma omp critical
+      if (!error)
+        error = current_exception();
+    }
+  }
+  if (error)
+    rethrow_exception(error);
+
+  vector<int> starts(entriesPerCiphertext * entryWidth, 0);
+  for (int e = 0; e < entriesPerCiphertext; ++e)
+    starts[e * entryWidth] = 1;
+  enc.encode(segmentStarts, starts);
+}
+
+CTile EncryptedKVStore::encryptQuery(const string& key) const
+{
+  if ((int)key.size() > entryWidth)
+    throw invalid_argument("Key " + key + " is longer than entry width " +
+                           to_string(entryWidth));
+  CTile res(he);
+  enc.encodeEncrypt(res, pack(vector<string>(entriesPerCiphertext, key)));
+  return res;
+}
+
+CTile EncryptedKVStore::lookupMask(const CTile& query, int index) const
+{
+  NativeFunctionEvaluator eval(he);
+  long modulus = he.getTraits().getArithmeticModulus();
+
+  // 1 in slots where the key and query characters are equal, 0 elsewhere.
+  CTile mask = keys[index];
+  mask.sub(query);
+  eval.powerInPlace(mask, modulus - 1);
+  mask.negate();
+  mask.addScalar(1);
+
+  // Each slot becomes the product of the entryWidth slots starting at it,
+  // so the first slot of a segment is 1 exactly when its whole key matches.
+  CTilePool& pool = he.getCTilePool();
+  for (int rot = 1; rot < entryWidth; rot *= 2) {
+    CTile tmp = pool.copyOf(mask);
+    tmp.rotate(rot);
+    mask.multiply(tmp);
+  }
+
+  // Keep only the first slot of each segment and spread it over the segment.
+  mask.multiplyPlain(segmentStarts);
+  mask.innerSum(1, entryWidth, true);
+  return mask;
+}
+
+CTile EncryptedKVStore::lookup(const CTile& query) const
+{
+  HELAYERS_TIMER_SECTION("EncryptedKVStore::lookup");
+  if (keys.empty())
+    throw runtime_error("EncryptedKVStore is empty");
+
+  vector<CTile> masks(keys.size(), CTile(he));
+  exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < keys.size(); ++i) {
+    try {
+      masks[i] = lookupMask(query, i);
+    } catch (...) {
+#pragma omp critical
+      if (!error)
+        error = current_exception();
+    }
+  }
+  if (error)
+    rethrow_exception(error);
+
+  CTile res = CTile::dotProduct(masks, values);
+
+  // At most one segment is non-zero; gather all segments into the first.
+  res.innerSum(entryWidth, entriesPerCiphertext * entryWidth);
+  return res;
+}
+
+string EncryptedKVStore::decryptResult(const CTile& result) const
+{
+  vector<int> codes = enc.decryptDecodeInt(result);
+  string res;
+  for (int k = 0; k < entryWidth && codes[k] != 0; ++k)
+    res.push_back(codes[k]);
+  return res;
+}
+} // namespace helayers
@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_ENCRYPTEDKVSTORE_H
+#define SRC_HELAYERS_ENCRYPTEDKVSTORE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "helayers/hebase/hebase.h"
+
+namespace helayers {
+
+/** An encrypted key-value store supporting private lookups.
+ *
+ * Requires a context with modular arithmetic, such as BGV, whose modulus is
+ * larger than the character codes of all keys, values and queries.
+ *
+ * Keys and values are strings, stored as their character codes. Entries are
+ * packed side by side in the slots of their ciphertexts, each entry taking a
+ * fixed width segment. A query is encrypted once per segment, so a single
+ * comparison checks it against all the keys of a ciphertext. Matching uses
+ * Fermat's little theorem: (key-query)^(p-1) is 0 where characters are equal
+ * and 1 elsewhere. The result of a lookup is the value of the matching entry,
+ * or an empty string if there is none.
+ */
+class EncryptedKVStore
+{
+  HeContext& he;
+
+  Encoder enc;
+
+  int entryWidth = 0;
+
+  int entriesPerCiphertext = 0;
+
+  int numEntries = 0;
+
+  std::vector<CTile> keys;
+
+  std::vector<CTile> values;
+
+  // 1 in the first slot of each segment and 0 elsewhere, encoded once and
+  // reused by all lookups.
+  PTile segmentStarts;
+
+  std::vector<int> pack(const std::vector<std::string>& strs) const;
+
+  CTile lookupMask(const CTile& query, int index) const;
+
+public:
+  /// Constructs an empty store.
+  /// @param[in] he the underlying context.
+  /// @throw invalid_argument if the context does not support modular
+  ///                         arithmetic.
+  EncryptedKVStore(HeContext& he);
+
+  ~EncryptedKVStore();
+
+  /// Copy constructor deleted.
+  EncryptedKVStore(const EncryptedKVStore& src) = delete;
+
+  /// Assignment deleted.
+  EncryptedKVStore& operator=(const EncryptedKVStore& src) = delete;
+
+  /// Encrypts the given entries into this store, replacing its content.
+  /// Keys are expected to be unique.
+  /// @param[in] entries pairs of key and value
+  /// @param[in] minEntryWidth minimal number of slots per entry. The actual
+  ///                          width is the smallest power of 2 that fits this
+  ///                          value and all keys and values.
+  /// @throw invalid_argument if an entry does not fit in the slots, or has a
+  ///                         character code not below the modulus.
+  void encrypt(const std::vector<std::pair<std::string, std::string>>& entries,
+               int minEntryWidth = 1);
+
+  /// Encrypts a key to look up in this store.
+  /// @param[in] key key to look for
+  /// @throw invalid_argument if key is longer than the entry width.
+  CTile encryptQuery(const std::string& key) const;
+
+  /// Looks up an encrypted query. The ciphertexts of the store are searched
+  /// in parallel.
+  /// @param[in] query query returned by encryptQuery()
+  /// @throw runtime_error if the store is empty.
+  CTile lookup(const CTile& query) const;
+
+  /// Decrypts the result of lookup().
+  /// @param[in] result result of lookup()
+  std::string decryptResult(const CTile& result) const;
+
+  /// Returns the number of entries in this store.
+  int getNumEntries() const { return numEntries; }
+
+  /// Returns the number of slots taken by each entry.
+  int getEntryWidth() const { return entryWidth; }
+
+  /// Returns the number of entries packed in each ciphertext.
+  int getEntriesPerCiphertext() const { return entriesPerCiphertext; }
+
+  /// Returns the number of ciphertexts holding keys. The values are held in
+  /// the same number of ciphertexts.
+  int getNumCiphertexts() const { return keys.size(); }
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_ENCRYPTEDKVSTORE_H */
@@ -22,13 +22,17 @@
  * SOFTWARE.
  */
 
+#include <omp.h>
 #include "CipherMatrix.h"
+#include "EncodedMatrix.h"
 
 using namespace std;
 using namespace boost::numeric::ublas;
 
 namespace helayers {
 
+int CipherMatrix::numThreads = 0;
+
 CipherMatrix::CipherMatrix(HeContext& he) : he(&he), numFilledSlots(0) {}
 
 CipherMatrix::~CipherMatrix() {}
@@ -90,10 +94,27 @@ void CipherMatrix::add(const CipherMatrix& other)
       numFilledSlots != other.numFilledSlots)
     throw invalid_argument("Other has incompatible dimensions");
 
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
   for (size_t i = 0; i < tiles.size(); ++i)
     tiles[i].add(other.tiles[i]);
 }
 
+void CipherMatrix::addPlain(const EncodedMatrix& other)
+{
+  HELAYERS_TIMER_SECTION("CipherMatrix::addPlain");
+
+  if (tiles.size(0) != other.tiles.size(0) ||
+      tiles.size(1) != other.tiles.size(1) ||
+      numFilledSlots != other.numFilledSlots)
+    throw invalid_argument("Other has incompatible dimensions");
+
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < tiles.size(); ++i)
+    tiles[i].addPlain(other.tiles[i]);
+}
+
 CipherMatrix CipherMatrix::getMatrixMultiply(const CipherMatrix& other) const
 {
   HELAYERS_TIMER_SECTION("CipherMatrix::getMatrixMultiply");
@@ -102,28 +123,48 @@ CipherMatrix CipherMatrix::getMatrixMultiply(const CipherMatrix& other) const
       numFilledSlots != other.numFilledSlots)
     throw invalid_argument("Other has incompatible dimensions");
 
+  // Input tiles are shared between threads below, so any deferred
+  // maintenance on them must be done beforehand, on copies since the inputs
+  // are const.
+  if (hasPendingMaintenance()) {
+    CipherMatrix maintained(*this);
+    maintained.flushMaintenance();
+    return maintained.getMatrixMultiply(other);
+  }
+  if (other.hasPendingMaintenance()) {
+    CipherMatrix maintained(other);
+    maintained.flushMaintenance();
+    return getMatrixMultiply(maintained);
+  }
+
   basic_extents<size_t> extents(
       std::vector<size_t>{tiles.size(0), other.tiles.size(1)});
   tensor<CTile> newTiles(extents, CTile(*he));
 
-  for (size_t i = 0; i < newTiles.size(0); i++) {
-    for (size_t j = 0; j < newTiles.size(1); j++) {
-      for (size_t k = 0; k < tiles.size(1); k++) {
-        CTile tmp(tiles.at(i, k));
-        tmp.multiplyRaw(other.tiles.at(k, j));
-        if (k == 0)
-          newTiles.at(i, j) = tmp;
-        else
-          newTiles.at(i, j).add(tmp);
+  size_t numRows = newTiles.size(0);
+  size_t numCols = newTiles.size(1);
+  size_t innerDim = tiles.size(1);
+
+  // Output tiles are independent. The k-reduction of each one runs in a
+  // fixed order within a single thread, keeping results deterministic. Each
+  // thread computes its products in a single buffer.
+  int n = getNumThreads();
+#pragma omp parallel num_threads(n)
+  {
+    CTile buffer(*he);
+#pragma omp for collapse(2) schedule(dynamic)
+    for (size_t i = 0; i < numRows; i++) {
+      for (size_t j = 0; j < numCols; j++) {
+        CTile& out = newTiles.at(i, j);
+        for (size_t k = 0; k < innerDim; k++)
+          out.multiplyAdd(tiles.at(i, k), other.tiles.at(k, j), buffer);
       }
     }
   }
 
   CipherMatrix res(*he);
-  res.tiles = newTiles;
+  res.tiles = std::move(newTiles);
   res.numFilledSlots = numFilledSlots;
-  res.relinearize();
-  res.rescale();
 
   return res;
 }
@@ -132,8 +173,13 @@ void CipherMatrix::square()
 {
   HELAYERS_TIMER_SECTION("CipherMatrix::square");
 
-  for (auto& tile : tiles)
-    tile.square();
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    tiles[i].squareRaw();
+    tiles[i].relinearizeLazy();
+    tiles[i].rescaleLazy();
+  }
 }
 
 CipherMatrix CipherMatrix::getSquare() const
@@ -147,16 +193,46 @@ void CipherMatrix::relinearize()
 {
   HELAYERS_TIMER_SECTION("CipherMatrix::relinearize");
 
-  for (auto& tile : tiles)
-    tile.relinearize();
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < tiles.size(); ++i)
+    tiles[i].relinearize();
 }
 
 void CipherMatrix::rescale()
 {
   HELAYERS_TIMER_SECTION("CipherMatrix::rescale");
 
-  for (auto& tile : tiles)
-    tile.rescale();
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < tiles.size(); ++i)
+    tiles[i].rescale();
+}
+
+void CipherMatrix::compact()
+{
+  HELAYERS_TIMER_SECTION("CipherMatrix::compact");
+
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < tiles.size(); ++i)
+    tiles[i].compact();
+}
+
+void CipherMatrix::flushMaintenance()
+{
+  int n = getNumThreads();
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t i = 0; i < tiles.size(); ++i)
+    tiles[i].flushMaintenance();
+}
+
+bool CipherMatrix::hasPendingMaintenance() const
+{
+  for (size_t i = 0; i < tiles.size(); ++i)
+    if (tiles[i].hasPendingMaintenance())
+      return true;
+  return false;
 }
 
 int CipherMatrix::getChainIndex() const
@@ -166,4 +242,16 @@ int CipherMatrix::getChainIndex() const
 
   return tiles(0).getChainIndex();
 }
+
+void CipherMatrix::setNumThreads(int n)
+{
+  if (n < 0)
+    throw invalid_argument("Number of threads must be non-negative");
+  numThreads = n;
+}
+
+int CipherMatrix::getNumThreads()
+{
+  return numThreads == 0 ? omp_get_max_threads() : numThreads;
+}
 } // namespace helayers
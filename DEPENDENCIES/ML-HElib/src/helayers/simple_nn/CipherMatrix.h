@@ -32,6 +32,8 @@
 
 namespace helayers {
 
+class EncodedMatrix;
+
 /// A class for holding a matrix of ciphertexts.
 class CipherMatrix : public Saveable
 {
@@ -42,7 +44,12 @@ class CipherMatrix : public Saveable
 
   int numFilledSlots;
 
+  static int numThreads;
+
   friend class CipherMatrixEncoder;
+  friend class CipherMatrixFileWriter;
+  friend class CipherMatrixFileReader;
+  friend class EncodedMatrix;
 
 public:
   /// Construct an empty object.
@@ -52,11 +59,17 @@ public:
   /// Default copy constructor.
   CipherMatrix(const CipherMatrix& src) = default;
 
+  /// Default move constructor.
+  CipherMatrix(CipherMatrix&& src) = default;
+
   ~CipherMatrix();
 
   /// Default assignment operator.
   CipherMatrix& operator=(const CipherMatrix& src) = default;
 
+  /// Default move assignment operator.
+  CipherMatrix& operator=(CipherMatrix&& src) = default;
+
   /// Save object to binary stream.
   /// @param[in] stream output stream to write to
   std::streamoff save(std::ostream& stream) const override;
@@ -69,11 +82,18 @@ public:
   /// @param[in] other matrix to add to
   void add(const CipherMatrix& other);
 
-  /// Returns a CipherMatrix containing the matrixmultiplication result
+  /// Elementwise add an encoded matrix.
+  /// @param[in] other matrix to add to
+  void addPlain(const EncodedMatrix& other);
+
+  /// Returns a CipherMatrix containing the matrixmultiplication result.
+  /// Relinearization and rescale of the result are deferred until required
+  /// (see CTile::relinearizeLazy()).
   /// @param[in] other matrix to multiply with
   CipherMatrix getMatrixMultiply(const CipherMatrix& other) const;
 
   /// Elementwise square.
+  /// Relinearization and rescale are deferred as in getMatrixMultiply().
   void square();
 
   /// Returns a copy of this matrix with elementwise square applied.
@@ -85,8 +105,36 @@ public:
   /// Rescale all ciphertexts.
   void rescale();
 
+  /// Compacts all ciphertexts before saving. See CTile::compact().
+  void compact();
+
+  /// Performs deferred relinearize and rescale operations on all ciphertexts.
+  void flushMaintenance();
+
+  /// Returns true if deferred operations are pending on some ciphertext.
+  bool hasPendingMaintenance() const;
+
   /// Returns the current chain index of ciphertexts.
   int getChainIndex() const;
+
+  /// Returns the number of tile rows.
+  size_t getNumRows() const { return tiles.rank() < 1 ? 0 : tiles.size(0); }
+
+  /// Returns the number of tile columns.
+  size_t getNumCols() const { return tiles.rank() < 2 ? 0 : tiles.size(1); }
+
+  /// Returns the number of meaningful slots in each tile.
+  int getNumFilledSlots() const { return numFilledSlots; }
+
+  /// Sets the number of threads used for tile-level operations.
+  /// Each output tile is computed by a single thread in a fixed order, so
+  /// results do not depend on this value.
+  /// @param[in] n number of threads. 0 means use OpenMP's default, 1 means
+  ///              run serially.
+  static void setNumThreads(int n);
+
+  /// Returns the number of threads used for tile-level operations.
+  static int getNumThreads();
 };
 } // namespace helayers
 
@@ -22,6 +22,7 @@
  * SOFTWARE.
  */
 
+#include <exception>
 #include "CipherMatrixEncoder.h"
 
 using namespace std;
@@ -44,6 +45,9 @@ void CipherMatrixEncoder::encodeEncrypt(CipherMatrix& res,
   if (vals.size(2) > he.slotCount())
     throw invalid_argument(
         "Input has depth higher than the number of slots in CTile");
+  // Exceptions must not escape the parallel region below, so the chain index
+  // is validated here, and any other error is rethrown after the loop.
+  enc.validateChainIndex(chainIndex);
 
   size_t numRows = vals.size(0);
   size_t numCols = vals.size(1);
@@ -53,14 +57,165 @@ void CipherMatrixEncoder::encodeEncrypt(CipherMatrix& res,
       (long unsigned int)numRows, (long unsigned int)numCols});
   res.tiles = tensor<CTile>(extents, CTile(he));
 
-  for (size_t i = 0; i < numRows; i++) {
-    for (size_t j = 0; j < numCols; j++) {
-      std::vector<double> currentTileVals;
-      for (int k = 0; k < he.slotCount(); k++)
-        currentTileVals.push_back(k < numFilledSlots ? vals.at(i, j, k) : 0);
-      enc.encodeEncrypt(res.tiles.at(i, j), currentTileVals, chainIndex);
+  // Tiles are encrypted concurrently, each thread reusing a single buffer
+  // of the filled slots. The encoder zero pads the rest.
+  int numTiles = numRows * numCols;
+  int n = CipherMatrix::getNumThreads();
+  exception_ptr error;
+#pragma omp parallel num_threads(n)
+  {
+    std::vector<double> currentTileVals(numFilledSlots);
+#pragma omp for schedule(dynamic)
+    for (int t = 0; t < numTiles; t++) {
+      size_t i = t / numCols;
+      size_t j = t % numCols;
+      for (size_t k = 0; k < numFilledSlots; k++)
+        currentTileVals[k] = vals.at(i, j, k);
+      try {
+        enc.encodeEncrypt(res.tiles.at(i, j),
+                          currentTileVals.data(),
+                          numFilledSlots,
+                          chainIndex);
+      } catch (...) {
+#pragma omp critical
+        if (!error)
+          error = current_exception();
+      }
     }
   }
+  if (error)
+    rethrow_exception(error);
+
+  res.numFilledSlots = numFilledSlots;
+}
+
+void CipherMatrixEncoder::encode(EncodedMatrix& res,
+                                 const tensor<double>& vals,
+                                 int chainIndex) const
+{
+  HELAYERS_TIMER_SECTION("CipherMatrixEncoder::encode");
+
+  if (vals.order() != 3)
+    throw invalid_argument("Input must be 3-dimensional tensor");
+  if (vals.size(2) > he.slotCount())
+    throw invalid_argument(
+        "Input has depth higher than the number of slots in PTile");
+  enc.validateChainIndex(chainIndex);
+
+  size_t numRows = vals.size(0);
+  size_t numCols = vals.size(1);
+  size_t numFilledSlots = vals.size(2);
+
+  basic_extents<size_t> extents(std::vector<size_t>{
+      (long unsigned int)numRows, (long unsigned int)numCols});
+  res.tiles = tensor<PTile>(extents, PTile(he));
+
+  int numTiles = numRows * numCols;
+  int n = CipherMatrix::getNumThreads();
+  exception_ptr error;
+#pragma omp parallel num_threads(n)
+  {
+    std::vector<double> currentTileVals(numFilledSlots);
+#pragma omp for schedule(dynamic)
+    for (int t = 0; t < numTiles; t++) {
+      size_t i = t / numCols;
+      size_t j = t % numCols;
+      for (size_t k = 0; k < numFilledSlots; k++)
+        currentTileVals[k] = vals.at(i, j, k);
+      try {
+        enc.encode(res.tiles.at(i, j),
+                   currentTileVals.data(),
+                   numFilledSlots,
+                   chainIndex);
+      } catch (...) {
+#pragma omp critical
+        if (!error)
+          error = current_exception();
+      }
+    }
+  }
+  if (error)
+    rethrow_exception(error);
+
+  res.numFilledSlots = numFilledSlots;
+}
+
+void CipherMatrixEncoder::encodeEncrypt(CipherMatrix& res,
+                                        const double* vals,
+                                        int numRows,
+                                        int numCols,
+                                        int numFilledSlots,
+                                        int chainIndex) const
+{
+  HELAYERS_TIMER_SECTION("CipherMatrixEncoder::encodeEncrypt");
+
+  if (numFilledSlots > he.slotCount())
+    throw invalid_argument(
+        "Input has depth higher than the number of slots in CTile");
+  enc.validateChainIndex(chainIndex);
+
+  basic_extents<size_t> extents(std::vector<size_t>{
+      (long unsigned int)numRows, (long unsigned int)numCols});
+  res.tiles = tensor<CTile>(extents, CTile(he));
+
+  int numTiles = numRows * numCols;
+  int n = CipherMatrix::getNumThreads();
+  exception_ptr error;
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (int t = 0; t < numTiles; t++) {
+    try {
+      enc.encodeEncrypt(res.tiles.at(t / numCols, t % numCols),
+                        vals + (size_t)t * numFilledSlots,
+                        numFilledSlots,
+                        chainIndex);
+    } catch (...) {
+#pragma omp critical
+      if (!error)
+        error = current_exception();
+    }
+  }
+  if (error)
+    rethrow_exception(error);
+
+  res.numFilledSlots = numFilledSlots;
+}
+
+void CipherMatrixEncoder::encode(EncodedMatrix& res,
+                                 const double* vals,
+                                 int numRows,
+                                 int numCols,
+                                 int numFilledSlots,
+                                 int chainIndex) const
+{
+  HELAYERS_TIMER_SECTION("CipherMatrixEncoder::encode");
+
+  if (numFilledSlots > he.slotCount())
+    throw invalid_argument(
+        "Input has depth higher than the number of slots in PTile");
+  enc.validateChainIndex(chainIndex);
+
+  basic_extents<size_t> extents(std::vector<size_t>{
+      (long unsigned int)numRows, (long unsigned int)numCols});
+  res.tiles = tensor<PTile>(extents, PTile(he));
+
+  int numTiles = numRows * numCols;
+  int n = CipherMatrix::getNumThreads();
+  exception_ptr error;
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (int t = 0; t < numTiles; t++) {
+    try {
+      enc.encode(res.tiles.at(t / numCols, t % numCols),
+                 vals + (size_t)t * numFilledSlots,
+                 numFilledSlots,
+                 chainIndex);
+    } catch (...) {
+#pragma omp critical
+      if (!error)
+        error = current_exception();
+    }
+  }
+  if (error)
+    rethrow_exception(error);
 
   res.numFilledSlots = numFilledSlots;
 }
@@ -85,12 +240,19 @@ tensor<double> CipherMatrixEncoder::decryptDecodeDouble(
                      (long unsigned int)numCols,
                      (long unsigned int)numFilledSlots};
 
-  for (size_t i = 0; i < numRows; i++) {
-    for (size_t j = 0; j < numCols; j++) {
-      std::vector<double> currentTileVals =
-          enc.decryptDecodeDouble(src.tiles.at(i, j));
+  int numTiles = numRows * numCols;
+  int n = CipherMatrix::getNumThreads();
+#pragma omp parallel num_threads(n)
+  {
+    std::vector<double> currentTileVals(numFilledSlots);
+#pragma omp for schedule(dynamic)
+    for (int t = 0; t < numTiles; t++) {
+      size_t i = t / numCols;
+      size_t j = t % numCols;
+      enc.decryptDecodeDouble(
+          src.tiles.at(i, j), currentTileVals.data(), numFilledSlots);
       for (int k = 0; k < numFilledSlots; k++)
-        res.at(i, j, k) = currentTileVals.at(k);
+        res.at(i, j, k) = currentTileVals[k];
     }
   }
   return res;
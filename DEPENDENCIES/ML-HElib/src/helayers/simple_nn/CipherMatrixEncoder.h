@@ -26,6 +26,7 @@
 #define SRC_HELAYERS_CIPHERMATRIXENCODER_H
 
 #include "CipherMatrix.h"
+#include "EncodedMatrix.h"
 #include "helayers/hebase/hebase.h"
 
 namespace helayers {
@@ -40,6 +41,9 @@ namespace helayers {
  *
  * The plain values are represented using boost::numeric::ublas::tensor
  * with element values that are either double or complex.
+ *
+ * Tiles are encrypted and decrypted concurrently, using the number of
+ * threads set by CipherMatrix::setNumThreads().
  */
 class CipherMatrixEncoder
 {
@@ -72,6 +76,47 @@ public:
                      const boost::numeric::ublas::tensor<double>& vals,
                      int chainIndex = -1) const;
 
+  /// Encode a 3d array of doubles without encrypting it.
+  /// @param[out] res object to contain encoded matrix.
+  /// @param[in] vals a 3d tensor to encode
+  /// @param[in] chainIndex optional target chain index
+  void encode(EncodedMatrix& res,
+              const boost::numeric::ublas::tensor<double>& vals,
+              int chainIndex = -1) const;
+
+  /// Encode and encrypt a matrix given in the layout of tile slots: the
+  /// values of the tile at (i, j) are the numFilledSlots doubles starting at
+  /// vals + (i * numCols + j) * numFilledSlots, as read by
+  /// H5Parser::readSlotPacked(). Each slice is encoded in place, without
+  /// gathering it first.
+  /// @param[out] res object to contain encrypted matrix.
+  /// @param[in] vals packed values.
+  /// @param[in] numRows number of rows of tiles
+  /// @param[in] numCols number of columns of tiles
+  /// @param[in] numFilledSlots number of values in each tile
+  /// @param[in] chainIndex optional target chain index
+  void encodeEncrypt(CipherMatrix& res,
+                     const double* vals,
+                     int numRows,
+                     int numCols,
+                     int numFilledSlots,
+                     int chainIndex = -1) const;
+
+  /// Encode a matrix given in the layout of tile slots without encrypting
+  /// it. See encodeEncrypt() for the layout.
+  /// @param[out] res object to contain encoded matrix.
+  /// @param[in] vals packed values.
+  /// @param[in] numRows number of rows of tiles
+  /// @param[in] numCols number of columns of tiles
+  /// @param[in] numFilledSlots number of values in each tile
+  /// @param[in] chainIndex optional target chain index
+  void encode(EncodedMatrix& res,
+              const double* vals,
+              int numRows,
+              int numCols,
+              int numFilledSlots,
+              int chainIndex = -1) const;
+
   /// Encode and encrypt a 3d array of complex numbers.
   /// @param[out] res object to contain encrypted matrix.
   /// @param[in] vals a 3d tensor to encrypt
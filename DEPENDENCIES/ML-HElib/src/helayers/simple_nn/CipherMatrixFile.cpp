@@ -0,0 +1,299 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CipherMatrixFile.h"
+
+using namespace std;
+using namespace boost::numeric::ublas;
+
+namespace helayers {
+
+namespace {
+
+const char fileMagic[4] = {'H', 'L', 'C', 'M'};
+const int32_t fileVersion = 1;
+
+// Header: magic, version, numRows, numCols, numFilledSlots.
+const size_t headerSize =
+    sizeof(fileMagic) + sizeof(int32_t) + 2 * sizeof(uint64_t) +
+    sizeof(int32_t);
+
+// Each index entry holds a tile's offset and length.
+const size_t indexEntrySize = 2 * sizeof(uint64_t);
+
+// Read-only stream buffer over a mapped memory region.
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+  MemoryStreamBuf(const char* begin, size_t len)
+  {
+    char* p = const_cast<char*>(begin);
+    setg(p, p, p + len);
+  }
+
+protected:
+  pos_type seekoff(off_type off,
+                   ios_base::seekdir dir,
+                   ios_base::openmode which) override
+  {
+    char* target;
+    if (dir == ios_base::beg)
+      target = eback() + off;
+    else if (dir == ios_base::cur)
+      target = gptr() + off;
+    else
+      target = egptr() + off;
+    if (target < eback() || target > egptr())
+      return pos_type(off_type(-1));
+    setg(eback(), target, egptr());
+    return pos_type(target - eback());
+  }
+
+  pos_type seekpos(pos_type pos, ios_base::openmode which) override
+  {
+    return seekoff(off_type(pos), ios_base::beg, which);
+  }
+};
+
+template <typename T>
+T readValue(const char* p)
+{
+  T res;
+  memcpy(&res, p, sizeof(T));
+  return res;
+}
+
+} // namespace
+
+CipherMatrixFileWriter::CipherMatrixFileWriter(const string& fileName,
+                                               size_t numRows,
+                                               size_t numCols,
+                                               int numFilledSlots)
+    : out(Saveable::openOfstream(fileName)),
+      fileName(fileName),
+      numRows(numRows),
+      numCols(numCols),
+      index(numRows * numCols, {0, 0})
+{
+  uint64_t rows = numRows;
+  uint64_t cols = numCols;
+  int32_t slots = numFilledSlots;
+  out.write(fileMagic, sizeof(fileMagic));
+  out.write(reinterpret_cast<const char*>(&fileVersion), sizeof(int32_t));
+  out.write(reinterpret_cast<const char*>(&rows), sizeof(uint64_t));
+  out.write(reinterpret_cast<const char*>(&cols), sizeof(uint64_t));
+  out.write(reinterpret_cast<const char*>(&slots), sizeof(int32_t));
+
+  // Reserve room for the index, filled in by close().
+  indexPos = out.tellp();
+  std::vector<char> emptyIndex(index.size() * indexEntrySize, 0);
+  out.write(emptyIndex.data(), emptyIndex.size());
+}
+
+CipherMatrixFileWriter::~CipherMatrixFileWriter()
+{
+  if (out.is_open()) {
+    try {
+      close();
+    } catch (const exception& e) {
+      cerr << "Failed to close " << fileName << ": " << e.what() << endl;
+    }
+  }
+}
+
+void CipherMatrixFileWriter::writeTile(size_t i, size_t j, const CTile& tile)
+{
+  if (i >= numRows || j >= numCols)
+    throw invalid_argument("Tile (" + to_string(i) + "," + to_string(j) +
+                           ") is out of range");
+  pair<uint64_t, uint64_t>& entry = index[i * numCols + j];
+  if (entry.second != 0)
+    throw invalid_argument("Tile (" + to_string(i) + "," + to_string(j) +
+                           ") was already written");
+
+  entry.first = out.tellp();
+  entry.second = tile.save(out);
+}
+
+void CipherMatrixFileWriter::write(const CipherMatrix& src)
+{
+  HELAYERS_TIMER_SECTION("CipherMatrixFileWriter::write");
+  if (src.getNumRows() != numRows || src.getNumCols() != numCols)
+    throw invalid_argument("Matrix dimensions do not match file");
+
+  for (size_t i = 0; i < numRows; i++)
+    for (size_t j = 0; j < numCols; j++)
+      writeTile(i, j, src.tiles.at(i, j));
+}
+
+void CipherMatrixFileWriter::close()
+{
+  for (const auto& entry : index)
+    if (entry.second == 0)
+      throw runtime_error("Not all tiles were written to " + fileName);
+
+  out.seekp(indexPos);
+  for (const auto& entry : index) {
+    out.write(reinterpret_cast<const char*>(&entry.first), sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(&entry.second), sizeof(uint64_t));
+  }
+  out.flush();
+  bool failed = !out.good();
+  out.close();
+  if (failed || out.fail())
+    throw runtime_error("Failed to write " + fileName);
+}
+
+CipherMatrixFileReader::CipherMatrixFileReader(HeContext& he,
+                                               const string& fileName)
+    : he(he), fileName(fileName)
+{
+  fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw runtime_error("Failed to open file " + fileName);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < headerSize) {
+    ::close(fd);
+    throw runtime_error(fileName + " is not a CipherMatrix file");
+  }
+  fileSize = st.st_size;
+
+  void* addr = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (addr == MAP_FAILED) {
+    ::close(fd);
+    throw runtime_error("Failed to map file " + fileName);
+  }
+  data = static_cast<const char*>(addr);
+
+  const char* p = data;
+  if (memcmp(p, fileMagic, sizeof(fileMagic)) != 0 ||
+      readValue<int32_t>(p + sizeof(fileMagic)) != fileVersion) {
+    release();
+    throw runtime_error(fileName + " is not a CipherMatrix file");
+  }
+  p += sizeof(fileMagic) + sizeof(int32_t);
+  numRows = readValue<uint64_t>(p);
+  p += sizeof(uint64_t);
+  numCols = readValue<uint64_t>(p);
+  p += sizeof(uint64_t);
+  numFilledSlots = readValue<int32_t>(p);
+  p += sizeof(int32_t);
+
+  // Check the index fits in the file without overflowing the computation.
+  size_t maxTiles = (fileSize - headerSize) / indexEntrySize;
+  if (numCols != 0 && numRows > maxTiles / numCols) {
+    release();
+    throw runtime_error(fileName + " is truncated");
+  }
+  size_t numTiles = numRows * numCols;
+  size_t dataBegin = headerSize + numTiles * indexEntrySize;
+  index.resize(numTiles);
+  for (size_t t = 0; t < numTiles; t++) {
+    index[t].first = readValue<uint64_t>(p);
+    index[t].second = readValue<uint64_t>(p + sizeof(uint64_t));
+    p += indexEntrySize;
+    // Each tile must lie entirely in the data section following the index.
+    if (index[t].second == 0 || index[t].first < dataBegin ||
+        index[t].first > fileSize ||
+        index[t].second > fileSize - index[t].first) {
+      release();
+      throw runtime_error(fileName + " has an invalid tile index");
+    }
+  }
+}
+
+CipherMatrixFileReader::~CipherMatrixFileReader() { release(); }
+
+void CipherMatrixFileReader::release()
+{
+  if (data != NULL) {
+    munmap(const_cast<char*>(data), fileSize);
+    data = NULL;
+  }
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+void CipherMatrixFileReader::loadTile(CTile& res, size_t i, size_t j) const
+{
+  if (i >= numRows || j >= numCols)
+    throw invalid_argument("Tile (" + to_string(i) + "," + to_string(j) +
+                           ") is out of range");
+  const pair<uint64_t, uint64_t>& entry = index[i * numCols + j];
+  MemoryStreamBuf buf(data + entry.first, entry.second);
+  istream in(&buf);
+  in.exceptions(ios::failbit | ios::badbit);
+  res.load(in);
+}
+
+void CipherMatrixFileReader::loadRows(CipherMatrix& res,
+                                      size_t rowBegin,
+                                      size_t rowEnd) const
+{
+  HELAYERS_TIMER_SECTION("CipherMatrixFileReader::loadRows");
+  if (rowBegin > rowEnd || rowEnd > numRows)
+    throw invalid_argument("Invalid row range");
+
+  if (res.tiles.rank() != 2 || res.tiles.size(0) != numRows ||
+      res.tiles.size(1) != numCols) {
+    basic_extents<size_t> extents(std::vector<size_t>{numRows, numCols});
+    res.tiles.reshape(extents, CTile(he));
+  }
+  res.numFilledSlots = numFilledSlots;
+
+  size_t numTiles = (rowEnd - rowBegin) * numCols;
+  int n = CipherMatrix::getNumThreads();
+  // An exception must not escape the parallel region, so the first one is
+  // kept and rethrown after the loop.
+  exception_ptr error;
+#pragma omp parallel for num_threads(n) schedule(dynamic)
+  for (size_t t = 0; t < numTiles; t++) {
+    size_t i = rowBegin + t / numCols;
+    size_t j = t % numCols;
+    try {
+      loadTile(res.tiles.at(i, j), i, j);
+    } catch (...) {
+#pragma omp critical
+      if (!error)
+        error = current_exception();
+    }
+  }
+  if (error)
+    rethrow_exception(error);
+}
+
+void CipherMatrixFileReader::load(CipherMatrix& res) const
+{
+  loadRows(res, 0, numRows);
+}
+} // namespace helayers
@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_CIPHERMATRIXFILE_H
+#define SRC_HELAYERS_CIPHERMATRIXFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include "CipherMatrix.h"
+
+namespace helayers {
+
+/// Writes a CipherMatrix to a chunked container file.
+///
+/// The file starts with a header holding the dimensions and an index with
+/// the offset and length of every tile, followed by the tiles themselves.
+/// Tiles can be written one by one, in any order, as soon as they are
+/// computed. The index is completed by close().
+class CipherMatrixFileWriter
+{
+  std::ofstream out;
+  std::string fileName;
+  size_t numRows;
+  size_t numCols;
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> index;
+  std::streamoff indexPos;
+
+public:
+  /// Creates the file and writes its header.
+  /// @param[in] fileName name of file to write to
+  /// @param[in] numRows number of tile rows
+  /// @param[in] numCols number of tile columns
+  /// @param[in] numFilledSlots number of meaningful slots in each tile
+  CipherMatrixFileWriter(const std::string& fileName,
+                         size_t numRows,
+                         size_t numCols,
+                         int numFilledSlots);
+
+  /// Closes the file if close() was not called.
+  ~CipherMatrixFileWriter();
+
+  CipherMatrixFileWriter(const CipherMatrixFileWriter& src) = delete;
+  CipherMatrixFileWriter& operator=(const CipherMatrixFileWriter& src) =
+      delete;
+
+  /// Appends a tile to the file.
+  /// @param[in] i tile row
+  /// @param[in] j tile column
+  /// @param[in] tile tile to write
+  /// @throw invalid_argument If (i,j) is out of range or already written.
+  void writeTile(size_t i, size_t j, const CTile& tile);
+
+  /// Writes all tiles of a matrix, row by row.
+  /// @param[in] src matrix to write. Must match the file dimensions.
+  void write(const CipherMatrix& src);
+
+  /// Writes the tile index and closes the file.
+  /// @throw runtime_error If some tiles were not written or writing failed.
+  void close();
+};
+
+/// Reads tiles from a file written by CipherMatrixFileWriter.
+///
+/// The file is memory mapped, and only the header and index are parsed on
+/// construction. Each tile is parsed when it is loaded, so single tiles or
+/// rows can be loaded without reading the rest of the file.
+class CipherMatrixFileReader
+{
+  HeContext& he;
+  std::string fileName;
+  int fd = -1;
+  const char* data = NULL;
+  size_t fileSize = 0;
+  size_t numRows = 0;
+  size_t numCols = 0;
+  int numFilledSlots = 0;
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> index;
+
+  void release();
+
+public:
+  /// Maps the file and reads its header.
+  /// @param[in] he the underlying context.
+  /// @param[in] fileName name of file to read from
+  /// @throw runtime_error If the file can't be mapped or is not a valid
+  ///                      container.
+  CipherMatrixFileReader(HeContext& he, const std::string& fileName);
+
+  /// Unmaps the file.
+  ~CipherMatrixFileReader();
+
+  CipherMatrixFileReader(const CipherMatrixFileReader& src) = delete;
+  CipherMatrixFileReader& operator=(const CipherMatrixFileReader& src) =
+      delete;
+
+  /// Returns the number of tile rows.
+  size_t getNumRows() const { return numRows; }
+
+  /// Returns the number of tile columns.
+  size_t getNumCols() const { return numCols; }
+
+  /// Returns the number of meaningful slots in each tile.
+  int getNumFilledSlots() const { return numFilledSlots; }
+
+  /// Loads a single tile.
+  /// @param[out] res tile to load into
+  /// @param[in] i tile row
+  /// @param[in] j tile column
+  void loadTile(CTile& res, size_t i, size_t j) const;
+
+  /// Loads a range of tile rows into a matrix with the file's dimensions.
+  /// Tiles outside the range are left untouched, so a matrix can be filled
+  /// gradually, e.g., to start processing the first rows early.
+  /// @param[in,out] res matrix to load into. Reshaped to the file's
+  ///                    dimensions if it doesn't already have them.
+  /// @param[in] rowBegin first row to load
+  /// @param[in] rowEnd row after the last row to load
+  void loadRows(CipherMatrix& res, size_t rowBegin, size_t rowEnd) const;
+
+  /// Loads the entire matrix. Tiles are parsed in parallel.
+  /// @param[out] res matrix to load into
+  void load(CipherMatrix& res) const;
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_CIPHERMATRIXFILE_H */
@@ -24,6 +24,7 @@
 
 #include "DoubleMatrixArray.h"
 #include "helayers/hebase/hebase.h"
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -32,6 +33,47 @@ using namespace std;
 
 namespace helayers {
 
+// Minimal number of scalar operations for which kernels run in parallel.
+static const size_t parallelThreshold = 1 << 15;
+
+// Number of matrices processed together by the kernels below. Each operand
+// is packed a block at a time with depth innermost, the order in which a
+// batch occupies the slots of a CTile, so that the kernels vectorize over the
+// batch while the packed blocks stay in cache.
+static const int depthBlock = 32;
+
+// Packs matrices [first, first + count) of a into buf, element (i, j, k) at
+// (i * cols + j) * depthBlock + k. Unused lanes are zero.
+static void packBlock(const DoubleMatrixArray& a,
+                      int first,
+                      int count,
+                      vector<double>& buf)
+{
+  int rows = a.rows(), cols = a.cols();
+  buf.assign((size_t)rows * cols * depthBlock, 0);
+  for (int k = 0; k < count; ++k) {
+    const DoubleMatrix& mat = a.getMat(first + k);
+    for (int i = 0; i < rows; ++i)
+      for (int j = 0; j < cols; ++j)
+        buf[((size_t)i * cols + j) * depthBlock + k] = mat.get(i, j);
+  }
+}
+
+// Inverse of packBlock(), writing into an already sized array.
+static void unpackBlock(const vector<double>& buf,
+                        int first,
+                        int count,
+                        DoubleMatrixArray& a)
+{
+  int rows = a.rows(), cols = a.cols();
+  for (int k = 0; k < count; ++k) {
+    DoubleMatrix& mat = a.getMat(first + k);
+    for (int i = 0; i < rows; ++i)
+      for (int j = 0; j < cols; ++j)
+        mat.set(i, j, buf[((size_t)i * cols + j) * depthBlock + k]);
+  }
+}
+
 DoubleMatrixArray::DoubleMatrixArray() {}
 
 DoubleMatrixArray::DoubleMatrixArray(int rows, int cols, int len)
@@ -283,11 +325,41 @@ void DoubleMatrixArray::initFromH5File(int len,
 DoubleMatrixArray DoubleMatrixArray::getMatrixMultiply(
     const DoubleMatrixArray& other) const
 {
-  DoubleMatrixArray res;
   testSameSize("matrixMult", other);
+  if (size() == 0)
+    return DoubleMatrixArray();
+  if (cols() != other.rows()) {
+    cerr << "Can't multiply: " << endl;
+    debugPrint(cerr, "this", 0);
+    other.debugPrint(cerr, "other", 0);
+    throw invalid_argument("mismatching dims");
+  }
 
-  for (size_t i = 0; i < size(); ++i) {
-    res.mats.push_back(mats[i].getMultiply(other.mats[i]));
+  int n = rows(), m = cols(), p = other.cols(), len = size();
+  int numBlocks = (len + depthBlock - 1) / depthBlock;
+  DoubleMatrixArray res(n, p, len);
+
+#pragma omp parallel for if (numElements() * p >= parallelThreshold)
+  for (int blk = 0; blk < numBlocks; ++blk) {
+    int first = blk * depthBlock;
+    int count = min(depthBlock, len - first);
+    vector<double> a, b, c((size_t)n * p * depthBlock, 0);
+    packBlock(*this, first, count, a);
+    packBlock(other, first, count, b);
+
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < p; ++j) {
+        double* out = &c[((size_t)i * p + j) * depthBlock];
+        for (int k = 0; k < m; ++k) {
+          const double* x = &a[((size_t)i * m + k) * depthBlock];
+          const double* y = &b[((size_t)k * p + j) * depthBlock];
+#pragma omp simd
+          for (int d = 0; d < depthBlock; ++d)
+            out[d] += x[d] * y[d];
+        }
+      }
+
+    unpackBlock(c, first, count, res);
   }
   return res;
 }
@@ -306,7 +378,8 @@ void DoubleMatrixArray::transpose() { *this = getTranspose(); }
 void DoubleMatrixArray::add(const DoubleMatrixArray& other)
 {
   testSameSize("add", other);
-  for (size_t i = 0; i < size(); ++i) {
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); ++i) {
     mats[i] += other.mats[i];
   }
 }
@@ -337,21 +410,24 @@ void DoubleMatrixArray::elementMultiplyAt(const DoubleMatrixArray& other,
 void DoubleMatrixArray::sub(const DoubleMatrixArray& other)
 {
   testSameSize("sub", other);
-  for (size_t i = 0; i < size(); ++i) {
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); ++i) {
     mats[i] -= other.mats[i];
   }
 }
 
 void DoubleMatrixArray::elementMultiply(const DoubleMatrixArray& other)
 {
-  for (size_t m = 0; m < size(); m++) {
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int m = 0; m < size(); m++) {
     mats[m].elementMultiply(other.getMat(m));
   }
 }
 
 void DoubleMatrixArray::multiplyByScalar(double scalar)
 {
-  for (size_t i = 0; i < size(); ++i)
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); ++i)
     mats[i].multiplyByScalar(scalar);
 }
 
@@ -364,6 +440,7 @@ DoubleMatrixArray DoubleMatrixArray::getMultiplyByScalar(double scalar) const
 
 void DoubleMatrixArray::innerSum()
 {
+#pragma omp parallel for collapse(2) if (numElements() >= parallelThreshold)
   for (int i = 0; i < rows(); ++i)
     for (int j = 0; j < cols(); ++j) {
       double sum = 0;
@@ -585,10 +662,43 @@ DoubleMatrixArray DoubleMatrixArray::getConvolution(
     int strideCols) const
 {
   testSameSize("conv", filter);
-  DoubleMatrixArray res;
-  for (size_t i = 0; i < size(); ++i)
-    res.mats.push_back(
-        mats[i].getConvolution(filter.mats[i], strideRows, strideCols));
+  if (size() == 0)
+    return DoubleMatrixArray();
+
+  int inRows = rows(), inCols = cols(), len = size();
+  int filterRows = filter.rows(), filterCols = filter.cols();
+  int outRows = ceil((double)(inRows - filterRows) / strideRows) + 1;
+  int outCols = ceil((double)(inCols - filterCols) / strideCols) + 1;
+  int numBlocks = (len + depthBlock - 1) / depthBlock;
+  DoubleMatrixArray res(outRows, outCols, len);
+
+  size_t work = (size_t)outRows * outCols * len * filterRows * filterCols;
+#pragma omp parallel for if (work >= parallelThreshold)
+  for (int blk = 0; blk < numBlocks; ++blk) {
+    int first = blk * depthBlock;
+    int count = min(depthBlock, len - first);
+    vector<double> in, f, out((size_t)outRows * outCols * depthBlock, 0);
+    packBlock(*this, first, count, in);
+    packBlock(filter, first, count, f);
+
+    for (int tr = 0; tr < outRows; ++tr)
+      for (int tc = 0; tc < outCols; ++tc) {
+        int r = tr * strideRows, c = tc * strideCols;
+        double* o = &out[((size_t)tr * outCols + tc) * depthBlock];
+        for (int i = 0; i < filterRows && r + i < inRows; ++i)
+          for (int j = 0; j < filterCols && c + j < inCols; ++j) {
+            const double* x =
+                &in[((size_t)(r + i) * inCols + c + j) * depthBlock];
+            const double* y = &f[((size_t)i * filterCols + j) * depthBlock];
+#pragma omp simd
+            for (int d = 0; d < depthBlock; ++d)
+              o[d] += y[d] * x[d];
+          }
+      }
+
+    unpackBlock(out, first, count, res);
+  }
+
   return res;
 }
 
@@ -640,8 +750,10 @@ DoubleMatrixArray DoubleMatrixArray::getColumn(int col) const
 DoubleMatrixArray DoubleMatrixArray::getMeanAlongRows() const
 {
   DoubleMatrixArray res;
-  for (size_t i = 0; i < mats.size(); i++) {
-    res.pushBackMatrix(mats[i].getMeanAlongRows());
+  res.mats.resize(size());
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); i++) {
+    res.mats[i] = mats[i].getMeanAlongRows();
   }
 
   return res;
@@ -649,8 +761,10 @@ DoubleMatrixArray DoubleMatrixArray::getMeanAlongRows() const
 DoubleMatrixArray DoubleMatrixArray::getMeanAlongCols() const
 {
   DoubleMatrixArray res;
-  for (size_t i = 0; i < mats.size(); i++) {
-    res.pushBackMatrix(mats[i].getMeanAlongCols());
+  res.mats.resize(size());
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); i++) {
+    res.mats[i] = mats[i].getMeanAlongCols();
   }
 
   return res;
@@ -668,8 +782,10 @@ DoubleMatrixArray DoubleMatrixArray::getMeanInDepth() const
 DoubleMatrixArray DoubleMatrixArray::getSumAlongRows() const
 {
   DoubleMatrixArray res;
-  for (size_t i = 0; i < mats.size(); i++) {
-    res.pushBackMatrix(mats[i].getSumAlongRows());
+  res.mats.resize(size());
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); i++) {
+    res.mats[i] = mats[i].getSumAlongRows();
   }
 
   return res;
@@ -678,8 +794,10 @@ DoubleMatrixArray DoubleMatrixArray::getSumAlongRows() const
 DoubleMatrixArray DoubleMatrixArray::getSumAlongCols() const
 {
   DoubleMatrixArray res;
-  for (size_t i = 0; i < mats.size(); i++) {
-    res.pushBackMatrix(mats[i].getSumAlongCols());
+  res.mats.resize(size());
+#pragma omp parallel for if (numElements() >= parallelThreshold)
+  for (int i = 0; i < size(); i++) {
+    res.mats[i] = mats[i].getSumAlongCols();
   }
 
   return res;
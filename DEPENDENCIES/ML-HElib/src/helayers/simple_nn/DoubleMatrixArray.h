@@ -42,6 +42,9 @@ class DoubleMatrixArray
 {
   std::vector<DoubleMatrix> mats;
 
+  // Returns the total number of elements in all matrices.
+  inline size_t numElements() const { return (size_t)size() * rows() * cols(); }
+
 public:
   ///@brief Construct an empty DoubleMatrixArray object
   DoubleMatrixArray();
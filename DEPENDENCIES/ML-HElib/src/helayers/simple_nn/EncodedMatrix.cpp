@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "EncodedMatrix.h"
+
+using namespace std;
+using namespace boost::numeric::ublas;
+
+namespace helayers {
+
+EncodedMatrix::EncodedMatrix(HeContext& he) : he(&he), numFilledSlots(0) {}
+
+EncodedMatrix::~EncodedMatrix() {}
+
+streamoff EncodedMatrix::save(ostream& stream) const
+{
+  HELAYERS_TIMER_SECTION("EncodedMatrix::save");
+
+  streampos streamStartPos = stream.tellp();
+
+  size_t numRows = tiles.size(0);
+  size_t numCols = tiles.size(1);
+
+  stream.write(reinterpret_cast<const char*>(&numRows), sizeof(size_t));
+  stream.write(reinterpret_cast<const char*>(&numCols), sizeof(size_t));
+  stream.write(reinterpret_cast<const char*>(&numFilledSlots), sizeof(int));
+
+  for (size_t i = 0; i < numRows; i++) {
+    for (size_t j = 0; j < numCols; j++)
+      tiles.at(i, j).save(stream);
+  }
+
+  streampos streamEndPos = stream.tellp();
+  return streamEndPos - streamStartPos;
+}
+
+streamoff EncodedMatrix::load(istream& stream)
+{
+  HELAYERS_TIMER_SECTION("EncodedMatrix::load");
+
+  streampos streamStartPos = stream.tellg();
+
+  size_t numRows, numCols;
+
+  stream.read(reinterpret_cast<char*>(&numRows), sizeof(size_t));
+  stream.read(reinterpret_cast<char*>(&numCols), sizeof(size_t));
+  stream.read(reinterpret_cast<char*>(&numFilledSlots), sizeof(int));
+
+  basic_extents<size_t> extents(std::vector<size_t>{
+      (long unsigned int)numRows, (long unsigned int)numCols});
+  tiles.reshape(extents, PTile(*he));
+
+  for (size_t i = 0; i < numRows; i++) {
+    for (size_t j = 0; j < numCols; j++)
+      tiles.at(i, j).load(stream);
+  }
+
+  streampos streamEndPos = stream.tellg();
+
+  return streamEndPos - streamStartPos;
+}
+
+CipherMatrix EncodedMatrix::getMatrixMultiply(const CipherMatrix& other) const
+{
+  HELAYERS_TIMER_SECTION("EncodedMatrix::getMatrixMultiply");
+
+  if (tiles.size(1) != other.tiles.size(0) ||
+      numFilledSlots != other.numFilledSlots)
+    throw invalid_argument("Other has incompatible dimensions");
+
+  // Tiles of other are shared between threads below, so any deferred
+  // maintenance on them is done beforehand, on a copy since other is const.
+  if (other.hasPendingMaintenance()) {
+    CipherMatrix maintained(other);
+    maintained.flushMaintenance();
+    return getMatrixMultiply(maintained);
+  }
+
+  basic_extents<size_t> extents(
+      std::vector<size_t>{tiles.size(0), other.tiles.size(1)});
+  tensor<CTile> newTiles(extents, CTile(*he));
+
+  size_t numRows = newTiles.size(0);
+  size_t numCols = newTiles.size(1);
+  size_t innerDim = tiles.size(1);
+
+  // Each thread computes its products in a single buffer.
+  int n = CipherMatrix::getNumThreads();
+#pragma omp parallel num_threads(n)
+  {
+    CTile buffer(*he);
+#pragma omp for collapse(2) schedule(dynamic)
+    for (size_t i = 0; i < numRows; i++) {
+      for (size_t j = 0; j < numCols; j++) {
+        CTile& out = newTiles.at(i, j);
+        for (size_t k = 0; k < innerDim; k++)
+          out.multiplyPlainAdd(other.tiles.at(k, j), tiles.at(i, k), buffer);
+      }
+    }
+  }
+
+  CipherMatrix res(*he);
+  res.tiles = std::move(newTiles);
+  res.numFilledSlots = numFilledSlots;
+
+  return res;
+}
+} // namespace helayers
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_ENCODEDMATRIX_H
+#define SRC_HELAYERS_ENCODEDMATRIX_H
+
+#include "CipherMatrix.h"
+
+namespace helayers {
+
+/// A class for holding a matrix of encoded but unencrypted tiles, laid out
+/// like a CipherMatrix. Used for operands known to the party doing the
+/// computation, such as model weights owned by the server: operations
+/// between plaintexts and ciphertexts need no key switching.
+class EncodedMatrix : public Saveable
+{
+
+  HeContext* he;
+
+  boost::numeric::ublas::tensor<PTile> tiles;
+
+  int numFilledSlots;
+
+  friend class CipherMatrixEncoder;
+  friend class CipherMatrix;
+
+public:
+  /// Construct an empty object.
+  /// @param[in] he the underlying context.
+  EncodedMatrix(HeContext& he);
+
+  /// Default copy constructor.
+  EncodedMatrix(const EncodedMatrix& src) = default;
+
+  /// Default move constructor.
+  EncodedMatrix(EncodedMatrix&& src) = default;
+
+  ~EncodedMatrix();
+
+  /// Default assignment operator.
+  EncodedMatrix& operator=(const EncodedMatrix& src) = default;
+
+  /// Default move assignment operator.
+  EncodedMatrix& operator=(EncodedMatrix&& src) = default;
+
+  /// Save object to binary stream.
+  /// @param[in] stream output stream to write to
+  std::streamoff save(std::ostream& stream) const override;
+
+  /// Load object from binary stream.
+  /// @param[in] stream output stream to read from
+  std::streamoff load(std::istream& stream) override;
+
+  /// Returns a CipherMatrix containing the matrix multiplication of this
+  /// matrix by an encrypted one. Uses only plaintext-ciphertext
+  /// multiplications, so no relinearization is needed. Rescale of the result
+  /// is deferred until required (see CTile::rescaleLazy()).
+  /// @param[in] other matrix to multiply with
+  CipherMatrix getMatrixMultiply(const CipherMatrix& other) const;
+
+  /// Returns the number of tile rows.
+  size_t getNumRows() const { return tiles.size(0); }
+
+  /// Returns the number of tile columns.
+  size_t getNumCols() const { return tiles.size(1); }
+
+  /// Returns the number of meaningful slots in each tile.
+  int getNumFilledSlots() const { return numFilledSlots; }
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_ENCODEDMATRIX_H */
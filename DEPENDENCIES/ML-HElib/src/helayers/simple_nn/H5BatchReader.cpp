@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "H5BatchReader.h"
+
+using namespace std;
+
+namespace helayers {
+
+H5BatchReader::H5BatchReader(int batchSize,
+                             const string& sampleFile,
+                             const string& samplePath,
+                             bool readAhead)
+    : batchSize(batchSize),
+      readAhead(readAhead),
+      samplesFile(sampleFile),
+      samplesPath(samplePath)
+{
+  initDims();
+}
+
+H5BatchReader::H5BatchReader(int batchSize,
+                             const string& sampleFile,
+                             const string& samplePath,
+                             const string& labelFile,
+                             const string& labelPath,
+                             bool readAhead)
+    : batchSize(batchSize),
+      readAhead(readAhead),
+      samplesFile(sampleFile),
+      samplesPath(samplePath),
+      labelsFile(make_unique<H5Parser>(labelFile)),
+      labelsPath(labelPath)
+{
+  initDims();
+}
+
+H5BatchReader::~H5BatchReader()
+{
+  if (pending.valid())
+    pending.wait();
+}
+
+void H5BatchReader::initDims()
+{
+  if (batchSize <= 0)
+    throw invalid_argument("Batch size must be positive");
+
+  vector<int> dims = samplesFile.getDims(samplesPath);
+  while (dims.size() < 4)
+    dims.push_back(1);
+  numSamples = dims[0];
+  inputRows = dims[1];
+  inputCols = dims[2];
+  if (dims[3] != 1)
+    throw runtime_error("3D samples are not supported");
+
+  if (!labelsFile)
+    return;
+  dims = labelsFile->getDims(labelsPath);
+  while (dims.size() < 2)
+    dims.push_back(1);
+  numClasses = dims[1];
+  if (dims[0] != numSamples)
+    throw runtime_error(
+        "Number of labels does not match the number of samples");
+}
+
+SimpleBatchPlain H5BatchReader::readBatch(int batch) const
+{
+  if (batch < 0 || batch >= getNumBatches())
+    throw out_of_range("Batch " + to_string(batch) + " out of range");
+
+  int first = batch * batchSize;
+  vector<double> raw;
+  vector<int> dims;
+  SimpleBatchPlain res;
+
+  int numRead;
+  {
+    lock_guard<mutex> lock(mtx);
+    numRead = samplesFile.readSamples(samplesPath, first, batchSize, raw, dims);
+  }
+  res.samples.init(inputRows, inputCols, batchSize);
+  size_t pos = 0;
+  for (int i = 0; i < numRead; ++i) {
+    DoubleMatrix& sample = res.samples.getMat(i);
+    for (int x = 0; x < inputRows; ++x)
+      for (int y = 0; y < inputCols; ++y)
+        sample.set(x, y, raw[pos++]);
+  }
+
+  if (!labelsFile)
+    return res;
+  {
+    lock_guard<mutex> lock(mtx);
+    numRead = labelsFile->readSamples(labelsPath, first, batchSize, raw, dims);
+  }
+  res.labels.init(numClasses, 1, batchSize);
+  pos = 0;
+  for (int i = 0; i < numRead; ++i) {
+    DoubleMatrix& label = res.labels.getMat(i);
+    for (int y = 0; y < numClasses; ++y)
+      label.set(y, 0, raw[pos++]);
+  }
+  return res;
+}
+
+bool H5BatchReader::next(SimpleBatchPlain& batch)
+{
+  if (nextBatch >= getNumBatches())
+    return false;
+
+  if (pending.valid())
+    batch = pending.get();
+  else
+    batch = readBatch(nextBatch);
+  ++nextBatch;
+
+  if (readAhead && nextBatch < getNumBatches()) {
+    int b = nextBatch;
+    pending = async(launch::async, [this, b]() { return readBatch(b); });
+  }
+  return true;
+}
+
+void H5BatchReader::reset()
+{
+  if (pending.valid())
+    pending.wait();
+  pending = future<SimpleBatchPlain>();
+  nextBatch = 0;
+}
+} // namespace helayers
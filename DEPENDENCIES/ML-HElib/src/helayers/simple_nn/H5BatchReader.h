@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRC_HELAYERS_H5BATCHREADER_H
+#define SRC_HELAYERS_H5BATCHREADER_H
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "TrainingSetPlain.h"
+#include "h5Parser.h"
+
+namespace helayers {
+
+///@brief A class for streaming the batches of a data set stored in h5 files.
+///
+/// Only the samples (and labels) of the batch being read are loaded, each
+/// with a single hyperslab read, so data sets larger than the memory can be
+/// iterated over and the first batch is available right away. Batches are
+/// laid out as in TrainingSetPlain, the last one padded with zeros.
+///
+/// With read-ahead enabled, the next batch is read on a background thread
+/// while the current one is processed. The files of a reader are accessed by
+/// one thread at a time, but unless the HDF5 library is built thread safe,
+/// other HDF5 users must not run during a read-ahead.
+class H5BatchReader
+{
+  int batchSize;
+  bool readAhead;
+
+  H5Parser samplesFile;
+  std::string samplesPath;
+  std::unique_ptr<H5Parser> labelsFile;
+  std::string labelsPath;
+
+  int numSamples;
+  int inputRows;
+  int inputCols;
+  int numClasses = 0;
+
+  int nextBatch = 0;
+
+  // serializes access to the h5 files
+  mutable std::mutex mtx;
+
+  // the batch being read ahead, if any
+  std::future<SimpleBatchPlain> pending;
+
+  void initDims();
+
+public:
+  ///@brief Constructs a reader of samples without labels.
+  ///@param batchSize   Number of samples in each batch
+  ///@param sampleFile  h5 file containing the samples
+  ///@param samplePath  path of the samples inside the file
+  ///@param readAhead   whether to read the next batch in the background
+  H5BatchReader(int batchSize,
+                const std::string& sampleFile,
+                const std::string& samplePath,
+                bool readAhead = false);
+
+  ///@brief Constructs a reader of samples and their labels.
+  ///@param batchSize   Number of samples in each batch
+  ///@param sampleFile  h5 file containing the samples
+  ///@param samplePath  path of the samples inside the file
+  ///@param labelFile   h5 file containing the labels
+  ///@param labelPath   path of the labels inside the file
+  ///@param readAhead   whether to read the next batch in the background
+  H5BatchReader(int batchSize,
+                const std::string& sampleFile,
+                const std::string& samplePath,
+                const std::string& labelFile,
+                const std::string& labelPath,
+                bool readAhead = false);
+
+  ~H5BatchReader();
+
+  H5BatchReader(const H5BatchReader& src) = delete;
+
+  H5BatchReader& operator=(const H5BatchReader& src) = delete;
+
+  ///@brief Reads the next batch into "batch". Returns false, leaving "batch"
+  /// unchanged, once all batches have been read.
+  ///@param batch Output batch
+  bool next(SimpleBatchPlain& batch);
+
+  ///@brief Restarts the iteration from the first batch.
+  void reset();
+
+  ///@brief Reads a given batch, regardless of the iteration.
+  ///@param batch Index of the batch to read
+  SimpleBatchPlain readBatch(int batch) const;
+
+  inline bool hasLabels() const { return labelsFile != nullptr; }
+  inline int getNumBatches() const
+  {
+    return (numSamples + batchSize - 1) / batchSize;
+  }
+  inline int getBatchSize() const { return batchSize; }
+  inline int getNumSamples() const { return numSamples; }
+  inline int getNumClasses() const { return numClasses; }
+};
+} // namespace helayers
+
+#endif /* SRC_HELAYERS_H5BATCHREADER_H */
@@ -24,25 +24,53 @@
 
 #include "SimpleFcLayer.h"
 #include "CipherMatrixEncoder.h"
+#include "helayers/hebase/utils/BinIoUtils.h"
+#include <limits>
 
 using namespace std;
 using namespace boost::numeric::ublas;
 
 namespace helayers {
 
-SimpleFcLayer::SimpleFcLayer(HeContext& he) : he(he), weights(he), bias(he) {}
+// Layers with plain weights are saved starting with this marker. Layers with
+// encrypted weights keep the original format, which starts with the number
+// of rows of the weights matrix, so files saved before plain weights were
+// supported can still be loaded.
+static const size_t plainWeightsMarker = numeric_limits<size_t>::max();
+
+SimpleFcLayer::SimpleFcLayer(HeContext& he, bool plainWeights)
+    : he(he),
+      plainWeights(plainWeights),
+      weights(he),
+      bias(he),
+      encodedWeights(he),
+      encodedBias(he),
+      timerSectionId(HelayersTimer::intern("SimpleFcLayer_"))
+{}
 
 SimpleFcLayer::~SimpleFcLayer() {}
 
+void SimpleFcLayer::setName(const string& n)
+{
+  SimpleLayer::setName(n);
+  timerSectionId = HelayersTimer::intern("SimpleFcLayer_" + n);
+}
+
 streamoff SimpleFcLayer::save(ostream& stream) const
 {
-  HELAYERS_TIMER_PUSH("SimpleFcLayer_" + getName());
+  HELAYERS_TIMER_PUSH_ID(timerSectionId);
   HELAYERS_TIMER_PUSH("SimpleFcLayer::save");
 
   streampos streamStartPos = stream.tellp();
 
-  weights.save(stream);
-  bias.save(stream);
+  if (plainWeights) {
+    BinIoUtils::writeSizeT(stream, plainWeightsMarker);
+    encodedWeights.save(stream);
+    encodedBias.save(stream);
+  } else {
+    weights.save(stream);
+    bias.save(stream);
+  }
 
   streampos streamEndPos = stream.tellp();
 
@@ -53,13 +81,20 @@ streamoff SimpleFcLayer::save(ostream& stream) const
 
 streamoff SimpleFcLayer::load(istream& stream)
 {
-  HELAYERS_TIMER_PUSH("SimpleFcLayer_" + getName());
+  HELAYERS_TIMER_PUSH_ID(timerSectionId);
   HELAYERS_TIMER_PUSH("SimpleFcLayer::load");
 
   streampos streamStartPos = stream.tellg();
 
-  weights.load(stream);
-  bias.load(stream);
+  plainWeights = BinIoUtils::readSizeT(stream) == plainWeightsMarker;
+  if (plainWeights) {
+    encodedWeights.load(stream);
+    encodedBias.load(stream);
+  } else {
+    stream.seekg(streamStartPos);
+    weights.load(stream);
+    bias.load(stream);
+  }
 
   streampos streamEndPos = stream.tellg();
 
@@ -71,7 +106,7 @@ streamoff SimpleFcLayer::load(istream& stream)
 void SimpleFcLayer::initFromLayer(const SimpleFcPlainLayer& fpl,
                                   int baseChainIndex)
 {
-  HELAYERS_TIMER_PUSH("SimpleFcLayer_" + getName());
+  HELAYERS_TIMER_PUSH_ID(timerSectionId);
   HELAYERS_TIMER_PUSH("SimpleFcLayer::initFromLayer");
 
   if (!he.getTraits().getAutomaticallyManagesChainIndices()) {
@@ -85,8 +120,13 @@ void SimpleFcLayer::initFromLayer(const SimpleFcPlainLayer& fpl,
   tensor<double> biasVals = fpl.getBias().getTensor();
 
   const CipherMatrixEncoder encoder(he);
-  encoder.encodeEncrypt(weights, weightsVals, baseChainIndex);
-  encoder.encodeEncrypt(bias, biasVals, baseChainIndex - 1);
+  if (plainWeights) {
+    encoder.encode(encodedWeights, weightsVals, baseChainIndex);
+    encoder.encode(encodedBias, biasVals, baseChainIndex - 1);
+  } else {
+    encoder.encodeEncrypt(weights, weightsVals, baseChainIndex);
+    encoder.encodeEncrypt(bias, biasVals, baseChainIndex - 1);
+  }
 
   HELAYERS_TIMER_POP();
   HELAYERS_TIMER_POP();
@@ -94,11 +134,19 @@ void SimpleFcLayer::initFromLayer(const SimpleFcPlainLayer& fpl,
 
 CipherMatrix SimpleFcLayer::forward(const CipherMatrix& inVec) const
 {
-  HELAYERS_TIMER_PUSH("SimpleFcLayer_" + getName());
+  HELAYERS_TIMER_PUSH_ID(timerSectionId);
   HELAYERS_TIMER_PUSH("SimpleFcLayer::forward");
 
-  CipherMatrix res = weights.getMatrixMultiply(inVec);
-  res.add(bias);
+  CipherMatrix res = plainWeights ? encodedWeights.getMatrixMultiply(inVec)
+                                  : weights.getMatrixMultiply(inVec);
+  // The bias is encoded at the level of the rescaled product. Adding a plain
+  // bias performs the deferred relinearize and rescale of the product first,
+  // while an encrypted bias is kept aside as a pending addend of the product,
+  // so maintenance stays deferred until the result is next used.
+  if (plainWeights)
+    res.addPlain(encodedBias);
+  else
+    res.add(bias);
 
   HELAYERS_TIMER_POP();
   HELAYERS_TIMER_POP();
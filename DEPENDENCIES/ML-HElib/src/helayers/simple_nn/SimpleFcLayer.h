@@ -26,25 +26,45 @@
 #define SRC_HELAYERS_SIMPLEFCLAYER_H
 
 #include "CipherMatrix.h"
+#include "EncodedMatrix.h"
 #include "SimpleFcPlainLayer.h"
 
 namespace helayers {
 
-/// A class representing an encrypted fully connected layer
+/// A class representing a fully connected layer working on encrypted inputs.
+/// The weights are either encrypted, or only encoded when they are owned by
+/// the party running the inference (see SimpleFcLayer()).
 class SimpleFcLayer : public SimpleLayer
 {
 
   HeContext& he;
 
+  bool plainWeights;
+
   CipherMatrix weights;
 
   CipherMatrix bias;
 
+  EncodedMatrix encodedWeights;
+
+  EncodedMatrix encodedBias;
+
+  // Profiling section of this layer, interned when the name is set.
+  int timerSectionId;
+
 public:
-  SimpleFcLayer(HeContext& he);
+  /// Construct a layer.
+  /// @param[in] he the underlying context.
+  /// @param[in] plainWeights whether to keep weights encoded rather than
+  ///                         encrypted. Multiplying by plain weights needs no
+  ///                         relinearization, and the saved layer is
+  ///                         smaller. Overridden by load().
+  SimpleFcLayer(HeContext& he, bool plainWeights = false);
 
   ~SimpleFcLayer();
 
+  void setName(const std::string& n) override;
+
   std::streamoff save(std::ostream& stream) const;
 
   std::streamoff load(std::istream& stream);
@@ -52,6 +72,9 @@ public:
   void initFromLayer(const SimpleFcPlainLayer& fpl, int baseChainIndex = -1);
 
   CipherMatrix forward(const CipherMatrix& inVec) const;
+
+  /// Returns whether weights are kept encoded rather than encrypted.
+  bool hasPlainWeights() const { return plainWeights; }
 };
 } // namespace helayers
 
@@ -41,7 +41,7 @@ public:
 
   /// Sets this layer name.
   /// @param[in] n name
-  inline void setName(const std::string& n) { name = n; }
+  virtual void setName(const std::string& n) { name = n; }
 
   /// Returns layer name
   inline const std::string& getName() const { return name; }
@@ -28,8 +28,12 @@ using namespace std;
 
 namespace helayers {
 
-SimpleNeuralNet::SimpleNeuralNet(HeContext& he)
-    : he(he), fcl1(he), fcl2(he), fcl3(he), sal()
+SimpleNeuralNet::SimpleNeuralNet(HeContext& he, bool plainWeights)
+    : he(he),
+      fcl1(he, plainWeights),
+      fcl2(he, plainWeights),
+      fcl3(he, plainWeights),
+      sal()
 {
   fcl1.setName("fc1");
   fcl2.setName("fc2");
@@ -35,10 +35,11 @@ namespace helayers {
 
 /** A simple neural network with a fixed architecture:
  * 3 fully connected layers, each followed by a square activation layer.
- * It works on encrypted data: both inputs and weights,
- * stored as CipherMatrix.
+ * It works on encrypted inputs, stored as CipherMatrix. The weights are
+ * either encrypted as well, or only encoded when the network is owned by the
+ * party running the inference.
  *
- * The encrypted weights of this network are either loaded from file,
+ * The weights of this network are either loaded from file,
  * or encrypted from a SimpleNeuralNetPlain.
  */
 class SimpleNeuralNet : public Saveable
@@ -54,7 +55,9 @@ class SimpleNeuralNet : public Saveable
 public:
   /// Construct a network.
   /// @param[in] he the underlying context.
-  SimpleNeuralNet(HeContext& he);
+  /// @param[in] plainWeights whether initFromNet() keeps the weights encoded
+  ///                         rather than encrypted. See SimpleFcLayer.
+  SimpleNeuralNet(HeContext& he, bool plainWeights = false);
 
   ~SimpleNeuralNet();
 
@@ -75,6 +78,9 @@ public:
   /// @param[in] input input data
   /// @param[out] output output prediction
   void predict(const CipherMatrix& input, CipherMatrix& output) const;
+
+  /// Returns whether the weights are kept encoded rather than encrypted.
+  bool hasPlainWeights() const { return fcl1.hasPlainWeights(); }
 };
 } // namespace helayers
 
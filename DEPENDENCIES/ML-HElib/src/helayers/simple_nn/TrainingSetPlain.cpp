@@ -23,81 +23,29 @@
  */
 
 #include "TrainingSetPlain.h"
-#include "h5Parser.h"
+#include "H5BatchReader.h"
 #include <iostream>
 
 using namespace std;
 
 namespace helayers {
 
-void TrainingSetPlain::loadSamples(const std::string& sampleFile,
-                                   const std::string& sampleWeights)
+void TrainingSetPlain::load(H5BatchReader& reader)
 {
-  H5Parser h5(sampleFile);
-
-  vector<double> raw;
-  vector<int> dims;
-  h5.readData(sampleWeights, raw, dims);
-
-  while (dims.size() < 4)
-    dims.push_back(1);
-
-  numSamples = dims[0];
-  int inputRows = dims[1];
-  int inputCols = dims[2];
-
-  if (dims[3] != 1)
-    throw runtime_error("3D samples are not supported");
-
-  batches.resize(ceil((double)numSamples / batchSize));
-
-  int currentBatch = -1;
-  int pos = 0;
-  for (int i = 0; i < numSamples; ++i) {
-    if ((i % batchSize) == 0) {
-      currentBatch++;
-      batches[currentBatch].samples.init(inputRows, inputCols, batchSize);
-    }
-    for (int x = 0; x < inputRows; ++x) {
-      for (int y = 0; y < inputCols; ++y) {
-        batches[currentBatch]
-            .samples.getMat(i % batchSize)
-            .set(x, y, raw[pos++]);
-      }
-    }
+  numSamples = reader.getNumSamples();
+  if (reader.hasLabels()) {
+    numLabels = numSamples;
+    numClasses = reader.getNumClasses();
   }
-}
 
-void TrainingSetPlain::loadLabels(const std::string& labelFile,
-                                  const std::string& labelWeights)
-{
-  vector<double> raw;
-  vector<int> dims;
-  H5Parser h5b(labelFile);
-  h5b.readData(labelWeights, raw, dims);
-
-  while (dims.size() < 2)
-    dims.push_back(1);
-
-  numLabels = dims.at(0);
-  numClasses = dims.at(1);
-
-  if (numLabels != numSamples)
-    throw runtime_error(
-        "Number of labels does not match the number of samples");
-
-  batches.resize(ceil((double)numSamples / batchSize));
-  int pos = 0;
-  int currentBatch = -1;
-  for (int i = 0; i < numSamples; ++i) {
-    if ((i % batchSize) == 0) {
-      currentBatch++;
-      batches[currentBatch].labels.init(numClasses, 1, batchSize);
-    }
-    for (int y = 0; y < numClasses; ++y) {
-      batches[currentBatch].labels.getMat(i % batchSize).set(y, 0, raw[pos++]);
-    }
-  }
+  // Batches are read one at a time, so the whole raw data set is never held
+  // in memory in addition to them.
+  batches.clear();
+  batches.reserve(reader.getNumBatches());
+  reader.reset();
+  SimpleBatchPlain batch;
+  while (reader.next(batch))
+    batches.push_back(batch);
 }
 
 void TrainingSetPlain::loadFromH5(const std::string& sampleFile,
@@ -105,14 +53,16 @@ void TrainingSetPlain::loadFromH5(const std::string& sampleFile,
                                   const std::string& labelFile,
                                   const std::string& labelWeights)
 {
-  loadSamples(sampleFile, sampleWeights);
-  loadLabels(labelFile, labelWeights);
+  H5BatchReader reader(
+      batchSize, sampleFile, sampleWeights, labelFile, labelWeights);
+  load(reader);
 }
 
 void TrainingSetPlain::loadFromH5(const std::string& sampleFile,
                                   const std::string& sampleWeights)
 {
-  loadSamples(sampleFile, sampleWeights);
+  H5BatchReader reader(batchSize, sampleFile, sampleWeights);
+  load(reader);
 }
 
 DoubleMatrixArray TrainingSetPlain::getAllSamples() const
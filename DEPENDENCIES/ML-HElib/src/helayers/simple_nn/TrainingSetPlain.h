@@ -31,6 +31,8 @@
 
 namespace helayers {
 
+class H5BatchReader;
+
 ///@brief A structure to hold the plain samples and labels of a single batch.
 struct SimpleBatchPlain
 {
@@ -58,12 +60,6 @@ class TrainingSetPlain
   int numSamples;
   std::vector<SimpleBatchPlain> batches;
 
-  void loadSamples(const std::string& sampleFile,
-                   const std::string& sampleWeights);
-
-  void loadLabels(const std::string& labelFile,
-                  const std::string& labelWeights);
-
 public:
   TrainingSetPlain(int batchSize) : batchSize(batchSize) {}
   ~TrainingSetPlain() {}
@@ -76,6 +72,12 @@ public:
   void loadFromH5(const std::string& sampleFile,
                   const std::string& sampleWeights);
 
+  ///@brief Loads all batches of the given reader, replacing the current
+  /// ones. To process batches without holding all of them in memory, iterate
+  /// over the reader directly instead.
+  ///@param reader Reader to load batches from
+  void load(H5BatchReader& reader);
+
   inline const DoubleMatrixArray& getSamples(int batch) const
   {
     return batches[batch].samples;
@@ -162,6 +162,83 @@ void H5Parser::readData(const std::string& path,
   delete[] dd;
 }
 
+std::vector<int> H5Parser::getDims(const std::string& path) const
+{
+  DataSpace dataspace = file.openDataSet(path).getSpace();
+  int rank = dataspace.getSimpleExtentNdims();
+  std::vector<hsize_t> dims(rank);
+  dataspace.getSimpleExtentDims(dims.data());
+  return std::vector<int>(dims.begin(), dims.end());
+}
+
+int H5Parser::readSamples(const std::string& path,
+                          int first,
+                          int count,
+                          std::vector<double>& vals,
+                          std::vector<int>& dims) const
+{
+  DataSet dataset = file.openDataSet(path);
+  DataType datatype = dataset.getDataType();
+  DataSpace dataspace = dataset.getSpace();
+  H5T_class_t classt = datatype.getClass();
+
+  if (classt != H5T_INTEGER && classt != H5T_FLOAT)
+    throw DataTypeIException("Parser::readSamples");
+
+  int rank = dataspace.getSimpleExtentNdims();
+  std::vector<hsize_t> fileDims(rank);
+  dataspace.getSimpleExtentDims(fileDims.data());
+  if (rank < 1 || first < 0 || count < 0 || (hsize_t)first > fileDims[0])
+    throw invalid_argument("Can't read samples " + to_string(first) +
+                           " to " + to_string(first + count) + " of " + path);
+
+  dims.assign(fileDims.begin() + 1, fileDims.end());
+  size_t sampleSize = 1;
+  for (int d : dims)
+    sampleSize *= d;
+  int numRead = min((hsize_t)count, fileDims[0] - first);
+
+  // HDF5 converts integer data to doubles while reading.
+  vals.resize(numRead * sampleSize);
+  if (numRead > 0) {
+    std::vector<hsize_t> offset(rank, 0);
+    std::vector<hsize_t> extent(fileDims);
+    offset[0] = first;
+    extent[0] = numRead;
+    dataspace.selectHyperslab(H5S_SELECT_SET, extent.data(), offset.data());
+    DataSpace memspace(rank, extent.data());
+    dataset.read(vals.data(), PredType::NATIVE_DOUBLE, memspace, dataspace);
+  }
+  return numRead;
+}
+
+void H5Parser::readSlotPacked(const std::string& path,
+                              int first,
+                              int count,
+                              std::vector<double>& vals,
+                              std::vector<int>& dims) const
+{
+  // Each element of a sample is packed into a tile, so samples must be
+  // matrices, as in H5BatchReader. A trailing dimension of 1 is allowed.
+  std::vector<int> fileDims = getDims(path);
+  for (size_t d = 3; d < fileDims.size(); ++d)
+    if (fileDims[d] != 1)
+      throw runtime_error("3D samples are not supported");
+
+  std::vector<double> raw;
+  int numRead = readSamples(path, first, count, raw, dims);
+  size_t sampleSize = 1;
+  for (int d : dims)
+    sampleSize *= d;
+
+  vals.assign(sampleSize * count, 0);
+  for (size_t e = 0; e < sampleSize; ++e) {
+    double* dst = vals.data() + e * count;
+    for (int s = 0; s < numRead; ++s)
+      dst[s] = raw[s * sampleSize + e];
+  }
+}
+
 std::vector<double> H5Parser::parseBias(const string& path) const
 {
   string var = path + "/bias:0";
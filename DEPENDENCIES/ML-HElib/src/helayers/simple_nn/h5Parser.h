@@ -69,6 +69,46 @@ public:
                 std::vector<double>& vals,
                 std::vector<int>& dims) const;
 
+  /// Returns the dimensions of the tensor at the given path, without reading
+  /// its data.
+  /// @param[in] path    The path of the tensor.
+  std::vector<int> getDims(const std::string& path) const;
+
+  /// Reads samples [first, first + count) of the tensor at the given path,
+  /// whose first dimension indexes the samples, using a single hyperslab so
+  /// that only these samples are read from the file. Returns the number of
+  /// samples read, which is less than "count" at the end of the tensor.
+  /// @param[in] path     The path to read from.
+  /// @param[in] first    Index of the first sample to read.
+  /// @param[in] count    Maximal number of samples to read.
+  /// @param[out] vals    The samples read, flattened in file order.
+  /// @param[out] dims    The dimensions of a single sample.
+  int readSamples(const std::string& path,
+                  int first,
+                  int count,
+                  std::vector<double>& vals,
+                  std::vector<int>& dims) const;
+
+  /// Reads samples [first, first + count) of the tensor at the given path,
+  /// whose first dimension indexes the samples, directly into the layout of
+  /// tile slots: element e of sample s is stored at vals[e * count + s].
+  /// The values of each tile are then a contiguous slice, which can be handed
+  /// to CipherMatrixEncoder as is. Samples past the end of the tensor are
+  /// zero.
+  /// Samples must be matrices: all sample dimensions past the second must
+  /// be 1.
+  /// @param[in] path     The path to read from.
+  /// @param[in] first    Index of the first sample to read.
+  /// @param[in] count    Number of samples to read.
+  /// @param[out] vals    The packed values.
+  /// @param[out] dims    The dimensions of a single sample.
+  /// @throw runtime_error if the samples are 3D.
+  void readSlotPacked(const std::string& path,
+                      int first,
+                      int count,
+                      std::vector<double>& vals,
+                      std::vector<int>& dims) const;
+
   /// Reads the tensor from the given path into "vals".
   /// @param[in] path     The path to read from
   /// @param[out] vals    This tensor will contain the tensor read from the
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include "Benchmarks.h"
+#include "helayers/simple_nn/CipherMatrixEncoder.h"
+#include "helayers/simple_nn/SimpleFcLayer.h"
+#include "helayers/simple_nn/SimpleFcPlainLayer.h"
+#include "helayers/simple_nn/SimpleSquareActivationLayer.h"
+
+using namespace helayers;
+using namespace boost::numeric::ublas;
+using namespace std;
+
+// Counts every heap allocation made by this executable. The replacements
+// below apply to the whole executable, so this benchmark is built on its
+// own, as mlhelib_allocation_benchmark. The default array and nothrow forms
+// call these.
+static atomic<int64_t> numAllocations(0);
+
+void* operator new(size_t size)
+{
+  ++numAllocations;
+  if (void* p = malloc(size == 0 ? 1 : size))
+    return p;
+  throw bad_alloc();
+}
+
+void* operator new(size_t size, align_val_t align)
+{
+  ++numAllocations;
+  // aligned_alloc requires a non-zero multiple of the alignment.
+  size_t alignment = static_cast<size_t>(align);
+  size_t rounded = max<size_t>(1, (size + alignment - 1) / alignment);
+  rounded *= alignment;
+  if (void* p = aligned_alloc(alignment, rounded))
+    return p;
+  throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void operator delete(void* p, align_val_t) noexcept { free(p); }
+
+void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
+
+namespace helayerstest {
+
+void allocationBenchmark(HeContext& he)
+{
+  const int repeats = 3;
+  // Layer widths of the fraud detection network.
+  const std::vector<int> dims{29, 20, 5, 1};
+  const int numSlots = he.slotCount();
+
+  std::vector<shared_ptr<SimpleFcLayer>> fcLayers;
+  for (size_t i = 0; i + 1 < dims.size(); ++i) {
+    SimpleFcPlainLayer plain;
+    plain.initSize(dims[i + 1], dims[i], numSlots);
+    plain.initWeightsRandom();
+    auto layer = make_shared<SimpleFcLayer>(he);
+    layer->initFromLayer(plain);
+    fcLayers.push_back(layer);
+  }
+  SimpleSquareActivationLayer activation;
+
+  tensor<double> vals{(size_t)dims[0], 1, (size_t)numSlots};
+  for (auto& v : vals)
+    v = ((double)(rand() % 1000)) / 1000;
+  CipherMatrix input(he);
+  CipherMatrixEncoder(he).encodeEncrypt(input, vals);
+
+  auto forward = [&]() {
+    CipherMatrix cur = input;
+    for (size_t i = 0; i < fcLayers.size(); ++i) {
+      cur = fcLayers[i]->forward(cur);
+      if (i + 1 < fcLayers.size())
+        cur = activation.forward(cur);
+    }
+  };
+
+  for (bool cow : {false, true}) {
+    CTile::setCopyOnWrite(cow);
+    int64_t before = numAllocations;
+    int64_t t = measureMicros(repeats, forward);
+    int64_t allocs = (numAllocations - before) / repeats;
+    ostringstream title;
+    title << "fraud forward, copy-on-write " << (cow ? "on" : "off");
+    printResult(title.str(), t, repeats);
+    cout << "  " << allocs << " allocations per inference" << endl;
+  }
+  CTile::setCopyOnWrite(false);
+}
+
+} // namespace helayerstest
@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEST_HELAYERS_BENCHMARKS_H_
+#define TEST_HELAYERS_BENCHMARKS_H_
+
+#include <chrono>
+#include <string>
+#include "helayers/hebase/hebase.h"
+#include "helayers/hebase/helib/HelibCkksContext.h"
+
+namespace helayerstest {
+
+/// Returns wall time in microseconds of running f the given number of times.
+template <typename F>
+std::int64_t measureMicros(int repeats, F f)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < repeats; ++i)
+    f();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+      .count();
+}
+
+/// Prints a single benchmark result line.
+void printResult(const std::string& title,
+                 std::int64_t micros,
+                 int repeats,
+                 std::int64_t bytes = -1);
+
+/// Compares raw, compressed and compacted serialization of contexts and
+/// ciphertexts.
+void serializationBenchmark(helayers::HeContext& he);
+
+/// Measures CipherMatrixEncoder encryption and decryption throughput with a
+/// single thread and with all available threads.
+void cipherMatrixEncoderBenchmark(helayers::HeContext& he);
+
+/// Counts heap allocations of an encrypted forward pass through the fraud
+/// detection network, with CTile copy-on-write disabled and enabled.
+/// Built into mlhelib_allocation_benchmark only, since it replaces the
+/// global allocation functions.
+void allocationBenchmark(helayers::HeContext& he);
+
+/// Compares repeated plaintext operations with and without preparing the
+/// plaintext first.
+void preparedPlaintextBenchmark(helayers::HeContext& he);
+
+/// Compares cheap operations through CTile and through HelibCkksCTile.
+void staticCTileBenchmark(helayers::HelibCkksContext& he);
+
+} // namespace helayerstest
+
+#endif /* TEST_HELAYERS_BENCHMARKS_H_ */
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iomanip>
+#include <sstream>
+#include "Benchmarks.h"
+#include "helayers/simple_nn/CipherMatrixEncoder.h"
+
+using namespace helayers;
+using namespace boost::numeric::ublas;
+using namespace std;
+
+namespace helayerstest {
+
+void cipherMatrixEncoderBenchmark(HeContext& he)
+{
+  const int repeats = 3;
+  const size_t numRows = 4;
+  const size_t numCols = 8;
+  const size_t numSlots = he.slotCount();
+
+  tensor<double> vals{numRows, numCols, numSlots};
+  for (auto& v : vals)
+    v = ((double)(rand() % 1000)) / 1000;
+
+  CipherMatrixEncoder encoder(he);
+  int maxThreads = CipherMatrix::getNumThreads();
+  std::vector<int> threadCounts{1};
+  if (maxThreads > 1)
+    threadCounts.push_back(maxThreads);
+
+  for (int threads : threadCounts) {
+    CipherMatrix::setNumThreads(threads);
+    ostringstream title;
+    title << numRows * numCols << " tiles, " << threads << " threads";
+
+    CipherMatrix cm(he);
+    int64_t t =
+        measureMicros(repeats, [&]() { encoder.encodeEncrypt(cm, vals); });
+    printResult(title.str() + " encrypt", t, repeats);
+    cout << "  " << fixed << setprecision(1)
+         << (double)numRows * numCols * repeats * 1000000 / t
+         << " tiles/sec" << endl;
+
+    t = measureMicros(repeats, [&]() { encoder.decryptDecodeDouble(cm); });
+    printResult(title.str() + " decrypt", t, repeats);
+    cout << "  " << fixed << setprecision(1)
+         << (double)numRows * numCols * repeats * 1000000 / t
+         << " tiles/sec" << endl;
+  }
+  CipherMatrix::setNumThreads(0);
+}
+
+} // namespace helayerstest
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+
+using namespace helayers;
+using namespace std;
+
+namespace helayerstest {
+
+void preparedPlaintextBenchmark(HeContext& he)
+{
+  const int repeats = 100;
+
+  vector<double> vals(he.slotCount());
+  for (double& v : vals)
+    v = ((double)(rand() % 1000)) / 1000;
+
+  Encoder enc(he);
+  CTile c(he);
+  enc.encodeEncrypt(c, vals);
+  PTile p(he);
+  enc.encode(p, vals);
+
+  for (bool prepared : {false, true}) {
+    if (prepared) {
+      int64_t t = measureMicros(1, [&]() { enc.prepare(p); });
+      printResult("prepare", t, 1);
+    }
+    string title = prepared ? "prepared " : "";
+
+    // Each operation runs on a fresh copy, to keep the level fixed, so the
+    // times include copying the ciphertext.
+    int64_t t = measureMicros(repeats, [&]() {
+      CTile tmp(c);
+      tmp.multiplyPlain(p);
+    });
+    printResult(title + "multiplyPlain", t, repeats);
+
+    t = measureMicros(repeats, [&]() {
+      CTile tmp(c);
+      tmp.addPlain(p);
+    });
+    printResult(title + "addPlain", t, repeats);
+  }
+}
+
+} // namespace helayerstest
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sstream>
+#include "Benchmarks.h"
+#include "helayers/hebase/utils/BinIoUtils.h"
+
+using namespace helayers;
+using namespace std;
+
+namespace helayerstest {
+
+namespace {
+
+void benchmarkSaveable(const string& title, Saveable& obj, int repeats)
+{
+  string raw;
+  int64_t t = measureMicros(repeats, [&]() {
+    ostringstream out;
+    obj.save(out);
+    raw = out.str();
+  });
+  printResult(title + " save", t, repeats, raw.size());
+
+  string compressed;
+  t = measureMicros(repeats, [&]() {
+    ostringstream out;
+    obj.saveCompressed(out);
+    compressed = out.str();
+  });
+  printResult(title + " saveCompressed", t, repeats, compressed.size());
+
+  t = measureMicros(repeats, [&]() {
+    istringstream in(compressed);
+    obj.loadCompressed(in);
+  });
+  printResult(title + " loadCompressed", t, repeats, compressed.size());
+}
+
+} // namespace
+
+void serializationBenchmark(HeContext& he)
+{
+  const int repeats = 10;
+
+  cout << "Context:" << endl;
+  for (bool withSecretKey : {false, true}) {
+    string name = withSecretKey ? "client context" : "server context";
+    ostringstream raw;
+    int64_t t = measureMicros(1, [&]() { he.save(raw, withSecretKey); });
+    printResult(name + " save", t, 1, raw.str().size());
+
+    ostringstream compressed;
+    t = measureMicros(1, [&]() {
+      BinIoUtils::writeCompressed(compressed, raw.str());
+    });
+    printResult(name + " compress", t, 1, compressed.str().size());
+  }
+
+  cout << "Ciphertext:" << endl;
+  Encoder enc(he);
+  vector<double> vals(he.slotCount());
+  for (size_t i = 0; i < vals.size(); ++i)
+    vals[i] = ((double)(rand() % 1000)) / 1000;
+
+  CTile fresh(he);
+  enc.encodeEncrypt(fresh, vals);
+  benchmarkSaveable("fresh", fresh, repeats);
+
+  CTile multiplied(fresh);
+  multiplied.multiply(fresh);
+  benchmarkSaveable("after multiply", multiplied, repeats);
+
+  CTile compacted(multiplied);
+  int64_t t = measureMicros(1, [&]() { compacted.compact(); });
+  printResult("compact", t, 1);
+  benchmarkSaveable("after multiply+compact", compacted, repeats);
+}
+
+} // namespace helayerstest
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "helayers/hebase/helib/HelibCkksCiphertext.h"
+#include "helayers/hebase/helib/HelibCkksPlaintext.h"
+
+using namespace helayers;
+using namespace std;
+
+namespace helayerstest {
+
+void staticCTileBenchmark(HelibCkksContext& he)
+{
+  const int repeats = 1000;
+
+  vector<double> vals(he.slotCount());
+  for (double& v : vals)
+    v = ((double)(rand() % 1000)) / 1000;
+
+  Encoder enc(he);
+  CTile c(he), other(he);
+  enc.encodeEncrypt(c, vals);
+  enc.encodeEncrypt(other, vals);
+  PTile p(he);
+  enc.encode(p, vals);
+
+  int64_t t = measureMicros(repeats, [&]() { c.add(other); });
+  printResult("CTile add", t, repeats);
+  t = measureMicros(repeats, [&]() { c.addPlain(p); });
+  printResult("CTile addPlain", t, repeats);
+  t = measureMicros(repeats, [&]() { c.multiplyScalar(1.0); });
+  printResult("CTile multiplyScalar", t, repeats);
+
+  HelibCkksCTile s(c), sOther(other);
+  const HelibCkksPlaintext& sp = HelibCkksCTile::plainOf(p);
+  t = measureMicros(repeats, [&]() { s.add(sOther); });
+  printResult("HelibCkksCTile add", t, repeats);
+  t = measureMicros(repeats, [&]() { s.addPlain(sp); });
+  printResult("HelibCkksCTile addPlain", t, repeats);
+  t = measureMicros(repeats, [&]() { s.multiplyScalar(1.0); });
+  printResult("HelibCkksCTile multiplyScalar", t, repeats);
+}
+
+} // namespace helayerstest
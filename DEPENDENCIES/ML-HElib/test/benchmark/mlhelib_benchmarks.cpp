@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "helayers/hebase/helib/HelibCkksContext.h"
+
+using namespace helayers;
+using namespace helayerstest;
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  string arg = "";
+  if (argc > 1) {
+    arg = argv[1];
+  }
+
+  HelibCkksContext he;
+  he.init(4096 * 2 * 2, 50, 300);
+  he.printSignature(cout);
+
+  if (arg == "serialization")
+    serializationBenchmark(he);
+  else if (arg == "encoder")
+    cipherMatrixEncoderBenchmark(he);
+  else if (arg == "prepared")
+    preparedPlaintextBenchmark(he);
+  else if (arg == "static")
+    staticCTileBenchmark(he);
+  else {
+    cout << "Usage: " << argv[0] << " <benchmarkName>" << endl
+         << "\t<benchmarkName> can be:" << endl
+         << "\t\tserialization" << endl
+         << "\t\tencoder" << endl
+         << "\t\tprepared" << endl
+         << "\t\tstatic" << endl;
+    exit(1);
+  }
+}
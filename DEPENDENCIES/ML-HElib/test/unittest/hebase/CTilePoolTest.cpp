@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/hebase/hebase.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+TEST(CTilePoolTest, recycle)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+  CTilePool pool(he, 2);
+
+  vector<double> v1{1, 2, 3}, v2{4, 5, 6};
+  CTile c1(he), c2(he);
+  enc.encodeEncrypt(c1, v1);
+  enc.encodeEncrypt(c2, v2);
+
+  const AbstractCiphertext* first;
+  {
+    CTile tmp = pool.copyOf(c1);
+    first = &static_cast<const CTile&>(tmp).getImpl();
+    enc.assertEquals(tmp, "copy", v1);
+    EXPECT_EQ(0, pool.size());
+  }
+  EXPECT_EQ(1, pool.size());
+  EXPECT_EQ(1, pool.getMisses());
+
+  // the released ciphertext is reused for the next copy
+  CTile tmp = pool.copyOf(c2);
+  EXPECT_EQ(first, &static_cast<const CTile&>(tmp).getImpl());
+  EXPECT_EQ(1, pool.getHits());
+  enc.assertEquals(tmp, "recycled copy", v2);
+
+  // modifying a pooled copy leaves the source unchanged
+  tmp.add(c1);
+  enc.assertEquals(tmp, "sum", vector<double>{5, 7, 9});
+  enc.assertEquals(c2, "source", v2);
+}
+
+TEST(CTilePoolTest, capacityAndClear)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+  CTilePool pool(he, 1);
+
+  CTile c(he);
+  enc.encodeEncrypt(c, vector<double>{1});
+  {
+    CTile t1 = pool.copyOf(c);
+    CTile t2 = pool.copyOf(c);
+  }
+  EXPECT_EQ(1, pool.size());
+
+  // ciphertexts in use when clearing are not returned
+  CTile t = pool.copyOf(c);
+  pool.clear();
+  t = CTile(he);
+  EXPECT_EQ(0, pool.size());
+
+  pool.setCapacity(0);
+  { CTile t1 = pool.copyOf(c); }
+  EXPECT_EQ(0, pool.size());
+}
+
+TEST(CTilePoolTest, innerSum)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+  CTilePool& pool = he.getCTilePool();
+
+  CTile c(he);
+  enc.encodeEncrypt(c, vector<double>(he.slotCount(), 1));
+  c.innerSum(1, 8);
+  pool.resetCounters();
+  c.innerSum(1, 8);
+  EXPECT_EQ(3, pool.getHits());
+  EXPECT_EQ(0, pool.getMisses());
+  enc.assertEquals(c, "innerSum", vector<double>(he.slotCount(), 64));
+}
+} // namespace helayerstest
@@ -308,6 +308,203 @@ TEST(CTileTest, multiplyRaw)
     EXPECT_NE(src.getScale(), origScale);
 }
 
+TEST(CTileTest, lazyMaintenance)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  std::vector<double> v1(he.slotCount()), v2(he.slotCount()),
+      expectedVals(he.slotCount());
+
+  for (int i = 0; i < he.slotCount(); i++) {
+    v1[i] = ((double)(rand() % 1000)) / 1000;
+    v2[i] = ((double)(rand() % 1000)) / 1000;
+    expectedVals[i] = v1[i] * v2[i] + v2[i] * v2[i];
+  }
+
+  CTile c1(he);
+  CTile c2(he);
+  enc.encodeEncrypt(c1, v1);
+  enc.encodeEncrypt(c2, v2);
+
+  c1.multiplyRaw(c2);
+  c1.relinearizeLazy();
+  c1.rescaleLazy();
+  EXPECT_TRUE(c1.hasPendingMaintenance());
+
+  CTile sq(c2);
+  sq.squareRaw();
+  sq.relinearizeLazy();
+  sq.rescaleLazy();
+
+  // same pending state, so it is kept through the addition
+  c1.add(sq);
+  EXPECT_TRUE(c1.hasPendingMaintenance());
+
+  // copies carry the pending state
+  CTile copy(c1);
+  EXPECT_TRUE(copy.hasPendingMaintenance());
+
+  // reading a CTile doesn't modify it
+  enc.assertEquals(c1, "lazyMaintenance", expectedVals, TestUtils::getEps());
+  EXPECT_TRUE(c1.hasPendingMaintenance());
+
+  // a rescale pending on one operand only stays pending, the other operand
+  // being added once it is performed, and the operands aren't modified
+  CTile sum(c2);
+  sum.add(c1);
+  EXPECT_TRUE(sum.hasPendingMaintenance());
+  EXPECT_TRUE(c1.hasPendingMaintenance());
+  std::vector<double> expectedSum(he.slotCount()),
+      expectedDiff(he.slotCount());
+  for (int i = 0; i < he.slotCount(); i++) {
+    expectedSum[i] = expectedVals[i] + v2[i];
+    expectedDiff[i] = v2[i] - 2 * expectedVals[i];
+  }
+  enc.assertEquals(sum, "lazyMaintenanceSum", expectedSum, TestUtils::getEps());
+
+  CTile diff(sum);
+  diff.negate();
+  diff.add(c2);
+  diff.add(c2);
+  diff.sub(c1);
+  EXPECT_TRUE(diff.hasPendingMaintenance());
+  enc.assertEquals(
+      diff, "lazyMaintenanceDiff", expectedDiff, TestUtils::getEps());
+
+  copy.flushMaintenance();
+  EXPECT_FALSE(copy.hasPendingMaintenance());
+  enc.assertEquals(copy, "lazyMaintenance", expectedVals, TestUtils::getEps());
+}
+
+TEST(CTileTest, multiplyAdd)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  std::vector<double> v1(he.slotCount()), v2(he.slotCount()),
+      expectedVals(he.slotCount()), expectedVals2(he.slotCount());
+
+  for (int i = 0; i < he.slotCount(); i++) {
+    v1[i] = ((double)(rand() % 1000)) / 1000;
+    v2[i] = ((double)(rand() % 1000)) / 1000;
+    expectedVals[i] = v1[i] * v2[i] + v2[i] * v2[i];
+    expectedVals2[i] = v1[i] + expectedVals[i];
+  }
+
+  CTile c1(he);
+  CTile c2(he);
+  enc.encodeEncrypt(c1, v1);
+  enc.encodeEncrypt(c2, v2);
+
+  // starting from an empty accumulator
+  CTile acc(he);
+  acc.multiplyAdd(c1, c2);
+  acc.multiplyAdd(c2, c2);
+  EXPECT_TRUE(acc.hasPendingMaintenance());
+  enc.assertEquals(acc, "multiplyAdd", expectedVals, TestUtils::getEps());
+
+  // starting from a regular ciphertext, which is added once the maintenance
+  // of the products is performed
+  CTile acc2(c1);
+  acc2.multiplyAdd(c1, c2);
+  acc2.multiplyAdd(c2, c2);
+  EXPECT_TRUE(acc2.hasPendingMaintenance());
+  enc.assertEquals(acc2, "multiplyAdd", expectedVals2, TestUtils::getEps());
+
+  // computing the products in a buffer
+  CTile acc3(he);
+  CTile buffer(he);
+  acc3.multiplyAdd(c1, c2, buffer);
+  acc3.multiplyAdd(c2, c2, buffer);
+  enc.assertEquals(acc3, "multiplyAdd", expectedVals, TestUtils::getEps());
+  acc3.flushMaintenance();
+  acc3.multiplyAdd(c1, c2, buffer);
+  acc3.multiplyAdd(c2, c2, buffer);
+  for (int i = 0; i < he.slotCount(); i++)
+    expectedVals[i] *= 2;
+  enc.assertEquals(acc3, "multiplyAdd", expectedVals, TestUtils::getEps());
+}
+
+TEST(CTileTest, dotProductAndSum)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  const int n = 5;
+  std::vector<CTile> a(n, CTile(he)), b(n, CTile(he));
+  std::vector<double> expectedDot(he.slotCount(), 0),
+      expectedSum(he.slotCount(), 0);
+
+  for (int k = 0; k < n; k++) {
+    std::vector<double> va(he.slotCount()), vb(he.slotCount());
+    for (int i = 0; i < he.slotCount(); i++) {
+      va[i] = ((double)(rand() % 1000)) / 1000;
+      vb[i] = ((double)(rand() % 1000)) / 1000;
+      expectedDot[i] += va[i] * vb[i];
+      expectedSum[i] += va[i];
+    }
+    enc.encodeEncrypt(a[k], va);
+    enc.encodeEncrypt(b[k], vb);
+  }
+
+  CTile dot = CTile::dotProduct(a, b);
+  enc.assertEquals(dot, "dotProduct", expectedDot, TestUtils::getEps());
+
+  CTile serialDot = CTile::dotProduct(a, b, 1);
+  enc.assertEquals(serialDot, "dotProduct", expectedDot, TestUtils::getEps());
+
+  CTile sum = CTile::sum(a);
+  enc.assertEquals(sum, "sum", expectedSum, TestUtils::getEps());
+
+  CTile single = CTile::sum(std::vector<CTile>(1, a[0]));
+  enc.assertEquals(single, "sum", enc.decryptDecodeDouble(a[0]));
+
+  EXPECT_THROW(CTile::sum(std::vector<CTile>()), invalid_argument);
+  b.pop_back();
+  EXPECT_THROW(CTile::dotProduct(a, b), invalid_argument);
+}
+
+TEST(CTileTest, moveAndCopyOnWrite)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  std::vector<double> vals(he.slotCount()), squares(he.slotCount());
+  for (int i = 0; i < he.slotCount(); i++) {
+    vals[i] = ((double)(rand() % 1000)) / 1000;
+    squares[i] = vals[i] * vals[i];
+  }
+  CTile c(he);
+  enc.encodeEncrypt(c, vals);
+
+  CTile moved(std::move(c));
+  enc.assertEquals(moved, "moved", vals, TestUtils::getEps());
+  c = std::move(moved);
+  enc.assertEquals(c, "move assigned", vals, TestUtils::getEps());
+
+  // The non-const getImpl() detaches, so compare through const references.
+  auto implOf = [](const CTile& t) { return &t.getImpl(); };
+
+  CTile::setCopyOnWrite(true);
+  EXPECT_TRUE(CTile::getCopyOnWrite());
+  CTile shared(c);
+  EXPECT_EQ(implOf(c), implOf(shared));
+  shared.square();
+  EXPECT_NE(implOf(c), implOf(shared));
+  enc.assertEquals(c, "original", vals, TestUtils::getEps());
+  enc.assertEquals(shared, "modified copy", squares, TestUtils::getEps());
+
+  // A copy taken while maintenance is pending gets its own ciphertext.
+  CTile lazy(c);
+  lazy.multiplyRaw(c);
+  lazy.relinearizeLazy();
+  CTile lazyCopy(lazy);
+  EXPECT_NE(implOf(lazy), implOf(lazyCopy));
+  enc.assertEquals(lazyCopy, "lazy copy", squares, TestUtils::getEps());
+  CTile::setCopyOnWrite(false);
+}
+
 TEST(CTileTest, addPlain)
 {
   HeContext& he = TestUtils::getHighNumSlots();
@@ -758,6 +955,39 @@ TEST(CTileTest, rotate)
   }
 }
 
+TEST(CTileTest, rotateMany)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+
+  Encoder enc(he);
+  std::vector<double> v1;
+  for (int i = 0; i < he.slotCount(); ++i)
+    v1.push_back(0.1 + i * 0.1);
+  std::vector<int> rots{1, -1, 0, 2, 4, 5, -7};
+  CTile c1(he);
+  enc.encodeEncrypt(c1, v1);
+  std::vector<CTile> res = c1.rotateMany(rots);
+  ASSERT_EQ(rots.size(), res.size());
+
+  for (size_t r = 0; r < rots.size(); ++r) {
+    const std::vector<double> vals = enc.decryptDecodeDouble(res[r]);
+    for (size_t i = 0; i < v1.size(); ++i) {
+      int rotInd = i - rots[r];
+      while (rotInd < 0) {
+        rotInd += he.slotCount();
+      }
+      rotInd %= he.slotCount();
+
+      EXPECT_NEAR(v1[i], vals[rotInd], TestUtils::getEps());
+    }
+  }
+
+  // source is left untouched
+  const std::vector<double> vals = enc.decryptDecodeDouble(c1);
+  for (size_t i = 0; i < v1.size(); ++i)
+    EXPECT_NEAR(v1[i], vals[i], TestUtils::getEps());
+}
+
 TEST(CTileTest, encrypt)
 {
   HeContext& he = TestUtils::getHighNumSlots();
@@ -1078,4 +1308,31 @@ TEST(CTileTest, saveLoad)
 
   enc.assertEquals(c2, "saveLoadTest", v1, TestUtils::getEps());
 }
+
+TEST(CTileTest, saveLoadCompressed)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+
+  std::vector<double> v1(he.slotCount());
+
+  for (double& val : v1) {
+    val = ((double)(rand() % 1000)) / 1000;
+  }
+
+  CTile c1(he);
+  CTile c2(he);
+  Encoder enc(he);
+  enc.encodeEncrypt(c1, v1);
+  c1.multiplyScalar(1.0);
+  c1.compact();
+  enc.assertEquals(c1, "compact", v1, TestUtils::getEps());
+
+  TestUtils::createOutputDirectory();
+  std::string outFile =
+      TestUtils::getOutputDirectory() + "/CTileSaveLoadCompressedTest.tmp";
+  c1.saveToFile(outFile, true);
+  c2.loadFromFile(outFile, true);
+
+  enc.assertEquals(c2, "saveLoadCompressedTest", v1, TestUtils::getEps());
+}
 } // namespace helayerstest
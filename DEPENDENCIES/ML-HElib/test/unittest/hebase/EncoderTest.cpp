@@ -217,6 +217,109 @@ TEST(EncoderTest, encodeEncryptAndDecryptDecodeComplex)
   EXPECT_FLOAT_EQ(2, vals[0].imag());
 }
 
+TEST(EncoderTest, encodeDecodeBuffers)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  double v[] = {2.51, 3.2, -5.3};
+
+  PTile p(he);
+  enc.encode(p, v, 3);
+  double decoded[4];
+  enc.decodeDouble(p, decoded, 4);
+  for (int i = 0; i < 3; i++)
+    EXPECT_NEAR(v[i], decoded[i], TestUtils::getEps());
+  // slots beyond the given values are zero padded
+  EXPECT_NEAR(0, decoded[3], TestUtils::getEps());
+
+  CTile c(he);
+  enc.encodeEncrypt(c, v, 3);
+  double decrypted[3];
+  enc.decryptDecodeDouble(c, decrypted, 3);
+  for (int i = 0; i < 3; i++)
+    EXPECT_NEAR(v[i], decrypted[i], TestUtils::getEps());
+
+  vector<double> tooLong(he.slotCount() + 1);
+  EXPECT_THROW(enc.encode(p, tooLong.data(), tooLong.size()), runtime_error);
+  EXPECT_THROW(enc.decryptDecodeDouble(c, tooLong.data(), tooLong.size()),
+               runtime_error);
+}
+
+// Records the number of values passed to the vector based encode variants.
+class SizeRecordingEncoder : public AbstractEncoder
+{
+public:
+  mutable size_t lastSize = 0;
+
+  void encode(AbstractPlaintext&,
+              const vector<double>& vals,
+              int) const override
+  {
+    lastSize = vals.size();
+  }
+  void encode(AbstractPlaintext&,
+              const vector<complex<double>>& vals,
+              int) const override
+  {
+    lastSize = vals.size();
+  }
+  vector<double> decodeDouble(const AbstractPlaintext&) const override
+  {
+    return {};
+  }
+  vector<complex<double>> decodeComplex(const AbstractPlaintext&) const override
+  {
+    return {};
+  }
+  void encrypt(AbstractCiphertext&, const AbstractPlaintext&) const override {}
+  void decrypt(AbstractPlaintext&, const AbstractCiphertext&) const override {}
+  void encodeEncrypt(AbstractCiphertext&,
+                     const vector<double>& vals,
+                     int) const override
+  {
+    lastSize = vals.size();
+  }
+  void encodeEncrypt(AbstractCiphertext&,
+                     const vector<complex<double>>& vals,
+                     int) const override
+  {
+    lastSize = vals.size();
+  }
+  vector<double> decryptDecodeDouble(const AbstractCiphertext&) const override
+  {
+    return {};
+  }
+  vector<complex<double>> decryptDecodeComplex(
+      const AbstractCiphertext&) const override
+  {
+    return {};
+  }
+};
+
+TEST(EncoderTest, bufferDefaultsPadToSlots)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  ASSERT_FALSE(he.getTraits().getIsDebugEmpty());
+  SizeRecordingEncoder recorder;
+  const AbstractEncoder& enc = recorder;
+  shared_ptr<AbstractPlaintext> p = he.createAbstractPlain();
+  shared_ptr<AbstractCiphertext> c = he.createAbstractCipher();
+
+  // Encoders implementing only the vector based variants get a value for
+  // every slot, as Encoder passes vectors to them.
+  double v[] = {2.51, 3.2, -5.3};
+  complex<double> cv[] = {{1, 2}, {3, 4}};
+  enc.encode(*p, v, 3, -1);
+  EXPECT_EQ(he.slotCount(), recorder.lastSize);
+  enc.encode(*p, cv, 2, -1);
+  EXPECT_EQ(he.slotCount(), recorder.lastSize);
+  enc.encodeEncrypt(*c, v, 3, -1);
+  EXPECT_EQ(he.slotCount(), recorder.lastSize);
+  enc.encodeEncrypt(*c, cv, 2, -1);
+  EXPECT_EQ(he.slotCount(), recorder.lastSize);
+}
+
 TEST(EncoderTest, assertEquals)
 {
   HeContext& he = TestUtils::getHighNumSlots();
@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/hebase/hebase.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+TEST(EncryptionPoolTest, encrypt)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  shared_ptr<EncryptionPool> pool = make_shared<EncryptionPool>(he, 3);
+  pool->waitUntilFull();
+  EXPECT_EQ(3, pool->size());
+  EXPECT_EQ(3, pool->getGenerated());
+
+  Encoder enc(he);
+  enc.setEncryptionPool(pool);
+  vector<double> v1{1, 2, 3}, v2{-4, 5.5, 6};
+  CTile c1(he), c2(he);
+  enc.encodeEncrypt(c1, v1);
+  PTile p(he);
+  enc.encode(p, v2);
+  enc.encrypt(c2, p);
+  EXPECT_EQ(2, pool->getHits());
+  EXPECT_EQ(0, pool->getMisses());
+  enc.assertEquals(c1, "pooled encodeEncrypt", v1, TestUtils::getEps());
+  enc.assertEquals(c2, "pooled encrypt", v2, TestUtils::getEps());
+
+  // pooled ciphertexts are fresh ones, usable in further operations
+  c1.multiply(c2);
+  enc.assertEquals(
+      c1, "product", vector<double>{-4, 11, 18}, TestUtils::getEps());
+
+  // the background thread refills the pool
+  pool->waitUntilFull();
+  EXPECT_EQ(3, pool->size());
+  EXPECT_EQ(5, pool->getGenerated());
+  EXPECT_GT(pool->getRefillRate(), 0);
+}
+
+TEST(EncryptionPoolTest, emptyPool)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  shared_ptr<EncryptionPool> pool = make_shared<EncryptionPool>(he, 1);
+  pool->waitUntilFull();
+  pool->setCapacity(0);
+  EXPECT_EQ(0, pool->size());
+
+  // falls back to regular encryption
+  Encoder enc(he);
+  enc.setEncryptionPool(pool);
+  vector<double> v{1, 2, 3};
+  CTile c(he);
+  enc.encodeEncrypt(c, v);
+  enc.assertEquals(c, "encodeEncrypt", v, TestUtils::getEps());
+  EXPECT_EQ(0, pool->getHits());
+  EXPECT_EQ(1, pool->getMisses());
+  EXPECT_EQ(0, pool->getHitRate());
+
+  pool->setCapacity(2);
+  pool->waitUntilFull();
+  enc.encodeEncrypt(c, v);
+  EXPECT_EQ(0.5, pool->getHitRate());
+
+  pool->resetCounters();
+  EXPECT_EQ(0, pool->getHits());
+  EXPECT_EQ(0, pool->getGenerated());
+}
+
+} // namespace helayerstest
@@ -24,6 +24,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <cstdio>
+#include <cstdlib>
 #include "helayers/hebase/hebase.h"
 #include "TestUtils.h"
 #include "gtest/gtest.h"
@@ -144,4 +146,53 @@ TEST(HeContextTest, saveLoadNoSecKey)
 }
 
 TEST(HeContextTest, saveLoadWithSecKey) { saveLoadTest(true); }
+
+TEST(HeContextTest, estimatedLatencies)
+{
+  // keep the cache file out of ./cache, and start from a fresh context so
+  // that latencies measured by other tests are not reused
+  TestUtils::createOutputDirectory();
+  const char* prevCacheDir = getenv("HELAYERS_CACHE_DIR");
+  string savedCacheDir = prevCacheDir == NULL ? "" : prevCacheDir;
+  setenv("HELAYERS_CACHE_DIR", TestUtils::getOutputDirectory().c_str(), 1);
+  string contextFile =
+      TestUtils::getOutputDirectory() + "/HeContextLatencies.tmp";
+  TestUtils::getLowNumSlots().saveToFile(contextFile, true);
+  shared_ptr<HeContext> he = TestUtils::heContextFactory->create();
+  he->loadFromFile(contextFile);
+  string latenciesFile = he->getEstimatedLatenciesFile();
+  remove(latenciesFile.c_str());
+
+  shared_ptr<JsonWrapper> latencies = he->getEstimatedLatencies();
+  EXPECT_EQ(he->getSignature(), latencies->getString("signature"));
+  for (const string& op : {"encode",
+                           "encrypt",
+                           "decrypt",
+                           "add",
+                           "multiplyPlain",
+                           "multiplyRaw",
+                           "relinearize",
+                           "multiply",
+                           "rotate",
+                           "save",
+                           "load"})
+    EXPECT_GE(latencies->getDouble(op), 0) << op;
+  EXPECT_EQ(latencies, he->getEstimatedLatencies());
+  EXPECT_TRUE(FileUtils::fileExists(latenciesFile));
+
+  // a context with the same signature reads the latencies from the cache
+  // file instead of measuring them again
+  shared_ptr<HeContext> he2 = TestUtils::heContextFactory->create();
+  he2->loadFromFile(contextFile);
+  ASSERT_EQ(he->getSignature(), he2->getSignature());
+  shared_ptr<JsonWrapper> loaded = he2->getEstimatedLatencies();
+  EXPECT_EQ(latencies->getDouble("multiply"), loaded->getDouble("multiply"));
+  EXPECT_EQ(latencies->getDouble("rotate"), loaded->getDouble("rotate"));
+
+  remove(latenciesFile.c_str());
+  if (prevCacheDir == NULL)
+    unsetenv("HELAYERS_CACHE_DIR");
+  else
+    setenv("HELAYERS_CACHE_DIR", savedCacheDir.c_str(), 1);
+}
 } // namespace helayerstest
@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <omp.h>
+#include <sstream>
+#include <thread>
+#include "gtest/gtest.h"
+#include "helayers/hebase/HelayersTimer.h"
+#include "helayers/hebase/utils/JsonWrapper.h"
+
+using namespace helayers;
+using namespace std;
+
+namespace helayerstest {
+
+TEST(HelayersTimerTest, intern)
+{
+  int id = HelayersTimer::intern("HelayersTimerTest_intern");
+  EXPECT_EQ(id, HelayersTimer::intern("HelayersTimerTest_intern"));
+  EXPECT_NE(id, HelayersTimer::intern("HelayersTimerTest_intern2"));
+  EXPECT_EQ("HelayersTimerTest_intern", HelayersTimer::getSectionName(id));
+  EXPECT_THROW(HelayersTimer::getSectionName(-1), invalid_argument);
+}
+
+TEST(HelayersTimerTest, mergeThreads)
+{
+  HelayersTimer::reset();
+  const int iterations = 64;
+  int inner = HelayersTimer::intern("inner");
+
+  HelayersTimer::push("HelayersTimerTest_merge");
+#pragma omp parallel for num_threads(4)
+  for (int i = 0; i < iterations; ++i) {
+    HelayersTimer::Guard guard("HelayersTimerTest_merge");
+    HelayersTimer::push(inner);
+    HelayersTimer::pop();
+  }
+  HelayersTimer::pop();
+
+  // Visits by all workers are nested in the section open when the parallel
+  // region started.
+  EXPECT_EQ(1, HelayersTimer::getCount("HelayersTimerTest_merge"));
+  EXPECT_EQ(iterations,
+            HelayersTimer::getCount(
+                "HelayersTimerTest_merge.HelayersTimerTest_merge"));
+  EXPECT_EQ(iterations,
+            HelayersTimer::getCount(
+                "HelayersTimerTest_merge.HelayersTimerTest_merge.inner"));
+  EXPECT_THROW(HelayersTimer::getCount("HelayersTimerTest_merge.inner"),
+               invalid_argument);
+  EXPECT_THROW(HelayersTimer::pop(), runtime_error);
+}
+
+TEST(HelayersTimerTest, exitedThreads)
+{
+  HelayersTimer::reset();
+  const int numThreads = 8;
+  for (int i = 0; i < numThreads; ++i) {
+    thread t([]() { HELAYERS_TIMER_SECTION("HelayersTimerTest_exited"); });
+    t.join();
+  }
+
+  // Measures of exited threads are kept until reset.
+  EXPECT_EQ(numThreads, HelayersTimer::getCount("HelayersTimerTest_exited"));
+  HelayersTimer::reset();
+  EXPECT_THROW(HelayersTimer::getCount("HelayersTimerTest_exited"),
+               invalid_argument);
+}
+
+TEST(HelayersTimerTest, sampling)
+{
+  HelayersTimer::reset();
+  const int iterations = 100;
+  HelayersTimer::setSamplingRate(10);
+  for (int i = 0; i < iterations; ++i) {
+    HELAYERS_TIMER_SECTION("HelayersTimerTest_sampling");
+  }
+  HelayersTimer::setSamplingRate(1);
+  EXPECT_EQ(iterations, HelayersTimer::getCount("HelayersTimerTest_sampling"));
+  EXPECT_EQ(1, HelayersTimer::getSamplingRate());
+  EXPECT_THROW(HelayersTimer::setSamplingRate(0), invalid_argument);
+}
+
+TEST(HelayersTimerTest, exportJson)
+{
+  HelayersTimer::reset();
+  for (int i = 0; i < 3; ++i) {
+    HelayersTimer::Guard outer("HelayersTimerTest_json");
+    HelayersTimer::Guard inner("inner.dotted");
+  }
+
+  JsonWrapper jw;
+  HelayersTimer::exportJson(jw);
+  EXPECT_EQ(1, jw.getInt("samplingRate"));
+  EXPECT_EQ(3,
+            jw.getInt64("sections.subSections.HelayersTimerTest_json.count"));
+  EXPECT_EQ(3,
+            jw.getInt64ByPath({"sections",
+                               "subSections",
+                               "HelayersTimerTest_json",
+                               "subSections",
+                               "inner.dotted",
+                               "count"}));
+  EXPECT_EQ(HelayersTimer::getSum("HelayersTimerTest_json"),
+            jw.getInt64("sections.subSections.HelayersTimerTest_json.sum"));
+}
+
+TEST(HelayersTimerTest, exportChromeTrace)
+{
+  HelayersTimer::reset();
+  HelayersTimer::setTraceEnabled(true);
+  {
+    HelayersTimer::Guard guard("HelayersTimerTest_\"trace\"");
+  }
+  {
+    HELAYERS_TIMER("HelayersTimerTest_timer");
+  }
+  HelayersTimer::setTraceEnabled(false);
+  {
+    HelayersTimer::Guard guard("HelayersTimerTest_untraced");
+  }
+
+  stringstream trace;
+  HelayersTimer::exportChromeTrace(trace);
+  JsonWrapper jw;
+  jw.load(trace);
+  string str = trace.str();
+  EXPECT_NE(string::npos, str.find("HelayersTimerTest_\\\"trace\\\""));
+  EXPECT_NE(string::npos, str.find("HelayersTimerTest_timer"));
+  EXPECT_NE(string::npos, str.find("\"ph\":\"B\""));
+  EXPECT_NE(string::npos, str.find("\"ph\":\"E\""));
+  EXPECT_EQ(string::npos, str.find("HelayersTimerTest_untraced"));
+
+  HelayersTimer::clearTrace();
+  trace.str("");
+  HelayersTimer::exportChromeTrace(trace);
+  EXPECT_EQ(string::npos, trace.str().find("\"ph\""));
+}
+} // namespace helayerstest
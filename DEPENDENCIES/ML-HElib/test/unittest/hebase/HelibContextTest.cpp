@@ -0,0 +1,229 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sstream>
+#include "gtest/gtest.h"
+#include "helayers/hebase/hebase.h"
+#include "helayers/hebase/helib/HelibCkksContext.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+static HelibConfig lowNumSlotsConfig()
+{
+  HelibConfig conf;
+  conf.m = 16 * 2 * 2;
+  conf.r = 50;
+  conf.L = 1500;
+  return conf;
+}
+
+static void assertRotated(HeContext& he, int rot)
+{
+  Encoder enc(he);
+  vector<double> v;
+  for (int i = 0; i < he.slotCount(); ++i)
+    v.push_back(0.1 + i * 0.1);
+  CTile c(he);
+  enc.encodeEncrypt(c, v);
+  c.rotate(rot);
+
+  vector<double> vals = enc.decryptDecodeDouble(c);
+  for (int i = 0; i < he.slotCount(); ++i) {
+    int rotInd = ((i - rot) % he.slotCount() + he.slotCount()) % he.slotCount();
+    EXPECT_NEAR(v[i], vals[rotInd], TestUtils::getEps());
+  }
+}
+
+TEST(HelibContextTest, selectedRotationKeys)
+{
+  HelibCkksContext full;
+  full.init(lowNumSlotsConfig());
+
+  HelibConfig conf = lowNumSlotsConfig();
+  conf.rotations = {2, -4};
+  conf.addPowerOfTwoRotations = false;
+  HelibCkksContext he;
+  he.init(conf);
+
+  // the relinearization matrix and one per requested rotation
+  EXPECT_EQ(3, he.getNumKeySwitchingMatrices());
+  EXPECT_LT(he.getNumKeySwitchingMatrices(), full.getNumKeySwitchingMatrices());
+  EXPECT_LT(he.getKeySwitchingMatricesSize(),
+            full.getKeySwitchingMatricesSize());
+
+  EXPECT_EQ(0, he.getRotationCost(0));
+  EXPECT_EQ(0, he.getRotationCost(he.slotCount()));
+  EXPECT_EQ(1, he.getRotationCost(2));
+  EXPECT_EQ(1, he.getRotationCost(-4));
+  EXPECT_EQ(2, he.getRotationCost(4));
+  EXPECT_EQ(-1, he.getRotationCost(1));
+  assertRotated(he, 2);
+  assertRotated(he, -4);
+  assertRotated(he, 4);
+
+  he.addRotationKeys({1, 2});
+  EXPECT_EQ(4, he.getNumKeySwitchingMatrices());
+  EXPECT_EQ(1, he.getRotationCost(1));
+  assertRotated(he, 1);
+}
+
+TEST(HelibContextTest, powerOfTwoRotationKeys)
+{
+  HelibConfig conf = lowNumSlotsConfig();
+  conf.rotations = {3};
+  HelibCkksContext he;
+  he.init(conf);
+
+  // 16 slots: 3 and +-1, +-2, +-4, +-8, where 8 and -8 coincide
+  EXPECT_EQ(1 + 8, he.getNumKeySwitchingMatrices());
+  EXPECT_EQ(1, he.getRotationCost(3));
+  EXPECT_EQ(2, he.getRotationCost(5));
+  for (int rot = -he.slotCount() + 1; rot < he.slotCount(); ++rot) {
+    int cost = he.getRotationCost(rot);
+    EXPECT_GE(cost, rot % he.slotCount() == 0 ? 0 : 1);
+    EXPECT_LE(cost, 2);
+  }
+  assertRotated(he, 7);
+}
+
+TEST(HelibContextTest, recordRotations)
+{
+  HelibCkksContext full;
+  full.init(lowNumSlotsConfig());
+  Encoder enc(full);
+  vector<double> v(full.slotCount(), 1);
+
+  // a dry run of the workload finds the rotations it needs
+  full.setRecordRotations(true);
+  CTile c(full);
+  enc.encodeEncrypt(c, v);
+  c.innerSum(1, 8);
+  c.rotateMany({-1, 2});
+  full.setRecordRotations(false);
+  c.rotate(5);
+
+  map<int, long> recorded = full.getRecordedRotations();
+  map<int, long> expected{{-1, 1}, {1, 1}, {2, 2}, {4, 1}};
+  EXPECT_EQ(expected, recorded);
+
+  HelibConfig conf = lowNumSlotsConfig();
+  for (const auto& rec : recorded)
+    conf.rotations.push_back(rec.first);
+  conf.addPowerOfTwoRotations = false;
+  HelibCkksContext he;
+  he.init(conf);
+  for (const auto& rec : recorded)
+    EXPECT_EQ(1, he.getRotationCost(rec.first));
+
+  Encoder enc2(he);
+  CTile c2(he);
+  enc2.encodeEncrypt(c2, v);
+  c2.innerSum(1, 8);
+  enc2.assertEquals(c2,
+                    "innerSum",
+                    vector<double>(he.slotCount(), 8),
+                    TestUtils::getEps());
+
+  ostringstream report;
+  he.setRecordRotations(true);
+  c2.innerSum(1, 8);
+  he.printRotationReport(report);
+  EXPECT_NE(string::npos, report.str().find("rotate(4): 1 times"));
+
+  full.clearRecordedRotations();
+  EXPECT_TRUE(full.getRecordedRotations().empty());
+}
+
+TEST(HelibContextTest, squareRawDefersRelinearize)
+{
+  HelibCkksContext he;
+  he.init(lowNumSlotsConfig());
+  Encoder enc(he);
+  vector<double> v(he.slotCount(), 0.5);
+  CTile c(he);
+  enc.encodeEncrypt(c, v);
+
+  // Until relinearized, the square keeps a third ciphertext part, which shows
+  // in the size of the saved ciphertext.
+  c.squareRaw();
+  stringstream raw;
+  streamoff rawSize = c.save(raw);
+  c.relinearize();
+  stringstream relinearized;
+  EXPECT_GT(rawSize, c.save(relinearized));
+
+  vector<double> vals = enc.decryptDecodeDouble(c);
+  for (int i = 0; i < he.slotCount(); ++i)
+    EXPECT_NEAR(0.25, vals[i], TestUtils::getEps());
+}
+
+TEST(HelibContextTest, configRequirement)
+{
+  HeConfigRequirement req(128, 10, 30);
+  req.numSlots = 512;
+  req.multiplicationDepth = 2;
+  HelibConfig conf;
+  ostringstream rationale;
+  ASSERT_TRUE(conf.initRequirement(req, rationale));
+  EXPECT_EQ((unsigned long)-1, conf.p);
+  EXPECT_EQ(30UL, conf.r);
+  EXPECT_GE(conf.m / 4, 512UL);
+  EXPECT_NE(string::npos, rationale.str().find("Chosen"));
+
+  // a deeper computation needs a longer chain, and at least as many slots
+  req.multiplicationDepth = 6;
+  HelibConfig deeper;
+  ASSERT_TRUE(deeper.initRequirement(req, rationale));
+  EXPECT_GT(deeper.L, conf.L);
+  EXPECT_GE(deeper.m, conf.m);
+
+  req.securityLevel = 256;
+  req.multiplicationDepth = 20;
+  EXPECT_FALSE(deeper.initRequirement(req, rationale));
+
+  HelibCkksContext he;
+  EXPECT_FALSE(he.isConfigRequirementFeasible(req));
+
+  // an insecure requirement allows the smallest ring, and keeps this test fast
+  req.securityLevel = 0;
+  req.numSlots = 16;
+  req.multiplicationDepth = 1;
+  EXPECT_TRUE(he.isConfigRequirementFeasible(req));
+  he.init(req);
+  EXPECT_GE(he.slotCount(), 16);
+  EXPECT_NE(string::npos, he.getConfigRationale().find("HElib estimates"));
+
+  Encoder enc(he);
+  vector<double> v{0.5, 1, 1.5};
+  CTile c(he);
+  enc.encodeEncrypt(c, v);
+  c.multiply(c);
+  enc.assertEquals(c, "square", vector<double>{0.25, 1, 2.25}, 1e-3);
+}
+
+} // namespace helayerstest
@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/hebase/hebase.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+TEST(PTileCacheTest, hitsAndMisses)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  PTileCache& cache = he.getPTileCache();
+  cache.clear();
+  cache.resetCounters();
+
+  int chainIndex = he.getTopChainIndex();
+  auto p1 = cache.getScalar(3, chainIndex);
+  auto p2 = cache.getScalar(3, chainIndex);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(1, cache.getMisses());
+  EXPECT_EQ(1, cache.getHits());
+
+  cache.get(vector<double>{3}, chainIndex);
+  cache.getScalar(4, chainIndex);
+  EXPECT_EQ(3, cache.getMisses());
+  EXPECT_EQ(3, cache.size());
+
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  cache.getScalar(3, chainIndex);
+  EXPECT_EQ(4, cache.getMisses());
+}
+
+TEST(PTileCacheTest, lruEviction)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  PTileCache& cache = he.getPTileCache();
+  size_t capacity = cache.getCapacity();
+  cache.clear();
+  cache.resetCounters();
+  cache.setCapacity(2);
+
+  int chainIndex = he.getTopChainIndex();
+  cache.getScalar(1, chainIndex);
+  cache.getScalar(2, chainIndex);
+  cache.getScalar(1, chainIndex);
+  // evicts 2, the least recently used
+  cache.getScalar(3, chainIndex);
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(1, cache.getHits());
+
+  cache.getScalar(1, chainIndex);
+  EXPECT_EQ(2, cache.getHits());
+  cache.getScalar(2, chainIndex);
+  EXPECT_EQ(4, cache.getMisses());
+
+  cache.setCapacity(capacity);
+}
+
+TEST(PTileCacheTest, encodeCached)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+  he.getPTileCache().resetCounters();
+
+  vector<double> v{2.5, -1, 4};
+  PTile p1(he), p2(he);
+  enc.encodeCached(p1, v);
+  enc.encodeCached(p2, v);
+  EXPECT_EQ(1, he.getPTileCache().getHits());
+
+  vector<double> vals = enc.decodeDouble(p2);
+  for (size_t i = 0; i < v.size(); i++)
+    EXPECT_NEAR(v[i], vals[i], TestUtils::getEps());
+
+  // each PTile gets its own copy, so the cached encoding can't be modified
+  EXPECT_NE(&p1.getImpl(), &p2.getImpl());
+}
+
+TEST(PTileCacheTest, scalarOps)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  CTile c(he);
+  enc.encodeEncrypt(c, vector<double>{1, 2, 3});
+  c.addScalar(2);
+  c.addScalar(2);
+  enc.assertEquals(c, "addScalar", vector<double>{5, 6, 7});
+}
+} // namespace helayerstest
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include "TestUtils.h"
 #include "gtest/gtest.h"
@@ -158,4 +159,58 @@ TEST(PTileTest, saveLoad)
     EXPECT_NEAR(vals[i], v1[i], TestUtils::getEps());
   }
 }
+
+TEST(PTileTest, prepare)
+{
+  HeContext& he = TestUtils::getHighNumSlots();
+  Encoder enc(he);
+
+  vector<double> v1{1, 2, 3, 4}, v2{0.5, -1, 2, 0.25};
+  CTile c(he);
+  enc.encodeEncrypt(c, v1);
+  PTile p(he);
+  enc.encode(p, v2);
+  enc.prepare(p);
+  PTile copy(p);
+  EXPECT_EQ(p.isPrepared(), copy.isPrepared());
+
+  CTile ones(he);
+  enc.encodeEncrypt(ones, vector<double>(he.slotCount(), 1));
+
+  // prepared plaintexts give the same results, also at a lower level of the
+  // ciphertext, where they are expanded again
+  for (int level = 0; level < 2; ++level) {
+    if (level > 0) {
+      // Multiplying drops primes of the ciphertext. HElib drops them lazily,
+      // before the next multiplication, so two are needed. Without chain
+      // indices, the lower level shows in the saved size.
+      int chainIndex = c.getChainIndex();
+      stringstream before;
+      streamoff sizeBefore = c.save(before);
+      c.multiply(ones);
+      c.multiply(ones);
+      stringstream after;
+      if (he.getTraits().getAutomaticallyManagesChainIndices())
+        EXPECT_LT(c.save(after), sizeBefore);
+      else
+        EXPECT_LT(c.getChainIndex(), chainIndex);
+    }
+    CTile sum(c), diff(c), prod(c);
+    sum.addPlain(p);
+    diff.subPlain(copy);
+    prod.multiplyPlain(p);
+    vector<double> expectedSum, expectedDiff, expectedProd;
+    for (size_t i = 0; i < v1.size(); ++i) {
+      expectedSum.push_back(v1[i] + v2[i]);
+      expectedDiff.push_back(v1[i] - v2[i]);
+      expectedProd.push_back(v1[i] * v2[i]);
+    }
+    enc.assertEquals(sum, "addPlain", expectedSum, TestUtils::getEps());
+    enc.assertEquals(diff, "subPlain", expectedDiff, TestUtils::getEps());
+    enc.assertEquals(prod, "multiplyPlain", expectedProd, TestUtils::getEps());
+  }
+
+  enc.encode(p, v1);
+  EXPECT_FALSE(p.isPrepared());
+}
 } // namespace helayerstest
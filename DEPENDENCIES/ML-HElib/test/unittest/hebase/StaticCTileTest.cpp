@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/hebase/hebase.h"
+#include "helayers/hebase/helib/HelibBgvCiphertext.h"
+#include "helayers/hebase/helib/HelibCkksCiphertext.h"
+#include "helayers/hebase/helib/HelibCkksPlaintext.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+TEST(StaticCTileTest, matchesCTile)
+{
+  HelibCkksContext he;
+  he.init(16 * 2 * 2, 50, 1500);
+  Encoder enc(he);
+
+  vector<double> v1{1, 2, 3, 4}, v2{0.5, -1, 2, 0.25};
+  CTile c1(he), c2(he);
+  enc.encodeEncrypt(c1, v1);
+  enc.encodeEncrypt(c2, v2);
+  PTile p(he);
+  enc.encode(p, v2);
+
+  HelibCkksCTile s1(c1), s2(c2);
+  const HelibCkksPlaintext& sp = HelibCkksCTile::plainOf(p);
+  s1.add(s2);
+  s1.multiplyPlain(sp);
+  s1.multiplyScalar(2.0);
+  s1.subPlain(sp);
+  s1.rotate(1);
+
+  CTile expected(c1);
+  expected.add(c2);
+  expected.multiplyPlain(p);
+  expected.multiplyScalar(2.0);
+  expected.subPlain(p);
+  expected.rotate(1);
+
+  enc.assertEquals(move(s1).toCTile(),
+                   "static",
+                   enc.decryptDecodeDouble(expected),
+                   TestUtils::getEps());
+
+  // copies and conversions leave their source unchanged
+  HelibCkksCTile copy(s2);
+  copy.addScalar(1.0);
+  enc.assertEquals(s2.toCTile(), "copy", v2, TestUtils::getEps());
+  enc.assertEquals(c1, "source", v1, TestUtils::getEps());
+
+  EXPECT_THROW(HelibBgvCTile bgv(c1), invalid_argument);
+}
+
+} // namespace helayerstest
@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "helayers/kvstore/EncryptedKVStore.h"
+#include "helayers/hebase/helib/HelibBgvContext.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+TEST(EncryptedKVStoreTest, lookup)
+{
+  // Small insecure parameters with 32 slots, deep enough for the Fermat
+  // equality test modulo 127.
+  HelibBgvContext he;
+  he.init(127, 128, 1, 1000);
+
+  vector<pair<string, string>> entries;
+  for (int i = 0; i < 20; ++i)
+    entries.push_back({"k" + to_string(i), "v" + to_string(i * 7)});
+
+  EncryptedKVStore store(he);
+  store.encrypt(entries);
+  EXPECT_EQ(20, store.getNumEntries());
+  EXPECT_EQ(4, store.getEntryWidth());
+  EXPECT_EQ(8, store.getEntriesPerCiphertext());
+  EXPECT_EQ(3, store.getNumCiphertexts());
+
+  for (int i : {0, 7, 8, 19}) {
+    CTile res = store.lookup(store.encryptQuery("k" + to_string(i)));
+    EXPECT_EQ("v" + to_string(i * 7), store.decryptResult(res));
+  }
+  CTile res = store.lookup(store.encryptQuery("k20"));
+  EXPECT_EQ("", store.decryptResult(res));
+
+  EXPECT_THROW(store.encryptQuery("k1234"), invalid_argument);
+  EXPECT_THROW(store.encrypt({{string(64, 'a'), "b"}}), invalid_argument);
+}
+} // namespace helayerstest
@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fstream>
+#include "gtest/gtest.h"
+#include "helayers/simple_nn/CipherMatrixEncoder.h"
+#include "helayers/simple_nn/CipherMatrixFile.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+using namespace boost::numeric::ublas;
+
+namespace helayerstest {
+
+// Offset of the tile index in the file: magic, version, numRows, numCols and
+// numFilledSlots.
+static const streamoff indexOffset = 28;
+
+static tensor<double> randomTensor(size_t rows, size_t cols, size_t slots)
+{
+  tensor<double> res{rows, cols, slots};
+  for (size_t i = 0; i < rows; i++)
+    for (size_t j = 0; j < cols; j++)
+      for (size_t k = 0; k < slots; k++)
+        res.at(i, j, k) = ((double)(rand() % 1000)) / 1000;
+  return res;
+}
+
+static void assertTensorEquals(const tensor<double>& expected,
+                               const tensor<double>& actual)
+{
+  ASSERT_EQ(expected.size(0), actual.size(0));
+  ASSERT_EQ(expected.size(1), actual.size(1));
+  ASSERT_EQ(expected.size(2), actual.size(2));
+  for (size_t i = 0; i < expected.size(0); i++)
+    for (size_t j = 0; j < expected.size(1); j++)
+      for (size_t k = 0; k < expected.size(2); k++)
+        EXPECT_NEAR(expected.at(i, j, k), actual.at(i, j, k),
+                    TestUtils::getEps());
+}
+
+static string writeMatrixFile(HeContext& he,
+                              const tensor<double>& vals,
+                              const string& name)
+{
+  CipherMatrixEncoder enc(he);
+  CipherMatrix cm(he);
+  enc.encodeEncrypt(cm, vals);
+
+  TestUtils::createOutputDirectory();
+  string fileName = TestUtils::getOutputDirectory() + "/" + name;
+  CipherMatrixFileWriter writer(fileName, vals.size(0), vals.size(1),
+                                vals.size(2));
+  writer.write(cm);
+  writer.close();
+  return fileName;
+}
+
+TEST(CipherMatrixFileTest, saveLoad)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  tensor<double> vals = randomTensor(3, 2, he.slotCount());
+  string fileName = writeMatrixFile(he, vals, "CipherMatrixFileTest.tmp");
+
+  CipherMatrixFileReader reader(he, fileName);
+  EXPECT_EQ(3, reader.getNumRows());
+  EXPECT_EQ(2, reader.getNumCols());
+  EXPECT_EQ(he.slotCount(), reader.getNumFilledSlots());
+
+  // A default constructed matrix is reshaped to the file's dimensions.
+  CipherMatrix res(he);
+  EXPECT_EQ(0, res.getNumRows());
+  EXPECT_EQ(0, res.getNumCols());
+  reader.load(res);
+  EXPECT_EQ(3, res.getNumRows());
+  EXPECT_EQ(2, res.getNumCols());
+
+  CipherMatrixEncoder enc(he);
+  assertTensorEquals(vals, enc.decryptDecodeDouble(res));
+}
+
+TEST(CipherMatrixFileTest, loadRows)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  tensor<double> vals = randomTensor(4, 2, he.slotCount());
+  string fileName = writeMatrixFile(he, vals, "CipherMatrixFileRowsTest.tmp");
+
+  // Rows outside the loaded range keep their previous contents.
+  tensor<double> zeros(vals.extents(), 0);
+  CipherMatrixEncoder enc(he);
+  CipherMatrix res(he);
+  enc.encodeEncrypt(res, zeros);
+
+  CipherMatrixFileReader reader(he, fileName);
+  reader.loadRows(res, 1, 3);
+  tensor<double> expected = zeros;
+  for (size_t i = 1; i < 3; i++)
+    for (size_t j = 0; j < vals.size(1); j++)
+      for (size_t k = 0; k < vals.size(2); k++)
+        expected.at(i, j, k) = vals.at(i, j, k);
+  assertTensorEquals(expected, enc.decryptDecodeDouble(res));
+
+  // The remaining rows complete the matrix.
+  reader.loadRows(res, 0, 1);
+  reader.loadRows(res, 3, 4);
+  assertTensorEquals(vals, enc.decryptDecodeDouble(res));
+
+  EXPECT_THROW(reader.loadRows(res, 3, 2), invalid_argument);
+  EXPECT_THROW(reader.loadRows(res, 0, 5), invalid_argument);
+}
+
+TEST(CipherMatrixFileTest, truncatedFile)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  tensor<double> vals = randomTensor(2, 2, he.slotCount());
+  string fileName = writeMatrixFile(he, vals, "CipherMatrixFileTrunc.tmp");
+
+  ifstream in(fileName, ios::in | ios::binary);
+  string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  in.close();
+
+  // Cut inside the index, and inside the last tile.
+  for (size_t len : {(size_t)indexOffset + 4, contents.size() - 1}) {
+    string truncName = TestUtils::getOutputDirectory() +
+                       "/CipherMatrixFileTruncPart.tmp";
+    ofstream out(truncName, ios::out | ios::binary);
+    out.write(contents.data(), len);
+    out.close();
+    EXPECT_THROW(CipherMatrixFileReader(he, truncName), runtime_error);
+  }
+}
+
+TEST(CipherMatrixFileTest, badTileOffset)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  tensor<double> vals = randomTensor(2, 2, he.slotCount());
+  string fileName = writeMatrixFile(he, vals, "CipherMatrixFileBad.tmp");
+
+  // An offset inside the index, and one past the end of the file.
+  for (uint64_t offset : {(uint64_t)indexOffset, (uint64_t)1 << 40}) {
+    fstream f(fileName, ios::in | ios::out | ios::binary);
+    f.seekp(indexOffset);
+    f.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    f.close();
+    EXPECT_THROW(CipherMatrixFileReader(he, fileName), runtime_error);
+  }
+}
+
+TEST(CipherMatrixFileTest, corruptTile)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  tensor<double> vals = randomTensor(2, 2, he.slotCount());
+  string fileName = writeMatrixFile(he, vals, "CipherMatrixFileCorrupt.tmp");
+
+  // Cut the last tile short by rewriting the length in its index entry. The
+  // index is still valid, so the error is only found when the tile is
+  // loaded, inside the parallel loop.
+  uint64_t length = 4;
+  fstream f(fileName, ios::in | ios::out | ios::binary);
+  f.seekp(indexOffset + 3 * 2 * sizeof(uint64_t) + sizeof(uint64_t));
+  f.write(reinterpret_cast<const char*>(&length), sizeof(length));
+  f.close();
+
+  CipherMatrixFileReader reader(he, fileName);
+  CipherMatrix res(he);
+  EXPECT_THROW(reader.load(res), exception);
+  EXPECT_THROW(reader.loadRows(res, 1, 2), exception);
+  // Rows without the corrupt tile still load.
+  reader.loadRows(res, 0, 1);
+}
+
+TEST(CipherMatrixFileTest, incompleteWrite)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  TestUtils::createOutputDirectory();
+  CipherMatrixFileWriter writer(TestUtils::getOutputDirectory() +
+                                    "/CipherMatrixFileIncomplete.tmp",
+                                1,
+                                2,
+                                he.slotCount());
+  CTile c(he);
+  Encoder enc(he);
+  enc.encodeEncrypt(c, std::vector<double>(he.slotCount(), 1));
+  writer.writeTile(0, 0, c);
+  EXPECT_THROW(writer.writeTile(0, 0, c), invalid_argument);
+  EXPECT_THROW(writer.writeTile(1, 0, c), invalid_argument);
+  EXPECT_THROW(writer.close(), runtime_error);
+}
+} // namespace helayerstest
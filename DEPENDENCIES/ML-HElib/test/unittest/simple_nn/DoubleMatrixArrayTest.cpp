@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/simple_nn/DoubleMatrixArray.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+// Depths below, at and above the block size of the packed kernels.
+static const vector<int> depths{1, 5, 32, 77};
+
+TEST(DoubleMatrixArrayTest, matrixMultiply)
+{
+  for (int len : depths) {
+    DoubleMatrixArray a(5, 7, len), b(7, 3, len);
+    a.initRandom();
+    b.initRandom();
+
+    DoubleMatrixArray res = a.getMatrixMultiply(b);
+    ASSERT_EQ(len, res.size());
+    for (int k = 0; k < len; ++k) {
+      DoubleMatrix expected = a.getMat(k).getMultiply(b.getMat(k));
+      EXPECT_TRUE(expected.checkIfEqual(res.getMat(k), 1e-10));
+    }
+  }
+
+  DoubleMatrixArray a(2, 3, 4), b(2, 3, 4);
+  EXPECT_THROW(a.getMatrixMultiply(b), invalid_argument);
+}
+
+TEST(DoubleMatrixArrayTest, convolution)
+{
+  for (int len : depths) {
+    DoubleMatrixArray a(9, 8, len), filter(3, 2, len);
+    a.initRandom();
+    filter.initRandom();
+
+    DoubleMatrixArray res = a.getConvolution(filter, 2, 3);
+    ASSERT_EQ(len, res.size());
+    for (int k = 0; k < len; ++k) {
+      DoubleMatrix expected =
+          a.getMat(k).getConvolution(filter.getMat(k), 2, 3);
+      EXPECT_TRUE(expected.checkIfEqual(res.getMat(k), 1e-10));
+    }
+  }
+}
+
+TEST(DoubleMatrixArrayTest, reductions)
+{
+  DoubleMatrixArray a(4, 6, 40);
+  a.initRandom();
+
+  DoubleMatrixArray rows = a.getSumAlongRows();
+  DoubleMatrixArray cols = a.getMeanAlongCols();
+  for (int k = 0; k < a.size(); ++k) {
+    EXPECT_TRUE(
+        a.getMat(k).getSumAlongRows().checkIfEqual(rows.getMat(k), 1e-10));
+    EXPECT_TRUE(
+        a.getMat(k).getMeanAlongCols().checkIfEqual(cols.getMat(k), 1e-10));
+  }
+
+  DoubleMatrixArray depth = a.getSumInDepth();
+  DoubleMatrixArray inner(a);
+  inner.innerSum();
+  for (int i = 0; i < a.rows(); ++i)
+    for (int j = 0; j < a.cols(); ++j) {
+      double sum = 0;
+      for (int k = 0; k < a.size(); ++k)
+        sum += a.getMat(k).get(i, j);
+      EXPECT_NEAR(sum, depth.getMat(0).get(i, j), 1e-10);
+      EXPECT_NEAR(sum, inner.getMat(a.size() - 1).get(i, j), 1e-10);
+    }
+}
+} // namespace helayerstest
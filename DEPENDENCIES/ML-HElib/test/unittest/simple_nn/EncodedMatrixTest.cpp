@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/simple_nn/CipherMatrixEncoder.h"
+#include "helayers/simple_nn/EncodedMatrix.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+using namespace boost::numeric::ublas;
+
+namespace helayerstest {
+
+static tensor<double> randomTensor(size_t rows, size_t cols, size_t slots)
+{
+  tensor<double> res{rows, cols, slots};
+  for (size_t i = 0; i < rows; i++)
+    for (size_t j = 0; j < cols; j++)
+      for (size_t k = 0; k < slots; k++)
+        res.at(i, j, k) = ((double)(rand() % 1000)) / 1000;
+  return res;
+}
+
+static void assertTensorEquals(const tensor<double>& expected,
+                               const tensor<double>& actual)
+{
+  ASSERT_EQ(expected.size(0), actual.size(0));
+  ASSERT_EQ(expected.size(1), actual.size(1));
+  ASSERT_EQ(expected.size(2), actual.size(2));
+  for (size_t i = 0; i < expected.size(0); i++)
+    for (size_t j = 0; j < expected.size(1); j++)
+      for (size_t k = 0; k < expected.size(2); k++)
+        EXPECT_NEAR(expected.at(i, j, k), actual.at(i, j, k),
+                    TestUtils::getEps());
+}
+
+TEST(EncodedMatrixTest, matrixMultiply)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  CipherMatrixEncoder enc(he);
+  tensor<double> a = randomTensor(3, 4, he.slotCount());
+  tensor<double> b = randomTensor(4, 2, he.slotCount());
+
+  tensor<double> expected{3, 2, (size_t)he.slotCount()};
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 2; j++)
+      for (size_t s = 0; s < (size_t)he.slotCount(); s++) {
+        expected.at(i, j, s) = 0;
+        for (size_t k = 0; k < 4; k++)
+          expected.at(i, j, s) += a.at(i, k, s) * b.at(k, j, s);
+      }
+
+  EncodedMatrix encodedA(he);
+  CipherMatrix encryptedA(he), encryptedB(he);
+  enc.encode(encodedA, a);
+  enc.encodeEncrypt(encryptedA, a);
+  enc.encodeEncrypt(encryptedB, b);
+
+  // The plaintext product matches the ciphertext one.
+  CipherMatrix res = encodedA.getMatrixMultiply(encryptedB);
+  EXPECT_EQ(3, res.getNumRows());
+  EXPECT_EQ(2, res.getNumCols());
+  assertTensorEquals(expected, enc.decryptDecodeDouble(res));
+  assertTensorEquals(
+      enc.decryptDecodeDouble(encryptedA.getMatrixMultiply(encryptedB)),
+      enc.decryptDecodeDouble(res));
+
+  // Pending maintenance of the encrypted operand is taken into account.
+  CipherMatrix squaredB(encryptedB);
+  squaredB.square();
+  tensor<double> expectedSquared{3, 2, (size_t)he.slotCount()};
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 2; j++)
+      for (size_t s = 0; s < (size_t)he.slotCount(); s++) {
+        expectedSquared.at(i, j, s) = 0;
+        for (size_t k = 0; k < 4; k++)
+          expectedSquared.at(i, j, s) +=
+              a.at(i, k, s) * b.at(k, j, s) * b.at(k, j, s);
+      }
+  assertTensorEquals(
+      expectedSquared,
+      enc.decryptDecodeDouble(encodedA.getMatrixMultiply(squaredB)));
+
+  EXPECT_THROW(encodedA.getMatrixMultiply(encryptedA), invalid_argument);
+}
+
+TEST(EncodedMatrixTest, addPlain)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  CipherMatrixEncoder enc(he);
+  tensor<double> a = randomTensor(2, 3, he.slotCount());
+  tensor<double> b = randomTensor(2, 3, he.slotCount());
+
+  tensor<double> expected = a + b;
+
+  CipherMatrix encryptedA(he);
+  EncodedMatrix encodedB(he);
+  enc.encodeEncrypt(encryptedA, a);
+  enc.encode(encodedB, b);
+  encryptedA.addPlain(encodedB);
+  assertTensorEquals(expected, enc.decryptDecodeDouble(encryptedA));
+
+  EncodedMatrix other(he);
+  enc.encode(other, randomTensor(3, 2, he.slotCount()));
+  EXPECT_THROW(encryptedA.addPlain(other), invalid_argument);
+}
+
+TEST(EncodedMatrixTest, invalidChainIndex)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  if (he.getTraits().getAutomaticallyManagesChainIndices())
+    return;
+  CipherMatrixEncoder enc(he);
+  tensor<double> a = randomTensor(2, 3, he.slotCount());
+  int badChainIndex = he.getTopChainIndex() + 1;
+
+  // The error surfaces as an exception rather than terminating the process
+  // from within the parallel encoding loop.
+  EncodedMatrix encoded(he);
+  CipherMatrix encrypted(he);
+  EXPECT_THROW(enc.encode(encoded, a, badChainIndex), invalid_argument);
+  EXPECT_THROW(enc.encodeEncrypt(encrypted, a, badChainIndex),
+               invalid_argument);
+
+  std::vector<double> slots(2 * 3 * he.slotCount(), 1);
+  EXPECT_THROW(
+      enc.encode(encoded, slots.data(), 2, 3, he.slotCount(), badChainIndex),
+      invalid_argument);
+  EXPECT_THROW(
+      enc.encodeEncrypt(
+          encrypted, slots.data(), 2, 3, he.slotCount(), badChainIndex),
+      invalid_argument);
+}
+
+TEST(EncodedMatrixTest, saveLoad)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  CipherMatrixEncoder enc(he);
+  tensor<double> a = randomTensor(2, 3, he.slotCount());
+  tensor<double> b = randomTensor(3, 1, he.slotCount());
+
+  EncodedMatrix encodedA(he);
+  enc.encode(encodedA, a);
+  stringstream stream;
+  streamoff written = encodedA.save(stream);
+
+  EncodedMatrix loaded(he);
+  EXPECT_EQ(written, loaded.load(stream));
+  EXPECT_EQ(2, loaded.getNumRows());
+  EXPECT_EQ(3, loaded.getNumCols());
+  EXPECT_EQ(he.slotCount(), loaded.getNumFilledSlots());
+
+  CipherMatrix encryptedB(he);
+  enc.encodeEncrypt(encryptedB, b);
+  assertTensorEquals(
+      enc.decryptDecodeDouble(encodedA.getMatrixMultiply(encryptedB)),
+      enc.decryptDecodeDouble(loaded.getMatrixMultiply(encryptedB)));
+}
+} // namespace helayerstest
@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/simple_nn/CipherMatrixEncoder.h"
+#include "helayers/simple_nn/EncodedMatrix.h"
+#include "helayers/simple_nn/H5BatchReader.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+
+namespace helayerstest {
+
+// Writes a numSamples x dims[0] x ... data set of consecutive values.
+static void writeDataSet(const string& fileName,
+                         const string& path,
+                         const vector<hsize_t>& dims)
+{
+  hsize_t size = 1;
+  for (hsize_t d : dims)
+    size *= d;
+  vector<double> vals(size);
+  for (hsize_t i = 0; i < size; ++i)
+    vals[i] = i;
+
+  H5::H5File file(fileName, H5F_ACC_TRUNC);
+  H5::DataSpace space(dims.size(), dims.data());
+  H5::DataSet dataset =
+      file.createDataSet(path, H5::PredType::NATIVE_DOUBLE, space);
+  dataset.write(vals.data(), H5::PredType::NATIVE_DOUBLE);
+}
+
+TEST(H5BatchReaderTest, streamBatches)
+{
+  TestUtils::createOutputDirectory();
+  string samplesFile = TestUtils::getOutputDirectory() + "/x.h5";
+  string labelsFile = TestUtils::getOutputDirectory() + "/y.h5";
+  const int numSamples = 10, batchSize = 4;
+  writeDataSet(samplesFile, "x", {numSamples, 3, 2});
+  writeDataSet(labelsFile, "y", {numSamples, 2});
+
+  TrainingSetPlain ts(batchSize);
+  ts.loadFromH5(samplesFile, "x", labelsFile, "y");
+  EXPECT_EQ(3, ts.getNumBatches());
+  EXPECT_EQ(numSamples, ts.getNumSamples());
+  EXPECT_EQ(2, ts.getNumClasses());
+
+  for (bool readAhead : {false, true}) {
+    H5BatchReader reader(
+        batchSize, samplesFile, "x", labelsFile, "y", readAhead);
+    SimpleBatchPlain batch;
+    int b = 0;
+    while (reader.next(batch)) {
+      for (int i = 0; i < batchSize; ++i) {
+        int s = b * batchSize + i;
+        // the last batch is padded with zeros
+        double expected = s < numSamples ? s * 6 + 5 : 0;
+        EXPECT_EQ(expected, batch.samples.getMat(i).get(2, 1));
+        EXPECT_EQ(expected, ts.getSample(b, i).get(2, 1));
+        expected = s < numSamples ? s * 2 + 1 : 0;
+        EXPECT_EQ(expected, batch.labels.getMat(i).get(1, 0));
+        EXPECT_EQ(expected, ts.getLabel(b, i).get(1, 0));
+      }
+      ++b;
+    }
+    EXPECT_EQ(3, b);
+
+    reader.reset();
+    ASSERT_TRUE(reader.next(batch));
+    EXPECT_EQ(0, batch.samples.getMat(0).get(0, 0));
+  }
+
+  writeDataSet(labelsFile, "y", {numSamples + 1, 2});
+  EXPECT_THROW(H5BatchReader(batchSize, samplesFile, "x", labelsFile, "y"),
+               runtime_error);
+}
+
+TEST(H5BatchReaderTest, slotPacked)
+{
+  TestUtils::createOutputDirectory();
+  string samplesFile = TestUtils::getOutputDirectory() + "/x.h5";
+  HeContext& he = TestUtils::getLowNumSlots();
+  const int numSamples = 5, rows = 3, cols = 2;
+  const int batchSize = he.slotCount();
+  ASSERT_GT(batchSize, numSamples);
+  writeDataSet(samplesFile, "x", {numSamples, rows, cols, 1});
+
+  TrainingSetPlain ts(batchSize);
+  ts.loadFromH5(samplesFile, "x");
+  ASSERT_EQ(1, ts.getNumBatches());
+
+  H5Parser parser(samplesFile);
+  vector<double> vals;
+  vector<int> dims;
+  parser.readSlotPacked("x", 0, batchSize, vals, dims);
+  EXPECT_EQ(vector<int>({rows, cols, 1}), dims);
+  ASSERT_EQ((size_t)rows * cols * batchSize, vals.size());
+
+  // The tile of element (x, y) holds it for all the samples of the batch,
+  // padded with zeros like the batch.
+  CipherMatrixEncoder enc(he);
+  CipherMatrix encrypted(he);
+  enc.encodeEncrypt(encrypted, vals.data(), rows, cols, batchSize);
+  boost::numeric::ublas::tensor<double> res =
+      enc.decryptDecodeDouble(encrypted);
+
+  EncodedMatrix encoded(he);
+  enc.encode(encoded, vals.data(), rows, cols, batchSize);
+  CipherMatrix sum(he);
+  enc.encodeEncrypt(sum,
+                    boost::numeric::ublas::tensor<double>(res.extents(), 0));
+  sum.addPlain(encoded);
+  boost::numeric::ublas::tensor<double> encodedRes =
+      enc.decryptDecodeDouble(sum);
+
+  for (int x = 0; x < rows; ++x)
+    for (int y = 0; y < cols; ++y)
+      for (int s = 0; s < batchSize; ++s) {
+        double expected = ts.getSample(0, s).get(x, y);
+        EXPECT_EQ(expected, vals[(x * cols + y) * batchSize + s]);
+        EXPECT_NEAR(expected, res.at(x, y, s), TestUtils::getEps());
+        EXPECT_NEAR(expected, encodedRes.at(x, y, s), TestUtils::getEps());
+      }
+
+  EXPECT_THROW(
+      enc.encodeEncrypt(encrypted, vals.data(), rows, cols, batchSize + 1),
+      invalid_argument);
+  EXPECT_THROW(enc.encode(encoded, vals.data(), rows, cols, batchSize + 1),
+               invalid_argument);
+
+  string samples3dFile = TestUtils::getOutputDirectory() + "/x3d.h5";
+  writeDataSet(samples3dFile, "x", {numSamples, rows, cols, 2});
+  H5Parser parser3d(samples3dFile);
+  EXPECT_THROW(parser3d.readSlotPacked("x", 0, batchSize, vals, dims),
+               runtime_error);
+  EXPECT_THROW(ts.loadFromH5(samples3dFile, "x"), runtime_error);
+}
+} // namespace helayerstest
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 International Business Machines
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "helayers/simple_nn/CipherMatrixEncoder.h"
+#include "helayers/simple_nn/SimpleFcLayer.h"
+#include "TestUtils.h"
+
+using namespace std;
+using namespace helayers;
+using namespace boost::numeric::ublas;
+
+namespace helayerstest {
+
+static void assertTensorEquals(const tensor<double>& expected,
+                               const tensor<double>& actual)
+{
+  ASSERT_EQ(expected.size(0), actual.size(0));
+  ASSERT_EQ(expected.size(1), actual.size(1));
+  ASSERT_EQ(expected.size(2), actual.size(2));
+  for (size_t i = 0; i < expected.size(0); i++)
+    for (size_t j = 0; j < expected.size(1); j++)
+      for (size_t k = 0; k < expected.size(2); k++)
+        EXPECT_NEAR(expected.at(i, j, k), actual.at(i, j, k),
+                    TestUtils::getEps());
+}
+
+// Checks that layer computes the same output as plainLayer.
+static void assertForward(HeContext& he,
+                          const SimpleFcPlainLayer& plainLayer,
+                          const SimpleFcLayer& layer)
+{
+  DoubleMatrixArray in(plainLayer.getWeights().cols(), 1, he.slotCount());
+  in.initRandom();
+  tensor<double> expected = plainLayer.forward(in).getTensor();
+
+  CipherMatrixEncoder enc(he);
+  CipherMatrix encryptedIn(he);
+  enc.encodeEncrypt(encryptedIn, in.getTensor());
+  assertTensorEquals(expected,
+                     enc.decryptDecodeDouble(layer.forward(encryptedIn)));
+}
+
+static SimpleFcPlainLayer randomPlainLayer(HeContext& he)
+{
+  SimpleFcPlainLayer res;
+  res.initSize(3, 4, he.slotCount());
+  res.initWeightsRandom();
+  return res;
+}
+
+TEST(SimpleFcLayerTest, forward)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  SimpleFcPlainLayer plainLayer = randomPlainLayer(he);
+
+  for (bool plainWeights : {false, true}) {
+    SimpleFcLayer layer(he, plainWeights);
+    layer.initFromLayer(plainLayer);
+    EXPECT_EQ(plainWeights, layer.hasPlainWeights());
+    assertForward(he, plainLayer, layer);
+  }
+}
+
+TEST(SimpleFcLayerTest, saveLoad)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  SimpleFcPlainLayer plainLayer = randomPlainLayer(he);
+
+  for (bool plainWeights : {false, true}) {
+    SimpleFcLayer layer(he, plainWeights);
+    layer.initFromLayer(plainLayer);
+    stringstream stream;
+    streamoff written = layer.save(stream);
+
+    // The saved kind of weights overrides the constructor's.
+    SimpleFcLayer loaded(he, !plainWeights);
+    EXPECT_EQ(written, loaded.load(stream));
+    EXPECT_EQ(plainWeights, loaded.hasPlainWeights());
+    assertForward(he, plainLayer, loaded);
+  }
+}
+
+TEST(SimpleFcLayerTest, loadEncryptedWeightsFormat)
+{
+  HeContext& he = TestUtils::getLowNumSlots();
+  SimpleFcPlainLayer plainLayer = randomPlainLayer(he);
+
+  // Layers with encrypted weights were saved as the weights matrix followed
+  // by the bias matrix.
+  CipherMatrixEncoder enc(he);
+  CipherMatrix weights(he), bias(he);
+  enc.encodeEncrypt(weights, plainLayer.getWeights().getTensor());
+  enc.encodeEncrypt(bias, plainLayer.getBias().getTensor());
+  stringstream stream;
+  streamoff written = weights.save(stream);
+  written += bias.save(stream);
+
+  SimpleFcLayer loaded(he, true);
+  EXPECT_EQ(written, loaded.load(stream));
+  EXPECT_FALSE(loaded.hasPlainWeights());
+  assertForward(he, plainLayer, loaded);
+}
+} // namespace helayerstest
@@ -41,6 +41,7 @@
 
 #include "helayers/hebase/hebase.h"
 #include "helayers/hebase/helib/HelibBgvContext.h"
+#include "helayers/kvstore/EncryptedKVStore.h"
 #include <fstream>
 #include <helib/ArgMap.h>
 #include <NTL/BasicThreadPool.h>
@@ -54,8 +55,6 @@ void run(HeContext& he,
          const string& db_filename,
          const std::string& countryName,
          bool debug);
-bool isPowerOf2(int v);
-vector<int> stringToAscii(const string& val);
 
 int main(int argc, char* argv[])
 {
@@ -183,27 +182,19 @@ void run(HeContext& he,
        << endl;
 
   // We'll now encrypt our country-capital database.
+  // The EncryptedKVStore class packs several entries side by side in the
+  // slots of each ciphertext. Each country and capital name is stored by
+  // its ascii codes. For example, Norway is represented
+  // (78,111,114,119,97,121,  0,0,0, ...)
   HELIB_NTIMER_START(timer_CtxtCountryDB);
-  // The encoder class handles both encoding and encrypting.
-  Encoder enc(he);
-  // This is the database: a vector of pairs of CTile-s.
-  // A CTile is a ciphertext object.
-  vector<pair<CTile, CTile>> encrypted_country_db;
-  for (const auto& country_capital_pair : country_db) {
-    // Create a country ciphertext, and encrypt inside
-    // the ascii vector representation of each country.
-    // For example, Norway is represented
-    // (78,111,114,119,97,121,  0,0,0, ...)
-    CTile country(he);
-    enc.encodeEncrypt(country, stringToAscii(country_capital_pair.first));
-    // Similarly encrypt the capital name
-    CTile capital(he);
-    enc.encodeEncrypt(capital, stringToAscii(country_capital_pair.second));
-    // Add the pair to the database
-    encrypted_country_db.emplace_back(move(country), move(capital));
-  }
+  EncryptedKVStore store(he);
+  store.encrypt(country_db);
   HELIB_NTIMER_STOP(timer_CtxtCountryDB);
 
+  cout << "Packed " << store.getEntriesPerCiphertext()
+       << " entries per ciphertext, into " << store.getNumCiphertexts()
+       << " ciphertexts" << endl;
+
   if (debug) {
     helib::printNamedTimer(cout << endl, "timer_Context");
     helib::printNamedTimer(cout, "timer_CtxtCountryDB");
@@ -225,102 +216,42 @@ void run(HeContext& he,
   cout << "Looking for the Capital of " << query_string << endl;
   cout << "This may take a few minutes ... " << endl;
 
+  // Names longer than the entries of the store cannot match any country.
+  if (query_string.size() > store.getEntryWidth())
+    query_string = "";
+
   HELIB_NTIMER_START(timer_TotalQuery);
   HELIB_NTIMER_START(timer_EncryptQuery);
 
   // Encrypt the query similar to the way we encrypted
-  // the country and capital names
-  CTile query(he);
-  enc.encodeEncrypt(query, stringToAscii(query_string));
+  // the country names, once for every entry in a ciphertext.
+  CTile query = store.encryptQuery(query_string);
 
   HELIB_NTIMER_STOP(timer_EncryptQuery);
 
   /************ Perform the database search ************/
 
+  // For every ciphertext of the database the store computes:
+  // 1. The difference between the keys and the query. Each slot
+  //    will have 0 when characters match, or non-zero otherwise.
+  // 2. Fermat's little theorem: raising to the power of modulusP-1
+  //    converts all non-zero values to 1. After negating and adding 1,
+  //    we'll have 1 for match and 0 for mismatch.
+  // 3. A rotate-and-multiply over the slots of each entry, leaving 1 in
+  //    the entry only if all its characters match.
+  // 4. Multiplication by the capital names. Only the capital of the
+  //    matching country remains non-zero.
+  // Finally, all the results are summed together.
   HELIB_NTIMER_START(timer_QuerySearch);
-  vector<CTile> mask;
-  mask.reserve(country_db.size());
-  NativeFunctionEvaluator eval(he);
-  long modulusP = he.getTraits().getArithmeticModulus();
-
-  // For every entry in our database we perform the following
-  // calculation:
-  for (const auto& encrypted_pair : encrypted_country_db) {
-    //  Copy of database key: a country name
-    CTile mask_entry = encrypted_pair.first;
-    // Calculate the difference
-    // In each slot now we'll have 0 when characters match,
-    // or non-zero when there's a mismatch
-    mask_entry.sub(query);
-
-    // Fermat's little theorem:
-    // Since the underlying plaintext are in modular arithmetic,
-    // Raising to the power of modulusP convers all non-zero values
-    // to 1.
-    eval.powerInPlace(mask_entry, modulusP - 1);
-
-    // Negate the ciphertext
-    // Now we'll have 0 for match, -1 for mismatch
-    mask_entry.negate();
-
-    // Add +1
-    // Now we'll have 1 for match, 0 for mismatch
-    mask_entry.addScalar(1);
-
-    // We'll now multiply all slots together, since
-    // we want a complete match across all slots.
-
-    // If slot count is a power of 2 there's an efficient way
-    // to do it:
-    // we'll do a rotate-and-multiply algorithm, similar to
-    // a rotate-and-sum one.
-    if (isPowerOf2(he.slotCount())) {
-      for (int rot = 1; rot < he.slotCount(); rot *= 2) {
-        CTile tmp(mask_entry);
-        tmp.rotate(-rot);
-        mask_entry.multiply(tmp);
-      }
-    } else {
-      // Otherwise we'll create all possible rotations, and multiply all of
-      // them.
-      // Note that for non powers of 2 a rotate-and-multiply algorithm
-      // can still be used as well, though it's more complicated and
-      // beyond the scope of this example.
-      vector<CTile> rotated_masks(he.slotCount(), mask_entry);
-      for (int i = 1; i < rotated_masks.size(); i++)
-        rotated_masks[i].rotate(-i); // Rotate each of the masks
-      eval.totalProduct(mask_entry,
-                        rotated_masks); // Multiply each of the masks
-    }
-
-    // mask_entry is now either all 1s if query==country,
-    // or all 0s otherwise.
-    // After we multiply by capital name it will be either
-    // the capital name, or all 0s.
-    mask_entry.multiply(encrypted_pair.second);
-    // We collect all our findings.
-    mask.push_back(mask_entry);
-  }
+  CTile value = store.lookup(query);
   HELIB_NTIMER_STOP(timer_QuerySearch);
 
-  // Aggregate the results into a single ciphertext
-  // Note: This code is for educational purposes and thus we try to refrain
-  // from using the STL and do not use std::accumulate
-  CTile value = mask[0];
-  for (int i = 1; i < mask.size(); i++)
-    value.add(mask[i]);
-
   // /************ Decrypt and print result ************/
 
   HELIB_NTIMER_START(timer_DecryptQueryResult);
-  vector<int> res = enc.decryptDecodeInt(value);
+  string string_result = store.decryptResult(value);
   HELIB_NTIMER_STOP(timer_DecryptQueryResult);
 
-  // Convert from ASCII to a string
-  string string_result;
-  for (long i = 0; i < res.size(); ++i)
-    string_result.push_back(static_cast<long>(res[i]));
-
   HELIB_NTIMER_STOP(timer_TotalQuery);
 
   // Print DB Query Timers
@@ -331,7 +262,7 @@ void run(HeContext& he,
     cout << endl;
   }
 
-  if (string_result.at(0) == 0x00) {
+  if (string_result.empty()) {
     string_result = "Country name not in the database.\n*** Please make sure "
                     "to enter the name of an European Country\n*** with the "
                     "first letter in upper case.";
@@ -376,18 +307,3 @@ vector<pair<string, string>> read_csv(string filename, int maxLen)
   data_file.close();
   return dataset;
 }
-
-// Return a vector of ints with the i'th element containing the ascii
-// code of the i'th character
-vector<int> stringToAscii(const string& val)
-{
-  vector<int> res;
-  res.reserve(val.size());
-  for (size_t i = 0; i < val.size(); ++i) {
-    res.push_back(val[i]);
-  }
-  return res;
-}
-
-// Returns true if v is a power of 2
-bool isPowerOf2(int v) { return (v & v - 1) == 0; }
\ No newline at end of file
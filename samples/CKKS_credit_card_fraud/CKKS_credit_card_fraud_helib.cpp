@@ -80,6 +80,50 @@ void createContexts()
   hePtr->saveToFile(serverContext, withSecretKey); // save server context
 }
 
+/*
+ * runs all batches through a BatchedServer, keeping several of them in flight
+ * at once. the client encrypts every batch up front, so that the server's
+ * throughput doesn't include encryption, submits them together, and then
+ * decrypts the predictions in order as they become ready.
+ * */
+void runBatchedServer(Client& client, int iterations, int serverWorkers)
+{
+  BatchedServer server(serverWorkers);
+  server.init();
+  server.start();
+
+  auto samplesFile = [](int i) {
+    return outDir + "/encrypted_batch_samples_" + to_string(i) + ".bin";
+  };
+  auto predictionsFile = [](int i) {
+    return outDir + "/encrypted_batch_predictions_" + to_string(i) + ".bin";
+  };
+
+  for (int i = 0; i < iterations; ++i)
+    client.encryptAndSaveSamples(i, samplesFile(i));
+
+  // submit() blocks while the pipeline is full, until earlier batches
+  // progress through it.
+  std::vector<future<void>> pending;
+  for (int i = 0; i < iterations; ++i)
+    pending.push_back(server.submit(samplesFile(i), predictionsFile(i)));
+
+  for (int i = 0; i < iterations; ++i) {
+    pending[i].get();
+    cout << endl
+         << "*** Received predictions for batch " << i + 1 << "/"
+         << iterations << " ***" << endl;
+    client.decryptPredictions(predictionsFile(i));
+    client.assessResults();
+  }
+  server.stop();
+
+  cout << endl << "All done!" << endl << endl;
+  server.printStatistics();
+  HELAYERS_TIMER_PRINT_MEASURE_SUMMARY("server-request");
+  HelayersTimer::printOverview();
+}
+
 /*
  * the main logic that creates the HELIB contexts, initializes instances of
  * client and server,
@@ -88,6 +132,8 @@ void createContexts()
 int main(int argc, char** argv)
 {
   bool runAll = false;
+  int serverWorkers = 0;
+  bool plainWeights = false;
   string dataDir = getDataSetsDir();
 
   // read args from cmd
@@ -96,6 +142,10 @@ int main(int argc, char** argv)
       runAll = true;
     if (std::string(argv[i]) == "--data_dir")
       dataDir = std::string(argv[i + 1]);
+    if (std::string(argv[i]) == "--server_workers")
+      serverWorkers = std::stoi(argv[i + 1]);
+    if (std::string(argv[i]) == "--plain_weights")
+      plainWeights = true;
   }
 
   cout << "*** Starting inference demo ***" << endl;
@@ -104,16 +154,21 @@ int main(int argc, char** argv)
   createContexts();
 
   // init client
-  Client client(dataDir);
+  Client client(dataDir, plainWeights);
   client.init();
 
-  // init server
-  Server server;
-  server.init();
-
   // go over each batch of samples
   int iterations =
       runAll ? client.getNumBatches() : min(24, client.getNumBatches());
+
+  if (serverWorkers > 0) {
+    runBatchedServer(client, iterations, serverWorkers);
+    return 0;
+  }
+
+  // init server
+  Server server;
+  server.init();
   for (int i = 0; i < iterations; ++i) {
 
     cout << endl
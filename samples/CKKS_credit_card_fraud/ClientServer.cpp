@@ -30,11 +30,15 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
 
 #include "ClientServer.h"
 #include "helayers/simple_nn/SimpleNeuralNetPlain.h"
 #include "helayers/simple_nn/SimpleNeuralNet.h"
 #include "helayers/simple_nn/CipherMatrixEncoder.h"
+#include "helayers/simple_nn/CipherMatrixFile.h"
 
 using namespace std;
 using namespace helayers;
@@ -54,7 +58,9 @@ double classificationThreshold =
 
 // Client methods
 
-Client::Client(const string& dataDir) : currentBatch(0), dataDir(dataDir) {}
+Client::Client(const string& dataDir, bool plainWeights)
+    : currentBatch(0), dataDir(dataDir), plainWeights(plainWeights)
+{}
 
 Client::~Client() {}
 
@@ -74,8 +80,9 @@ void Client::init()
                   std::vector<int>{29, 20, 5, 1},
                   batchSize);
 
-  cout << "CLIENT: encrypting plain model . . ." << endl;
-  SimpleNeuralNet netHe(*he);
+  cout << "CLIENT: " << (plainWeights ? "encoding" : "encrypting")
+       << " plain model . . ." << endl;
+  SimpleNeuralNet netHe(*he, plainWeights);
   netHe.initFromNet(plainNet);
 
   cout << "CLIENT: saving encrypted model . . ." << endl;
@@ -93,22 +100,48 @@ void Client::init()
   cout << "Number of samples: " << ts->getNumSamples() << endl;
   cout << "Batch size: " << batchSize << endl;
   cout << "Number of batches: " << numBatches << endl;
+
+  // a batch is encrypted into a tile per input feature, so the pool holds as
+  // many encryptions of zero as a sample has features
+  vector<int> samplesDims =
+      H5Parser(dataDir + plainSamplesFile).getDims("x_test");
+  int tilesPerBatch = 1;
+  for (size_t i = 1; i < samplesDims.size(); ++i)
+    tilesPerBatch *= samplesDims[i];
+  encryptionPool = make_shared<EncryptionPool>(*he, tilesPerBatch);
 }
 
 void Client::encryptAndSaveSamples(int batch,
                                    const string& encryptedSamplesFile) const
 {
-  const CipherMatrixEncoder encoder(*he);
+  CipherMatrixEncoder encoder(*he);
+  encoder.getEncoder().setEncryptionPool(encryptionPool);
 
   cout << "CLIENT: encrypting plain samples . . ." << endl;
   HELAYERS_TIMER_PUSH("data-encrypt");
-  const DoubleMatrixArray& plainSamples = ts->getSamples(batch);
+  // read the batch straight into the layout of tile slots, a sample per slot
+  H5Parser h5(dataDir + plainSamplesFile);
+  vector<double> packedSamples;
+  vector<int> sampleDims;
+  h5.readSlotPacked(
+      "x_test", batch * batchSize, batchSize, packedSamples, sampleDims);
+  int numRows = sampleDims.at(0);
+  int numCols = sampleDims.size() > 1 ? sampleDims[1] : 1;
   CipherMatrix encryptedSamples(*he);
-  encoder.encodeEncrypt(encryptedSamples, plainSamples.getTensor());
+  encoder.encodeEncrypt(
+      encryptedSamples, packedSamples.data(), numRows, numCols, batchSize);
   HELAYERS_TIMER_POP();
+  cout << "CLIENT: encryption pool hit rate " << encryptionPool->getHitRate()
+       << ", " << encryptionPool->getRefillRate()
+       << " encryptions of zero per second" << endl;
 
   cout << "CLIENT: saving encrypted samples . . ." << endl;
-  encryptedSamples.saveToFile(encryptedSamplesFile);
+  CipherMatrixFileWriter writer(encryptedSamplesFile,
+                                encryptedSamples.getNumRows(),
+                                encryptedSamples.getNumCols(),
+                                encryptedSamples.getNumFilledSlots());
+  writer.write(encryptedSamples);
+  writer.close();
 }
 
 void Client::decryptPredictions(const string& encryptedPredictionsFile)
@@ -118,9 +151,8 @@ void Client::decryptPredictions(const string& encryptedPredictionsFile)
   cout << "CLIENT: loading encrypted predictions . . ." << endl;
 
   CipherMatrix encryptedPredictions(*he);
-  ifstream ifs(encryptedPredictionsFile, ios::in | ios::binary);
-  encryptedPredictions.load(ifs);
-  ifs.close();
+  CipherMatrixFileReader reader(*he, encryptedPredictionsFile);
+  reader.load(encryptedPredictions);
 
   cout << "CLIENT: decrypting predictions . . ." << endl;
   HELAYERS_TIMER_PUSH("data-decrypt");
@@ -216,14 +248,244 @@ void Server::processEncryptedSamples(
   cout << "SERVER: loading encrypted samples . . ." << endl;
 
   CipherMatrix encryptedSamples(*he);
-  ifstream ifs(encryptedSamplesFile, ios::in | ios::binary);
-  encryptedSamples.load(ifs);
-  ifs.close();
+  CipherMatrixFileReader reader(*he, encryptedSamplesFile);
+  reader.load(encryptedSamples);
 
   cout << "SERVER: predicting over encrypted samples . . ." << endl;
   CipherMatrix encryptedPredictions(*he);
   encryptedNet->predict(encryptedSamples, encryptedPredictions);
 
   cout << "SERVER: saving encrypted predictions . . ." << endl;
-  encryptedPredictions.saveToFile(encryptedPredictionsFile);
+  // Predictions are only decrypted by the client, so they can be sent at
+  // the lowest modulus.
+  encryptedPredictions.compact();
+  CipherMatrixFileWriter writer(encryptedPredictionsFile,
+                                encryptedPredictions.getNumRows(),
+                                encryptedPredictions.getNumCols(),
+                                encryptedPredictions.getNumFilledSlots());
+  writer.write(encryptedPredictions);
+  writer.close();
+}
+
+// BatchedServer methods
+
+void BatchedServer::RequestQueue::setCapacity(size_t c)
+{
+  lock_guard<mutex> lock(mtx);
+  capacity = c;
+}
+
+void BatchedServer::RequestQueue::push(const shared_ptr<Request>& req)
+{
+  {
+    unique_lock<mutex> lock(mtx);
+    notFull.wait(lock, [this] { return closed || requests.size() < capacity; });
+    if (closed)
+      throw runtime_error("Request queue is closed");
+    requests.push_back(req);
+  }
+  notEmpty.notify_one();
+}
+
+bool BatchedServer::RequestQueue::pop(shared_ptr<Request>& req)
+{
+  {
+    unique_lock<mutex> lock(mtx);
+    notEmpty.wait(lock, [this] { return closed || !requests.empty(); });
+    if (requests.empty())
+      return false;
+    req = requests.front();
+    requests.pop_front();
+  }
+  notFull.notify_one();
+  return true;
+}
+
+void BatchedServer::RequestQueue::close()
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    closed = true;
+  }
+  notEmpty.notify_all();
+  notFull.notify_all();
+}
+
+BatchedServer::BatchedServer(int numWorkers, int queueCapacity)
+    : numWorkers(numWorkers), activeWorkers(0)
+{
+  if (numWorkers < 1)
+    throw invalid_argument("Number of workers must be positive");
+  if (queueCapacity < 0)
+    throw invalid_argument("Queue capacity must not be negative");
+  threadsPerWorker = max(1, omp_get_max_threads() / numWorkers);
+
+  size_t capacity = queueCapacity == 0 ? numWorkers : queueCapacity;
+  loadQueue.setCapacity(capacity);
+  predictQueue.setCapacity(capacity);
+  saveQueue.setCapacity(capacity);
+}
+
+BatchedServer::~BatchedServer() { stop(); }
+
+void BatchedServer::start()
+{
+  if (!he || !encryptedNet)
+    throw runtime_error("BatchedServer must be initialized before starting");
+  if (!threads.empty())
+    throw runtime_error("BatchedServer already started");
+
+  cout << "SERVER: starting pipeline with " << numWorkers
+       << " prediction workers of " << threadsPerWorker << " threads . . ."
+       << endl;
+  activeWorkers = numWorkers;
+  threads.emplace_back(&BatchedServer::loadLoop, this);
+  for (int i = 0; i < numWorkers; ++i)
+    threads.emplace_back(&BatchedServer::predictLoop, this);
+  threads.emplace_back(&BatchedServer::saveLoop, this);
+}
+
+future<void> BatchedServer::submit(const string& encryptedSamplesFile,
+                                   const string& encryptedPredictionsFile)
+{
+  shared_ptr<Request> req = make_shared<Request>();
+  req->encryptedSamplesFile = encryptedSamplesFile;
+  req->encryptedPredictionsFile = encryptedPredictionsFile;
+  req->submitTime = chrono::high_resolution_clock::now();
+  future<void> res = req->done.get_future();
+
+  loadQueue.push(req);
+  return res;
+}
+
+void BatchedServer::stop()
+{
+  if (threads.empty())
+    return;
+
+  // Closing the first queue lets every stage drain and close the next one.
+  loadQueue.close();
+  for (auto& t : threads)
+    t.join();
+  threads.clear();
+}
+
+void BatchedServer::loadLoop()
+{
+  shared_ptr<Request> req;
+  while (loadQueue.pop(req)) {
+    {
+      lock_guard<mutex> lock(statsMtx);
+      if (pipelineStart == chrono::high_resolution_clock::time_point())
+        pipelineStart = chrono::high_resolution_clock::now();
+    }
+    try {
+      req->samples = make_shared<CipherMatrix>(*he);
+      CipherMatrixFileReader reader(*he, req->encryptedSamplesFile);
+      reader.load(*req->samples);
+      predictQueue.push(req);
+    } catch (...) {
+      fail(*req);
+    }
+  }
+  predictQueue.close();
+}
+
+void BatchedServer::predictLoop()
+{
+  // Each worker thread starts its own OpenMP parallel regions. Limiting them
+  // to the worker's share keeps concurrent predictions from oversubscribing
+  // the machine.
+  omp_set_num_threads(threadsPerWorker);
+  omp_set_max_active_levels(1);
+
+  shared_ptr<Request> req;
+  while (predictQueue.pop(req)) {
+    try {
+      req->predictions = make_shared<CipherMatrix>(*he);
+      encryptedNet->predict(*req->samples, *req->predictions);
+      req->samples.reset();
+      saveQueue.push(req);
+    } catch (...) {
+      fail(*req);
+    }
+  }
+  // The last worker to finish closes the save stage.
+  if (--activeWorkers == 0)
+    saveQueue.close();
+}
+
+void BatchedServer::saveLoop()
+{
+  shared_ptr<Request> req;
+  while (saveQueue.pop(req)) {
+    try {
+      CipherMatrix& predictions = *req->predictions;
+      predictions.compact();
+      CipherMatrixFileWriter writer(req->encryptedPredictionsFile,
+                                    predictions.getNumRows(),
+                                    predictions.getNumCols(),
+                                    predictions.getNumFilledSlots());
+      writer.write(predictions);
+      writer.close();
+      req->predictions.reset();
+      complete(*req);
+    } catch (...) {
+      fail(*req);
+    }
+  }
+}
+
+void BatchedServer::complete(Request& req)
+{
+  auto now = chrono::high_resolution_clock::now();
+  int64_t microsecs =
+      chrono::duration_cast<chrono::microseconds>(now - req.submitTime)
+          .count();
+  HelayersTimer::addMeasure("server-request", microsecs);
+
+  {
+    lock_guard<mutex> lock(statsMtx);
+    latencies.push_back(microsecs);
+    lastDone = now;
+  }
+  req.done.set_value();
+}
+
+void BatchedServer::fail(Request& req)
+{
+  req.samples.reset();
+  req.predictions.reset();
+  req.done.set_exception(current_exception());
+}
+
+void BatchedServer::printStatistics(ostream& out) const
+{
+  lock_guard<mutex> lock(statsMtx);
+  if (latencies.empty()) {
+    out << "SERVER: no requests completed" << endl;
+    return;
+  }
+
+  std::vector<int64_t> sorted(latencies);
+  sort(sorted.begin(), sorted.end());
+  auto percentile = [&sorted](double p) {
+    size_t idx = (size_t)ceil(p * sorted.size()) - 1;
+    return sorted.at(min(idx, sorted.size() - 1));
+  };
+
+  double elapsedSecs =
+      chrono::duration_cast<chrono::microseconds>(lastDone - pipelineStart)
+          .count() /
+      1e6;
+
+  out << "SERVER: completed " << sorted.size() << " batches" << endl;
+  out << "Throughput: " << fixed << setprecision(3)
+      << (elapsedSecs > 0 ? sorted.size() / elapsedSecs : 0)
+      << " (batches/sec)" << endl;
+  out << "Latency p50: " << HelayersTimer::getDurationAsString(percentile(0.5))
+      << " (secs)" << endl;
+  out << "Latency p99: "
+      << HelayersTimer::getDurationAsString(percentile(0.99)) << " (secs)"
+      << endl;
 }
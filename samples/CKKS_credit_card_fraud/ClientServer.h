@@ -25,6 +25,12 @@
 #ifndef EXAMPLES_NNFRAUD_CLIENTSERVER_H
 #define EXAMPLES_NNFRAUD_CLIENTSERVER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
 #include "helayers/hebase/hebase.h"
 #include "helayers/simple_nn/SimpleNeuralNet.h"
 #include "helayers/simple_nn/TrainingSetPlain.h"
@@ -35,6 +41,10 @@ class Client
 
   std::shared_ptr<helayers::HeContext> he;
 
+  // encryptions of zero prepared while the server is busy, so that encrypting
+  // the next batch is a plaintext addition per tile
+  std::shared_ptr<helayers::EncryptionPool> encryptionPool;
+
   std::shared_ptr<helayers::TrainingSetPlain> ts;
 
   std::vector<helayers::DoubleMatrixArray> allPredictions;
@@ -47,10 +57,14 @@ class Client
 
   const std::string& dataDir;
 
+  bool plainWeights;
+
 public:
   /// Construct a client.
   /// @param[in] dataDir folder where input data is
-  Client(const std::string& dataDir);
+  /// @param[in] plainWeights whether to send the model encoded rather than
+  ///                         encrypted, as if it were owned by the server
+  Client(const std::string& dataDir, bool plainWeights = false);
 
   ~Client();
 
@@ -81,12 +95,13 @@ public:
 class Server
 {
 
+protected:
   std::shared_ptr<helayers::HeContext> he;
 
   std::shared_ptr<helayers::SimpleNeuralNet> encryptedNet;
 
 public:
-  ~Server();
+  virtual ~Server();
 
   void init();
 
@@ -95,4 +110,100 @@ public:
       const std::string& encryptedPredictionsFile) const;
 };
 
+/// A long running server processing several batches concurrently.
+/// Each submitted request goes through a load -> predict -> save pipeline.
+/// Loading and saving are each served by a dedicated thread, and prediction
+/// by a pool of workers, so multiple client batches are in flight at once.
+class BatchedServer : public Server
+{
+  struct Request
+  {
+    std::string encryptedSamplesFile;
+    std::string encryptedPredictionsFile;
+    std::shared_ptr<helayers::CipherMatrix> samples;
+    std::shared_ptr<helayers::CipherMatrix> predictions;
+    std::promise<void> done;
+    std::chrono::high_resolution_clock::time_point submitTime;
+  };
+
+  /// A bounded blocking FIFO queue connecting two pipeline stages. A full
+  /// queue blocks the producing stage, so a fast stage can't accumulate
+  /// loaded samples or predictions faster than the next one consumes them.
+  class RequestQueue
+  {
+    std::mutex mtx;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<std::shared_ptr<Request>> requests;
+    size_t capacity = 1;
+    bool closed = false;
+
+  public:
+    void setCapacity(size_t c);
+
+    /// Blocks while the queue is full.
+    void push(const std::shared_ptr<Request>& req);
+
+    /// Blocks until a request is available. Returns false once the queue is
+    /// closed and drained.
+    bool pop(std::shared_ptr<Request>& req);
+
+    void close();
+  };
+
+  int numWorkers;
+  int threadsPerWorker;
+
+  RequestQueue loadQueue;
+  RequestQueue predictQueue;
+  RequestQueue saveQueue;
+
+  std::vector<std::thread> threads;
+  std::atomic<int> activeWorkers;
+
+  mutable std::mutex statsMtx;
+  std::vector<std::int64_t> latencies;
+  std::chrono::high_resolution_clock::time_point pipelineStart;
+  std::chrono::high_resolution_clock::time_point lastDone;
+
+  void loadLoop();
+  void predictLoop();
+  void saveLoop();
+  void complete(Request& req);
+  void fail(Request& req);
+
+public:
+  /// Construct a server.
+  /// The workers split OpenMP's thread budget (omp_get_max_threads(), i.e.
+  /// OMP_NUM_THREADS) evenly: each runs the tile loops of its prediction with
+  /// at least one thread, without nested parallel regions. A non-zero value
+  /// set by CipherMatrix::setNumThreads() overrides this share.
+  /// @param[in] numWorkers number of batches predicted concurrently
+  /// @param[in] queueCapacity maximal number of requests waiting between
+  ///                          two pipeline stages. 0 means numWorkers.
+  BatchedServer(int numWorkers, int queueCapacity = 0);
+
+  ~BatchedServer();
+
+  /// Start the pipeline threads. Must be called after init().
+  void start();
+
+  /// Queue a batch for processing. Blocks while the pipeline is full.
+  /// Returns a future that becomes ready once the predictions are saved, or
+  /// holds the exception thrown while processing the batch.
+  /// @param[in] encryptedSamplesFile File name to read samples from
+  /// @param[in] encryptedPredictionsFile File name to write predictions to
+  std::future<void> submit(const std::string& encryptedSamplesFile,
+                           const std::string& encryptedPredictionsFile);
+
+  /// Finish processing all submitted requests and join the pipeline threads.
+  void stop();
+
+  /// Print throughput and latency percentiles of completed requests.
+  /// Throughput is measured from the time the first request started
+  /// loading, so it doesn't include the preparation of the requests.
+  /// @param[in] out stream to print to
+  void printStatistics(std::ostream& out = std::cout) const;
+};
+
 #endif /* EXAMPLES_NNFRAUD_CLIENTSERVER_H */